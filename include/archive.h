@@ -0,0 +1,20 @@
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+#include <sqlite3.h>
+
+// Income and expense totals for a date range across the ledger and its archives
+typedef struct {
+    double income;
+    double expenses;
+    char partitions[512];   // Partitions read, e.g. "ledger, 2023 (summary), 2024 (archive)"
+} RangeTotals;
+
+// Function prototypes for yearly archive partitions
+int archiveClosedYears(sqlite3 *db, int through_year);
+void archiveClosedYearsPrompt(sqlite3 *db);
+void collectRangeTotals(sqlite3 *db, const char *from, const char *to, RangeTotals *totals);
+void showRangeCategories(sqlite3 *db);
+void showRangeReport(sqlite3 *db, const char *from, const char *to);
+void showRangeReportPrompt(sqlite3 *db);
+
+#endif
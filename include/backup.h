@@ -0,0 +1,45 @@
+#ifndef BACKUP_H
+#define BACKUP_H
+#include <sqlite3.h>
+#include <stdint.h>
+
+#define BACKUP_DIR "backups"
+#define BACKUP_MAGIC "FLBKUP1"
+#define BACKUP_VERSION 1
+#define BACKUP_MAX_CHAIN 16        // Increments after a base before the next base is taken
+#define BACKUP_CHUNK_SIZE 65536    // Compression buffer size
+#define BACKUP_SCHEMA_KEY "(schema)" // backup_state row holding the schema checksum of the last backup
+#define ONLINE_BACKUP_DEFAULT_PAGES 64   // Pages copied per step of an online backup
+#define ONLINE_BACKUP_PAUSE_MS 5         // Pause between steps so the app can use the database
+
+typedef enum {
+    BACKUP_BASE = 1,
+    BACKUP_INCREMENT = 2
+} BackupKind;
+
+// Uncompressed file header; the deflate stream of records follows it
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t kind;
+    int64_t sequence;
+    int64_t base_sequence;     // Sequence of the base this file applies on top of
+    int64_t created;
+    int64_t raw_size;
+    int64_t compressed_size;
+    int64_t record_count;
+    uint32_t raw_checksum;     // CRC-32 of the uncompressed records
+    uint32_t header_checksum;  // CRC-32 of the header up to this field
+} BackupHeader;
+
+// Function prototypes for compressed backups
+int initializeBackupTracking(sqlite3 *db);
+int createBackup(sqlite3 *db, int force_base);
+int restoreBackup(const char *backup_path, const char *target_path);
+void restoreBackupPrompt(void);
+int startOnlineBackup(sqlite3 *db, const char *dest_path, int pages_per_step);
+void startOnlineBackupPrompt(sqlite3 *db);
+void showOnlineBackupStatus(void);
+void finishOnlineBackup(void);
+
+#endif
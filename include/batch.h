@@ -0,0 +1,18 @@
+#ifndef BATCH_H
+#define BATCH_H
+#include <sqlite3.h>
+
+#define BATCH_DEFAULT_MAX_WRITES 500   // Commit after this many batched writes...
+#define BATCH_DEFAULT_MAX_MS 1000      // ...or once the oldest uncommitted write is this old
+
+// Function prototypes for session-level group commit
+void initBatchMode(sqlite3 *db);
+void setShutdownHandler(void (*handler)(sqlite3 *db));
+void setBatchMode(int max_writes, int max_ms);
+int batchModeEnabled(void);
+void beginBatchedWrite(void);
+void endBatchedWrite(void);
+void flushBatch(void);
+void closeBatchMode(void);
+
+#endif
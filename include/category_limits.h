@@ -0,0 +1,21 @@
+#ifndef CATEGORY_LIMITS_H
+#define CATEGORY_LIMITS_H
+#include <sqlite3.h>
+
+#define LIMIT_NEAR_RATIO 0.8f   // Spending at or above this share of the limit counts as "near"
+
+// Result of checking a category against its monthly limit
+typedef enum {
+    LIMIT_NONE,    // No limit set for the category
+    LIMIT_UNDER,
+    LIMIT_NEAR,
+    LIMIT_OVER
+} LimitStatus;
+
+// Function prototypes for per-category budget limits
+void loadCategoryLimits(sqlite3 *db);
+LimitStatus recordCategorySpend(const char *category, float amount, const char *date);
+void setCategoryLimit(sqlite3 *db);
+void showCategoryLimitReport(void);
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef CONSOLIDATE_H
+#define CONSOLIDATE_H
+
+#define CONSOLIDATE_CHUNK_ROWS 65536   // Row id range scanned per task
+#define CONSOLIDATE_MAX_LEDGERS 64
+
+// Function prototypes for multi-ledger consolidation
+int consolidateLedgers(const char **paths, int count, const char *json_path);
+void consolidateLedgersPrompt(void);
+
+#endif
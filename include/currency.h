@@ -0,0 +1,26 @@
+#ifndef CURRENCY_H
+#define CURRENCY_H
+#include <sqlite3.h>
+
+#define CURRENCY_DEFAULT_BASE "USD"          // Used when FINANCE_LITE_CURRENCY is not set
+#define CURRENCY_CODE_SIZE 4                 // Three-letter ISO 4217 code and terminator
+#define CURRENCY_RATES_FILE "exchange_rates.csv"
+
+// Rows with a NULL currency are in the base currency, which is stored in the ledger when it is
+// first opened and never changes. Other rows are converted with the rate
+// in effect on their date: rates are "base units per unit" and carry forward until the next
+// rate for that currency, so one rate per month or per day both work.
+
+// Function prototypes for multi-currency amounts
+int initializeCurrency(sqlite3 *db);
+int registerCurrencyFunctions(sqlite3 *db);
+int registerLedgerCurrencyFunctions(sqlite3 *db, char *base);
+int ensureCurrencyColumn(sqlite3 *db, const char *schema, const char *table);
+const char *baseCurrency(void);
+int normalizeCurrencyCode(const char *text, char *code);
+double convertToBase(double amount, const char *currency, const char *date, int *found);
+int loadExchangeRates(sqlite3 *db, const char *path);
+void loadExchangeRatesPrompt(sqlite3 *db);
+void reportMissingRates(void);
+
+#endif
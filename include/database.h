@@ -2,9 +2,12 @@
 #define DATABASE_H
 #include <sqlite3.h>
 #include <string.h>
+#include <time.h>
 
 // Function prototypes for database operations
 void initializeDatabase(sqlite3 **db, const char *db_name);
+int addIncomeRecord(sqlite3 *db, float amount, const char *date, const char *currency);
+int addExpenseRecord(sqlite3 *db, const char *category, float amount, const char *date, const char *currency);
 void insertIncome(sqlite3 *db);
 void insertExpense(sqlite3 *db);
 void insertSavingsGoal(sqlite3 *db, const char *name, float target_amount, const char *due_date);
@@ -14,5 +17,6 @@ void saveBudgetToJSON(sqlite3 *db, const char *filename);
 void getLastProcessedMonth(sqlite3 *db, int *year, int *month);
 void updateLastProcessedMonth(sqlite3 *db, int year, int month);
 void applyRecurringTransactions(sqlite3 *db);
+void applyRecurringTransactionsAt(sqlite3 *db, time_t t);
 
 #endif
@@ -0,0 +1,35 @@
+#ifndef DEDUPE_H
+#define DEDUPE_H
+#include <sqlite3.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Fingerprint kinds. Rows are fingerprinted by date, amount in cents, lower-cased category
+// and currency (none for the base currency); recurring postings by year-month, amount,
+// description and entry id instead, so the same entry posted twice in one month is caught
+// whatever the day, while two identical-looking entries still post once each.
+#define FINGERPRINT_INCOME 'i'
+#define FINGERPRINT_EXPENSE 'e'
+#define FINGERPRINT_RECURRING_INCOME 'I'
+#define FINGERPRINT_RECURRING_EXPENSE 'E'
+
+// Open-addressing set of 64-bit fingerprints
+typedef struct {
+    uint64_t *slots;     // 0 marks an empty slot
+    size_t capacity;     // Power of two
+    size_t count;
+} FingerprintSet;
+
+// Function prototypes for duplicate detection
+uint64_t transactionFingerprint(char kind, const char *date, double amount, const char *label, const char *currency);
+uint64_t postingFingerprint(char kind, const char *month, int64_t entry_id, double amount, const char *description);
+int fingerprintSetAdd(FingerprintSet *set, uint64_t fingerprint);
+int fingerprintSetContains(const FingerprintSet *set, uint64_t fingerprint);
+void fingerprintSetFree(FingerprintSet *set);
+int initializePostingTable(sqlite3 *db);
+int initializeFingerprints(sqlite3 *db);
+int fingerprintSeen(uint64_t fingerprint);
+void rememberFingerprint(uint64_t fingerprint);
+int recordRecurringPosting(sqlite3 *db, uint64_t fingerprint);
+
+#endif
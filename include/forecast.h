@@ -0,0 +1,64 @@
+#ifndef FORECAST_H
+#define FORECAST_H
+#include <sqlite3.h>
+#include "utils.h"
+
+#define FORECAST_MAX_MONTHS 600
+
+// A recurring entry as seen by the forecast (amount is signed: income > 0, expense < 0)
+typedef struct {
+    int id;
+    char description[MAX_NAME_LENGTH];
+    double amount;
+    int start_offset;   // First forecast month (0-based) the entry applies to
+} ForecastEntry;
+
+// Historical spending rate for a category that is not covered by a recurring entry
+typedef struct {
+    char name[MAX_NAME_LENGTH];
+    double monthly_rate;
+} ForecastCategory;
+
+// Everything needed to project balances without touching the database again
+typedef struct {
+    int start_year;
+    int start_month;
+    double opening_balance;
+    int entry_count;
+    ForecastEntry *entries;
+    int category_count;
+    ForecastCategory *categories;
+} ForecastModel;
+
+typedef enum {
+    SCENARIO_REMOVE_ENTRY,    // Drop model->entries[index]
+    SCENARIO_ADD_ENTRY,       // Add a hypothetical recurring entry
+    SCENARIO_SCALE_CATEGORY   // Multiply model->categories[index] by factor
+} ScenarioAction;
+
+typedef struct {
+    ScenarioAction action;
+    int index;
+    double factor;
+    ForecastEntry entry;
+} ScenarioChange;
+
+// A what-if scenario and its projected outcome
+typedef struct {
+    char label[2 * MAX_NAME_LENGTH];
+    const ScenarioChange *changes;
+    int change_count;
+    double final_balance;
+    double lowest_balance;
+    int lowest_month;
+} ForecastScenario;
+
+// Function prototypes
+int loadForecastModel(sqlite3 *db, ForecastModel *model);
+void freeForecastModel(ForecastModel *model);
+void projectBalances(const ForecastModel *model, int months, double *balances);
+void evaluateScenarios(const ForecastModel *model, int months, ForecastScenario *scenarios, int count);
+void showForecast(sqlite3 *db);
+void showWhatIfForecast(sqlite3 *db);
+
+#endif
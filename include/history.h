@@ -0,0 +1,13 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+#include <sqlite3.h>
+
+#define HISTORY_RECENT_CHANGES 20
+
+// Function prototypes for change history and point-in-time reports
+int initializeHistory(sqlite3 *db);
+void showAnalyticsAsOf(sqlite3 *db, const char *as_of);
+void showPointInTimeReport(sqlite3 *db);
+void showChangeHistory(sqlite3 *db);
+
+#endif
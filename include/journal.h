@@ -0,0 +1,18 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+#include <sqlite3.h>
+
+#define JOURNAL_SYNC_RECORDS 64          // fsync after this many appends...
+#define JOURNAL_SYNC_INTERVAL_MS 200     // ...or after this long, whichever comes first
+#define JOURNAL_COMPACT_BATCH 4096       // Records folded into SQLite per transaction
+
+// Function prototypes for the append-only operation journal
+int replayJournal(sqlite3 *db, const char *db_name);
+int openJournal(const char *db_name);
+void syncJournal(void);
+void closeJournal(void);
+int journalEnabled(void);
+int journalAppendIncome(float amount, const char *date);
+int journalAppendExpense(const char *category, float amount, const char *date);
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef LISTING_H
+#define LISTING_H
+#include <sqlite3.h>
+#include <stdint.h>
+#include "utils.h"
+
+#define LIST_PAGE_MAX 100
+#define LIST_PAGE_DEFAULT 20
+#define LIST_DATE_SIZE 32     // Longest stored date a listing handles, plus the terminator
+#define LIST_ARCHIVE_MAX 8    // Archive files attached for one page; SQLite allows 10 attached databases
+
+typedef enum {
+    LIST_INCOME,
+    LIST_EXPENSES,
+    LIST_RECURRING,
+    LIST_SAVINGS_GOALS
+} ListSource;
+
+typedef enum {
+    LIST_BY_ID,
+    LIST_BY_DATE      // (date, id); income and expenses only
+} ListOrder;
+
+// Optional filters; an empty string means "any"
+typedef struct {
+    char type[16];                   // Recurring entries: "income" or "expense"
+    char category[MAX_NAME_LENGTH];  // Expenses: exact category
+    char date_from[11];              // Income and expenses: inclusive YYYY-MM-DD bounds
+    char date_to[11];
+} ListFilter;
+
+// Resume point: the sort key of the last row returned. A zeroed cursor starts at the beginning.
+typedef struct {
+    int started;                     // Set once a page has been returned; the key below is valid
+    int64_t last_id;
+    char last_date[LIST_DATE_SIZE];  // May be empty: an empty date is still a sort key
+    int done;                        // Set once the last page has been returned
+} ListCursor;
+
+// One row from any source; fields that don't apply are zero or empty
+typedef struct {
+    int64_t id;
+    char type[16];
+    char label[MAX_NAME_LENGTH];     // Category, recurring description or goal name
+    double amount;                   // Goals: target amount
+    double saved_amount;             // Goals only
+    char date[LIST_DATE_SIZE];       // Goals: due date; recurring: start date
+} ListRow;
+
+typedef struct {
+    ListRow rows[LIST_PAGE_MAX];
+    int count;
+    ListCursor next;                 // Pass back in to fetch the following page
+} ListPage;
+
+// Function prototypes for keyset-paginated listings
+int fetchListPage(sqlite3 *db, ListSource source, ListOrder order, const ListFilter *filter,
+                  const ListCursor *cursor, int page_size, ListPage *page);
+void browseTransactions(sqlite3 *db);
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef METRICS_H
+#define METRICS_H
+#include <time.h>
+#include <sqlite3.h>
+
+#define METRICS_DEFAULT_INTERVAL 15   // Seconds between metric file writes
+
+typedef enum {
+    METRIC_INCOME,
+    METRIC_EXPENSES,
+    METRIC_KIND_COUNT
+} MetricKind;
+
+typedef enum {
+    METRIC_REPORT_ANALYTICS,
+    METRIC_REPORT_DAILY_BUDGET,
+    METRIC_REPORT_RANGE,
+    METRIC_REPORT_COUNT
+} MetricReport;
+
+// Function prototypes for the Prometheus metrics file. The count and observe functions only
+// touch atomics, so they are safe to call from any thread, with or without export enabled.
+int initializeRowCounts(sqlite3 *db);
+int startMetrics(const char *db_name);
+int writeMetrics(void);
+void metricsCountInsert(MetricKind kind, int ok);
+void metricsCountRecurring(MetricKind kind, int posted);
+void metricsObserveReport(MetricReport report, const struct timespec *start);
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef RULES_H
+#define RULES_H
+#include <sqlite3.h>
+#include <stdint.h>
+
+#define RULES_FALLBACK_CATEGORY "Uncategorized"   // Imported rows that no rule matches
+
+typedef enum {
+    RULE_EXACT,       // Whole description equals the pattern
+    RULE_PREFIX,      // Description starts with the pattern
+    RULE_SUBSTRING,   // Description contains the pattern
+    RULE_REGEX        // POSIX extended regular expression
+} RuleKind;
+
+// Rules compiled for matching: a hash table for exact patterns, one Aho-Corasick automaton
+// for prefix and substring patterns, and compiled regexes. Matching ignores case.
+typedef struct CategoryMatcher CategoryMatcher;
+
+// Function prototypes for the category rule engine and bank import
+CategoryMatcher *loadCategoryMatcher(sqlite3 *db);
+const char *matchCategory(CategoryMatcher *matcher, const char *description, double amount, int64_t *rule_id);
+void saveRuleHits(sqlite3 *db, CategoryMatcher *matcher);
+void freeCategoryMatcher(CategoryMatcher *matcher);
+int importBankCSV(sqlite3 *db, const char *path);
+void manageCategoryRules(sqlite3 *db);
+
+#endif
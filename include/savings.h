@@ -0,0 +1,20 @@
+#ifndef SAVINGS_H
+#define SAVINGS_H
+#include <sqlite3.h>
+
+#define SAVINGS_RECENT_DAYS 90   // Window for the recent savings velocity
+
+// One contribution to a savings goal; negative amounts are withdrawals
+typedef struct {
+    int goal_id;
+    double amount;
+    char date[11];               // YYYY-MM-DD
+} GoalContribution;
+
+// Function prototypes for the savings contribution ledger
+int initializeSavingsLedger(sqlite3 *db);
+int postGoalContributions(sqlite3 *db, const GoalContribution *contributions, int count);
+void postContributionBatch(sqlite3 *db);
+void showSavingsProgress(sqlite3 *db);
+
+#endif
@@ -0,0 +1,207 @@
+#ifndef SCHEMA_H
+#define SCHEMA_H
+#include <sqlite3.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// Core tables, defined once. The key column comes first, then the other columns in table
+// order. Each column is X(name, kind, declaration), where kind is ID, INT, INT64, REAL or TEXT.
+#define SAVINGS_GOALS_KEY(X) X(id, ID, "INTEGER PRIMARY KEY AUTOINCREMENT")
+#define SAVINGS_GOALS_COLUMNS(X) \
+    X(name, TEXT, "TEXT NOT NULL") \
+    X(target_amount, REAL, "REAL") \
+    X(saved_amount, REAL, "REAL DEFAULT 0") \
+    X(due_date, TEXT, "TEXT")
+
+#define INCOME_KEY(X) X(id, ID, "INTEGER PRIMARY KEY AUTOINCREMENT")
+#define INCOME_COLUMNS(X) \
+    X(amount, REAL, "REAL") \
+    X(date, TEXT, "TEXT") \
+    X(currency, TEXT, "TEXT")
+
+#define EXPENSES_KEY(X) X(id, ID, "INTEGER PRIMARY KEY AUTOINCREMENT")
+#define EXPENSES_COLUMNS(X) \
+    X(category, TEXT, "TEXT") \
+    X(amount, REAL, "REAL") \
+    X(date, TEXT, "TEXT") \
+    X(currency, TEXT, "TEXT")
+
+#define RECURRING_KEY(X) X(id, ID, "INTEGER PRIMARY KEY AUTOINCREMENT")
+#define RECURRING_COLUMNS(X) \
+    X(type, TEXT, "TEXT NOT NULL") \
+    X(description, TEXT, "TEXT NOT NULL") \
+    X(amount, REAL, "REAL") \
+    X(date, TEXT, "TEXT NOT NULL")
+
+#define LAST_PROCESSED_MONTH_KEY(X) X(id, ID, "INTEGER PRIMARY KEY")
+#define LAST_PROCESSED_MONTH_COLUMNS(X) \
+    X(year, INT, "INTEGER") \
+    X(month, INT, "INTEGER")
+
+#define CATEGORY_LIMITS_KEY(X) X(category, TEXT, "TEXT PRIMARY KEY")
+#define CATEGORY_LIMITS_COLUMNS(X) \
+    X(monthly_limit, REAL, "REAL NOT NULL")
+
+#define JOURNAL_STATE_KEY(X) X(id, ID, "INTEGER PRIMARY KEY")
+#define JOURNAL_STATE_COLUMNS(X) \
+    X(offset, INT64, "INTEGER NOT NULL")
+
+#define CATEGORY_RULES_KEY(X) X(id, ID, "INTEGER PRIMARY KEY AUTOINCREMENT")
+#define CATEGORY_RULES_COLUMNS(X) \
+    X(kind, TEXT, "TEXT NOT NULL CHECK (kind IN ('exact', 'prefix', 'substring', 'regex'))") \
+    X(pattern, TEXT, "TEXT NOT NULL") \
+    X(category, TEXT, "TEXT NOT NULL") \
+    X(min_amount, REAL, "REAL NOT NULL DEFAULT 0") \
+    X(max_amount, REAL, "REAL NOT NULL DEFAULT 0") \
+    X(priority, INT, "INTEGER NOT NULL DEFAULT 0") \
+    X(hits, INT64, "INTEGER NOT NULL DEFAULT 0")
+
+// table name, row struct, key columns, other columns
+#define SCHEMA_SAVINGS_GOALS savings_goals, SavingsGoalRow, SAVINGS_GOALS_KEY, SAVINGS_GOALS_COLUMNS
+#define SCHEMA_INCOME income, IncomeRow, INCOME_KEY, INCOME_COLUMNS
+#define SCHEMA_EXPENSES expenses, ExpenseRow, EXPENSES_KEY, EXPENSES_COLUMNS
+#define SCHEMA_RECURRING recurring, RecurringRow, RECURRING_KEY, RECURRING_COLUMNS
+#define SCHEMA_LAST_PROCESSED_MONTH last_processed_month, LastProcessedMonthRow, LAST_PROCESSED_MONTH_KEY, LAST_PROCESSED_MONTH_COLUMNS
+#define SCHEMA_CATEGORY_LIMITS category_limits, CategoryLimitRow, CATEGORY_LIMITS_KEY, CATEGORY_LIMITS_COLUMNS
+#define SCHEMA_JOURNAL_STATE journal_state, JournalStateRow, JOURNAL_STATE_KEY, JOURNAL_STATE_COLUMNS
+#define SCHEMA_CATEGORY_RULES category_rules, CategoryRuleRow, CATEGORY_RULES_KEY, CATEGORY_RULES_COLUMNS
+
+#define SCHEMA_TABLES(T) \
+    T(SCHEMA_SAVINGS_GOALS) \
+    T(SCHEMA_INCOME) \
+    T(SCHEMA_EXPENSES) \
+    T(SCHEMA_RECURRING) \
+    T(SCHEMA_LAST_PROCESSED_MONTH) \
+    T(SCHEMA_CATEGORY_LIMITS) \
+    T(SCHEMA_JOURNAL_STATE) \
+    T(SCHEMA_CATEGORY_RULES)
+
+// Per-kind C types, binders and readers. TEXT fields point into caller or statement memory:
+// a row read from a statement is valid until the next sqlite3_step or sqlite3_finalize.
+#define SCHEMA_CTYPE_ID int64_t
+#define SCHEMA_CTYPE_INT int
+#define SCHEMA_CTYPE_INT64 int64_t
+#define SCHEMA_CTYPE_REAL double
+#define SCHEMA_CTYPE_TEXT const char *
+
+#define SCHEMA_BIND_ID(stmt, i, v) ((v) ? sqlite3_bind_int64(stmt, i, v) : sqlite3_bind_null(stmt, i))   // 0 lets SQLite assign the id
+#define SCHEMA_BIND_INT(stmt, i, v) sqlite3_bind_int(stmt, i, v)
+#define SCHEMA_BIND_INT64(stmt, i, v) sqlite3_bind_int64(stmt, i, v)
+#define SCHEMA_BIND_REAL(stmt, i, v) sqlite3_bind_double(stmt, i, v)
+#define SCHEMA_BIND_TEXT(stmt, i, v) sqlite3_bind_text(stmt, i, v, -1, SQLITE_STATIC)
+
+#define SCHEMA_COLUMN_ID(stmt, i) sqlite3_column_int64(stmt, i)
+#define SCHEMA_COLUMN_INT(stmt, i) sqlite3_column_int(stmt, i)
+#define SCHEMA_COLUMN_INT64(stmt, i) sqlite3_column_int64(stmt, i)
+#define SCHEMA_COLUMN_REAL(stmt, i) sqlite3_column_double(stmt, i)
+#define SCHEMA_COLUMN_TEXT(stmt, i) ((const char *)sqlite3_column_text(stmt, i))
+
+static inline void schemaWriteCSV_ID(FILE *out, int64_t value) { fprintf(out, "%lld", (long long)value); }
+static inline void schemaWriteCSV_INT(FILE *out, int value) { fprintf(out, "%d", value); }
+static inline void schemaWriteCSV_INT64(FILE *out, int64_t value) { fprintf(out, "%lld", (long long)value); }
+static inline void schemaWriteCSV_REAL(FILE *out, double value) { fprintf(out, "%.2f", value); }   // Every REAL column is an amount
+
+static inline void schemaWriteCSV_TEXT(FILE *out, const char *value) {
+    if (value == NULL) {
+        return;
+    }
+    if (strpbrk(value, ",\"\r\n") == NULL) {
+        fputs(value, out);
+        return;
+    }
+    fputc('"', out);
+    for (const char *c = value; *c; c++) {
+        if (*c == '"') {
+            fputc('"', out);
+        }
+        fputc(*c, out);
+    }
+    fputc('"', out);
+}
+
+// Column-list expansions
+#define SCHEMA_FIELD(name, kind, decl) SCHEMA_CTYPE_##kind name;
+#define SCHEMA_DDL_FIRST(name, kind, decl) #name " " decl
+#define SCHEMA_DDL_NEXT(name, kind, decl) ", " #name " " decl
+#define SCHEMA_NAME_FIRST(name, kind, decl) #name
+#define SCHEMA_NAME_NEXT(name, kind, decl) ", " #name
+#define SCHEMA_CSV_NEXT(name, kind, decl) "," #name
+#define SCHEMA_PARAM_NEXT(name, kind, decl) ", ?"
+#define SCHEMA_ASSIGN_FIRST(name, kind, decl) #name " = ?"
+#define SCHEMA_ASSIGN_NEXT(name, kind, decl) ", " #name " = ?"
+#define SCHEMA_EXCLUDED_FIRST(name, kind, decl) #name " = excluded." #name
+#define SCHEMA_EXCLUDED_NEXT(name, kind, decl) ", " #name " = excluded." #name
+#define SCHEMA_BIND_FIELD(name, kind, decl) SCHEMA_BIND_##kind(stmt, ++i, row->name);
+#define SCHEMA_READ_FIELD(name, kind, decl) row->name = SCHEMA_COLUMN_##kind(stmt, i++);
+#define SCHEMA_CSV_KEY_FIELD(name, kind, decl) \
+    if (sqlite3_column_type(stmt, i++) != SQLITE_NULL) schemaWriteCSV_##kind(out, row->name);
+#define SCHEMA_CSV_FIELD(name, kind, decl) fputc(',', out); SCHEMA_CSV_KEY_FIELD(name, kind, decl)
+
+// SQL for a table, as string literals so callers can append clauses:
+//   SCHEMA_SELECT_SQL(SCHEMA_RECURRING) " WHERE type = 'income';"
+#define SCHEMA_CREATE_SQL(...) SCHEMA_CREATE_SQL_(__VA_ARGS__)
+#define SCHEMA_CREATE_SQL_(table, Row, KEY, COLUMNS) \
+    "CREATE TABLE IF NOT EXISTS " #table " (" KEY(SCHEMA_DDL_FIRST) COLUMNS(SCHEMA_DDL_NEXT) ");"
+#define SCHEMA_INSERT_SQL(...) SCHEMA_INSERT_SQL_(__VA_ARGS__)
+#define SCHEMA_INSERT_SQL_(table, Row, KEY, COLUMNS) \
+    "INSERT INTO " #table " (" KEY(SCHEMA_NAME_FIRST) COLUMNS(SCHEMA_NAME_NEXT) ") VALUES (?" COLUMNS(SCHEMA_PARAM_NEXT) ")"
+// Insert, or replace every column of the row with the same key; binds like SCHEMA_INSERT_SQL
+#define SCHEMA_UPSERT_SQL(...) SCHEMA_UPSERT_SQL_(__VA_ARGS__)
+#define SCHEMA_UPSERT_SQL_(table, Row, KEY, COLUMNS) \
+    SCHEMA_INSERT_SQL_(table, Row, KEY, COLUMNS) " ON CONFLICT(" KEY(SCHEMA_NAME_FIRST) ") DO UPDATE SET " \
+    KEY(SCHEMA_EXCLUDED_FIRST) COLUMNS(SCHEMA_EXCLUDED_NEXT)
+// Rewrite every column of the row with the given key; never inserts
+#define SCHEMA_UPDATE_SQL(...) SCHEMA_UPDATE_SQL_(__VA_ARGS__)
+#define SCHEMA_UPDATE_SQL_(table, Row, KEY, COLUMNS) \
+    "UPDATE " #table " SET " KEY(SCHEMA_ASSIGN_FIRST) COLUMNS(SCHEMA_ASSIGN_NEXT) " WHERE " KEY(SCHEMA_ASSIGN_FIRST)
+#define SCHEMA_SELECT_SQL(...) SCHEMA_SELECT_SQL_(__VA_ARGS__)
+#define SCHEMA_SELECT_SQL_(table, Row, KEY, COLUMNS) \
+    "SELECT " KEY(SCHEMA_NAME_FIRST) COLUMNS(SCHEMA_NAME_NEXT) " FROM " #table
+#define SCHEMA_COLUMN_LIST(...) SCHEMA_COLUMN_LIST_(__VA_ARGS__)
+#define SCHEMA_COLUMN_LIST_(table, Row, KEY, COLUMNS) KEY(SCHEMA_NAME_FIRST) COLUMNS(SCHEMA_NAME_NEXT)
+// A copy of a table in another schema, such as an archive: the key keeps the copied ids, so it
+// is a plain INTEGER PRIMARY KEY. Only for tables whose key is an ID column.
+#define SCHEMA_COPY_CREATE_SQL(schema, ...) SCHEMA_COPY_CREATE_SQL_(schema, __VA_ARGS__)
+#define SCHEMA_COPY_CREATE_SQL_(schema, table, Row, KEY, COLUMNS) \
+    "CREATE TABLE IF NOT EXISTS " schema "." #table " (" KEY(SCHEMA_NAME_FIRST) " INTEGER PRIMARY KEY" \
+    COLUMNS(SCHEMA_DDL_NEXT) ");"
+#define SCHEMA_CSV_HEADER(...) SCHEMA_CSV_HEADER_(__VA_ARGS__)
+#define SCHEMA_CSV_HEADER_(table, Row, KEY, COLUMNS) KEY(SCHEMA_NAME_FIRST) COLUMNS(SCHEMA_CSV_NEXT) "\n"
+
+// Row struct plus typed helpers for each table:
+//   schemaBind_<table>(stmt, row)   binds a row to SCHEMA_INSERT_SQL or SCHEMA_UPSERT_SQL
+//   schemaBindUpdate_<table>(stmt, row) binds a row to SCHEMA_UPDATE_SQL
+//   schemaRead_<table>(stmt, row)   reads a row from SCHEMA_SELECT_SQL
+//   schemaWriteCSV_<table>(out, stmt, row) writes a row read from stmt as one CSV line;
+//                                   NULL columns are left empty
+#define SCHEMA_DEFINE_TABLE(...) SCHEMA_DEFINE_TABLE_(__VA_ARGS__)
+#define SCHEMA_DEFINE_TABLE_(table, Row, KEY, COLUMNS) \
+    typedef struct { KEY(SCHEMA_FIELD) COLUMNS(SCHEMA_FIELD) } Row; \
+    static inline void schemaBind_##table(sqlite3_stmt *stmt, const Row *row) { \
+        int i = 0; \
+        KEY(SCHEMA_BIND_FIELD) COLUMNS(SCHEMA_BIND_FIELD) \
+    } \
+    static inline void schemaBindUpdate_##table(sqlite3_stmt *stmt, const Row *row) { \
+        int i = 0; \
+        KEY(SCHEMA_BIND_FIELD) COLUMNS(SCHEMA_BIND_FIELD) KEY(SCHEMA_BIND_FIELD) \
+    } \
+    static inline void schemaRead_##table(sqlite3_stmt *stmt, Row *row) { \
+        int i = 0; \
+        KEY(SCHEMA_READ_FIELD) COLUMNS(SCHEMA_READ_FIELD) \
+    } \
+    static inline void schemaWriteCSV_##table(FILE *out, sqlite3_stmt *stmt, const Row *row) { \
+        int i = 0; \
+        KEY(SCHEMA_CSV_KEY_FIELD) COLUMNS(SCHEMA_CSV_FIELD) \
+        fputc('\n', out); \
+    }
+
+SCHEMA_TABLES(SCHEMA_DEFINE_TABLE)
+
+#define EXPORT_DIR "exports"
+
+// Function prototypes for schema-driven table exports
+int exportTablesToCSV(sqlite3 *db, const char *dir);
+void exportTablesPrompt(sqlite3 *db);
+
+#endif
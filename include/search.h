@@ -0,0 +1,18 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+#include <sqlite3.h>
+
+#define SEARCH_MAX_RESULTS 50
+
+// Base-currency spend of the category_totals row aliased c: the triggers sum base-currency
+// rows, and rows in other currencies are converted here, at their own dates' rates
+#define CATEGORY_TOTAL_SQL \
+    "(c.total + CASE WHEN c.foreign_count > 0 THEN (SELECT IFNULL(SUM(to_base(amount, currency, date)), 0) " \
+    "FROM expenses WHERE category = c.category AND currency IS NOT NULL AND currency <> '') ELSE 0 END)"
+
+// Function prototypes for full-text and prefix search
+int initializeSearchIndex(sqlite3 *db);
+void searchLedger(sqlite3 *db, const char *query);
+void searchTransactions(sqlite3 *db);
+
+#endif
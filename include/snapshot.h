@@ -0,0 +1,71 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+#include <sqlite3.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "utils.h"
+
+#define SNAPSHOT_FILE "finance_lite.snap"
+#define SNAPSHOT_MAGIC "FLSNAP1"
+#define SNAPSHOT_VERSION 4
+
+// On-disk header; amounts are in the base currency and every section offset is 8-byte aligned and relative to the start of the file
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t category_count;
+    int64_t income_count;
+    int64_t expense_count;
+    int64_t goal_count;
+    int64_t last_income_id;       // Highest row id captured, for incremental regeneration
+    int64_t last_expense_id;
+    double recurring_expense_total;
+    double archived_income_total;   // From the archive summaries
+    int64_t unconverted_count;      // Rows with no exchange rate, stored as 0
+    int64_t change_count;           // snapshot_state.changes when written; edits and deletes bump it
+    uint32_t rates_checksum;        // CRC-32 of the base currency and rates the amounts were converted with
+    uint32_t reserved;
+    int64_t income_amount_offset;   // double[income_count]
+    int64_t income_date_offset;     // int32_t[income_count], YYYYMMDD
+    int64_t expense_amount_offset;  // double[expense_count]
+    int64_t expense_date_offset;    // int32_t[expense_count], YYYYMMDD
+    int64_t expense_category_offset;// uint32_t[expense_count], index into the category dictionary
+    int64_t category_offset;        // char[category_count][MAX_NAME_LENGTH]
+    int64_t archive_total_offset;   // double[category_count], archived expenses per category
+    int64_t goal_offset;            // SnapshotGoal[goal_count]
+    int64_t file_size;
+    uint32_t data_checksum;         // CRC-32 of everything after the header
+    uint32_t header_checksum;       // CRC-32 of the header up to this field
+} SnapshotHeader;
+
+typedef struct {
+    char name[MAX_NAME_LENGTH];
+    double target_amount;
+    double saved_amount;
+} SnapshotGoal;
+
+// A read-only memory-mapped snapshot; the column pointers point straight into the mapping
+typedef struct {
+    void *map;
+    size_t size;
+    const SnapshotHeader *header;
+    const double *income_amounts;
+    const int32_t *income_dates;
+    const double *expense_amounts;
+    const int32_t *expense_dates;
+    const uint32_t *expense_categories;
+    const char (*categories)[MAX_NAME_LENGTH];
+    const double *archive_totals;
+    const SnapshotGoal *goals;
+} Snapshot;
+
+// Function prototypes for binary snapshots
+int initializeSnapshotTracking(sqlite3 *db);
+int writeSnapshot(sqlite3 *db, const char *path);
+void refreshSnapshot(sqlite3 *db, const char *path);
+int openSnapshot(const char *path, Snapshot *snapshot);
+void closeSnapshot(Snapshot *snapshot);
+void showSnapshotAnalytics(const Snapshot *snapshot);
+int showSnapshotReport(const char *path);
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef STRESS_H
+#define STRESS_H
+
+#define STRESS_LEDGER "finance_lite_stress.db"   // Scratch ledger, recreated by every run
+#define STRESS_CRASH_LEDGER "finance_lite_crash.db"   // Journaled ledger for the crash phase
+#define STRESS_TWIN_LEDGER "finance_lite_twins.db"   // Identical recurring entries for the twin check
+#define STRESS_SNAPSHOT_FILE "finance_lite_stress.snap"   // Extended at every check
+#define STRESS_RATES_FILE "finance_lite_stress_rates.csv"
+#define STRESS_DEFAULT_OPERATIONS 20000
+#define STRESS_DEFAULT_THREADS 4
+#define STRESS_CHECK_EVERY 1000      // Random operations between invariant checks
+#define STRESS_MONTH_EVERY 400       // Random operations per simulated month
+#define STRESS_MAX_RECURRING 24      // Recurring entries of each type
+#define STRESS_RETRY_SLEEP_MS 1      // Back-off after SQLITE_BUSY in the threaded phase
+#define STRESS_CRASH_ROUNDS 4        // Journal writers killed in the crash phase
+#define STRESS_CRASH_MAX_DELAY_MS 1500    // Longest a writer runs before it is killed
+#define STRESS_CRASH_MAX_RECORDS 16000000  // Appends before an unkilled writer gives up
+
+// Function prototypes for the randomized storage and report stress run
+int runStressTest(int operations, int threads, unsigned long long seed);
+
+#endif
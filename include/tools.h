@@ -0,0 +1,9 @@
+#ifndef TOOLS_H
+#define TOOLS_H
+
+#include <sqlite3.h>
+
+// Function prototypes for the reports & tools menu
+void manageTools(sqlite3 *db);
+
+#endif
@@ -1,12 +1,38 @@
 #ifndef UTILS_H
 #define UTILS_H
 
+#include <stddef.h>
+
 #define MAX_NAME_LENGTH 50   
+#define INPUT_BUFFER_SIZE 65536
+#define INPUT_LINE_MAX 1024
+
+// Line-buffered reader over a file descriptor; lines are returned without the newline and
+// anything past INPUT_LINE_MAX - 1 characters is dropped
+typedef struct {
+    int fd;
+    size_t start;
+    size_t end;
+    int eof;
+    char buffer[INPUT_BUFFER_SIZE];
+    char line[INPUT_LINE_MAX];
+} LineReader;
 
 // Helper function prototypes
+void initLineReader(LineReader *reader, int fd);
+char *readLine(LineReader *reader);
+char *readInputLine(void);
+char *nextToken(char **cursor, char delimiter);
+int parseIntToken(const char *text, int *value);
+int parseDecimalToken(const char *text, double *value);
+int parseDateToken(const char *text, int *year, int *month, int *day);
 int getValidIntInput();
 float getValidFloatInput();
 void getValidStringInput(char *input, int max_len);
+int getOptionalStringInput(char *input, int max_len);
 int getValidDateInput(char *date, int max_len);
+char getValidCharInput();
+unsigned int hashString(const char *text);
+unsigned int computeChecksum(const void *data, size_t length, unsigned int seed);
 
 #endif
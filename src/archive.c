@@ -0,0 +1,300 @@
+#define _XOPEN_SOURCE 700
+#include "archive.h"
+#include "batch.h"
+#include "utils.h"
+#include "currency.h"
+#include "metrics.h"
+#include "schema.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <sqlite3.h>
+
+// Archived years live in <ledger>_archive_YYYY.db next to the ledger. The ledger keeps one
+// summary row per year in `archives` and per-category totals in `archive_category_totals`,
+// so all-time reports never open the archive files.
+
+static void archivePath(sqlite3 *db, int year, char *path, size_t size) {
+    const char *db_path = sqlite3_db_filename(db, "main");
+    if (db_path == NULL || db_path[0] == '\0') {
+        db_path = "finance_lite.db";
+    }
+    size_t length = strlen(db_path);
+    if (length > 3 && strcmp(db_path + length - 3, ".db") == 0) {
+        length -= 3;
+    }
+    snprintf(path, size, "%.*s_archive_%04d.db", (int)length, db_path, year);
+}
+
+static int execBound(sqlite3 *db, const char *sql, int year, const char *path) {
+    sqlite3_stmt *stmt;
+    char from[24], to[24];
+    snprintf(from, sizeof(from), "%04d-01-01", year);
+    snprintf(to, sizeof(to), "%04d-01-01", year + 1);
+
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        return 0;
+    }
+    // Parameters are by name so each statement can use whichever it needs
+    sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, ":from"), from, -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, ":to"), to, -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(stmt, sqlite3_bind_parameter_index(stmt, ":year"), year);
+    sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, ":path"), path, -1, SQLITE_STATIC);
+    int rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    return rc == SQLITE_DONE;
+}
+
+// Move one year's income and expenses into its archive file and fold them into the summaries
+static int archiveYear(sqlite3 *db, int year) {
+    char path[1024];
+    archivePath(db, year, path, sizeof(path));
+
+    static const char *steps[] = {
+        SCHEMA_COPY_CREATE_SQL("archive", SCHEMA_INCOME),
+        SCHEMA_COPY_CREATE_SQL("archive", SCHEMA_EXPENSES),
+        "CREATE INDEX IF NOT EXISTS archive.idx_income_date ON income(date);",
+        "CREATE INDEX IF NOT EXISTS archive.idx_expenses_date ON expenses(date);",
+        "INSERT INTO archives (year, path, income_total, income_count, expense_total, expense_count) "
+        "SELECT :year, :path, "
+        "(SELECT IFNULL(SUM(to_base(amount, currency, date)), 0) FROM main.income WHERE date >= :from AND date < :to), "
+        "(SELECT COUNT(*) FROM main.income WHERE date >= :from AND date < :to), "
+        "(SELECT IFNULL(SUM(to_base(amount, currency, date)), 0) FROM main.expenses WHERE date >= :from AND date < :to), "
+        "(SELECT COUNT(*) FROM main.expenses WHERE date >= :from AND date < :to) "
+        "ON CONFLICT(year) DO UPDATE SET income_total = income_total + excluded.income_total, "
+        "income_count = income_count + excluded.income_count, "
+        "expense_total = expense_total + excluded.expense_total, "
+        "expense_count = expense_count + excluded.expense_count;",
+        "INSERT INTO archive_category_totals (year, category, total, count) "
+        "SELECT :year, IFNULL(category, ''), SUM(to_base(amount, currency, date)), COUNT(*) FROM main.expenses "
+        "WHERE date >= :from AND date < :to GROUP BY IFNULL(category, '') "
+        "ON CONFLICT(year, category) DO UPDATE SET total = total + excluded.total, count = count + excluded.count;",
+        "INSERT INTO archive.income (" SCHEMA_COLUMN_LIST(SCHEMA_INCOME) ") "
+        "SELECT " SCHEMA_COLUMN_LIST(SCHEMA_INCOME) " FROM main.income WHERE date >= :from AND date < :to;",
+        "INSERT INTO archive.expenses (" SCHEMA_COLUMN_LIST(SCHEMA_EXPENSES) ") "
+        "SELECT " SCHEMA_COLUMN_LIST(SCHEMA_EXPENSES) " FROM main.expenses WHERE date >= :from AND date < :to;",
+        "DELETE FROM main.income WHERE date >= :from AND date < :to;",
+        "DELETE FROM main.expenses WHERE date >= :from AND date < :to;",
+    };
+
+    // ATTACH and DETACH are not allowed inside a transaction, so commit any open batch first
+    flushBatch();
+    if (!execBound(db, "ATTACH DATABASE :path AS archive;", year, path)) {
+        printf("Error: Could not open archive %s: %s\n", path, sqlite3_errmsg(db));
+        return 0;
+    }
+    // Archives written before amounts had a currency get the column before more rows are added
+    if (!ensureCurrencyColumn(db, "archive", "income") || !ensureCurrencyColumn(db, "archive", "expenses")) {
+        sqlite3_exec(db, "DETACH DATABASE archive;", 0, 0, NULL);
+        return 0;
+    }
+
+    // One transaction across both files: the rows are either moved and summarized, or untouched
+    int ok = 1;
+    beginBatchedWrite();
+    sqlite3_exec(db, "SAVEPOINT archive_year;", 0, 0, NULL);
+    for (size_t i = 0; ok && i < sizeof(steps) / sizeof(steps[0]); i++) {
+        ok = execBound(db, steps[i], year, path);
+    }
+    if (!ok) {
+        printf("Error: Failed to archive %d: %s\n", year, sqlite3_errmsg(db));
+        sqlite3_exec(db, "ROLLBACK TO archive_year;", 0, 0, NULL);
+    }
+    sqlite3_exec(db, "RELEASE archive_year;", 0, 0, NULL);
+    endBatchedWrite();
+    flushBatch();
+
+    sqlite3_exec(db, "DETACH DATABASE archive;", 0, 0, NULL);
+    if (ok) {
+        printf("Archived %d to %s.\n", year, path);
+    }
+    return ok;
+}
+
+// Function to archive every year up to and including through_year; the current year stays open
+int archiveClosedYears(sqlite3 *db, int through_year) {
+    time_t t = time(NULL);
+    int current_year = localtime(&t)->tm_year + 1900;
+    if (through_year >= current_year) {
+        printf("Error: Only years before %d can be archived.\n", current_year);
+        return 0;
+    }
+
+    char before[24];
+    snprintf(before, sizeof(before), "%04d-01-01", through_year + 1);
+    const char *years_sql =
+        "SELECT DISTINCT CAST(substr(date, 1, 4) AS INTEGER) FROM ("
+        "SELECT date FROM income WHERE date < ?1 UNION ALL SELECT date FROM expenses WHERE date < ?1) "
+        "ORDER BY 1;";
+    sqlite3_stmt *stmt;
+    int years[256];
+    int count = 0;
+
+    if (sqlite3_prepare_v2(db, years_sql, -1, &stmt, NULL) != SQLITE_OK) {
+        printf("SQLite Error: %s\n", sqlite3_errmsg(db));
+        return 0;
+    }
+    sqlite3_bind_text(stmt, 1, before, -1, SQLITE_STATIC);
+    while (sqlite3_step(stmt) == SQLITE_ROW && count < (int)(sizeof(years) / sizeof(years[0]))) {
+        years[count++] = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+
+    if (count == 0) {
+        printf("Nothing to archive up to %d.\n", through_year);
+        return 1;
+    }
+    int archived = 0;
+    for (int i = 0; i < count; i++) {
+        archived += archiveYear(db, years[i]);
+    }
+    return archived == count;
+}
+
+// Function to prompt for the last year to archive
+void archiveClosedYearsPrompt(sqlite3 *db) {
+    printf("Archive all income and expenses up to and including year (YYYY): ");
+    archiveClosedYears(db, getValidIntInput());
+}
+
+// Add one partition's income and expenses in [from, to] to the running range totals
+static void addPartitionRange(sqlite3 *db, const char *schema, const char *from, const char *to, double *income) {
+    char sql[512];
+    sqlite3_stmt *stmt;
+
+    snprintf(sql, sizeof(sql), "SELECT IFNULL(SUM(to_base(amount, currency, date)), 0) FROM %s.income "
+             "WHERE date BETWEEN ?1 AND ?2;", schema);
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, from, -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 2, to, -1, SQLITE_STATIC);
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            *income += sqlite3_column_double(stmt, 0);
+        }
+    }
+    sqlite3_finalize(stmt);
+
+    snprintf(sql, sizeof(sql),
+             "INSERT INTO temp.range_categories (category, total) "
+             "SELECT IFNULL(category, ''), SUM(to_base(amount, currency, date)) FROM %s.expenses "
+             "WHERE date BETWEEN ?1 AND ?2 "
+             "GROUP BY IFNULL(category, '') "
+             "ON CONFLICT(category) DO UPDATE SET total = total + excluded.total;", schema);
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, from, -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 2, to, -1, SQLITE_STATIC);
+        sqlite3_step(stmt);
+    }
+    sqlite3_finalize(stmt);
+}
+
+// Function to total income and expenses between two dates (inclusive) across the ledger and
+// its archives, in the base currency; from may be "" for no lower bound. Archived years fully
+// inside the range are answered from their summaries; only a partly covered year has its
+// archive file attached and scanned. Per-category totals are left in temp.range_categories.
+void collectRangeTotals(sqlite3 *db, const char *from, const char *to, RangeTotals *totals) {
+    sqlite3_stmt *stmt;
+
+    totals->income = 0;
+    totals->expenses = 0;
+    snprintf(totals->partitions, sizeof(totals->partitions), "ledger");
+
+    flushBatch();   // ATTACH below needs no open transaction
+    sqlite3_exec(db, "CREATE TEMP TABLE IF NOT EXISTS range_categories (category TEXT PRIMARY KEY, total REAL);"
+                     "DELETE FROM temp.range_categories;", 0, 0, NULL);
+    addPartitionRange(db, "main", from, to, &totals->income);
+
+    const char *archives_sql = "SELECT year, path, income_total FROM archives "
+                               "WHERE year BETWEEN CAST(substr(?1, 1, 4) AS INTEGER) AND CAST(substr(?2, 1, 4) AS INTEGER) "
+                               "ORDER BY year;";
+    if (sqlite3_prepare_v2(db, archives_sql, -1, &stmt, NULL) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, from, -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 2, to, -1, SQLITE_STATIC);
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            int year = sqlite3_column_int(stmt, 0);
+            char year_start[24], year_end[24];
+            snprintf(year_start, sizeof(year_start), "%04d-01-01", year);
+            snprintf(year_end, sizeof(year_end), "%04d-12-31", year);
+            size_t length = strlen(totals->partitions);
+            char *partitions = totals->partitions;
+
+            if (strcmp(from, year_start) <= 0 && strcmp(to, year_end) >= 0) {
+                // Whole year in range: use the summary rows
+                totals->income += sqlite3_column_double(stmt, 2);
+                const char *merge_sql = "INSERT INTO temp.range_categories (category, total) "
+                                   "SELECT category, total FROM archive_category_totals WHERE year = ? "
+                                   "ON CONFLICT(category) DO UPDATE SET total = total + excluded.total;";
+                sqlite3_stmt *merge;
+                if (sqlite3_prepare_v2(db, merge_sql, -1, &merge, NULL) == SQLITE_OK) {
+                    sqlite3_bind_int(merge, 1, year);
+                    sqlite3_step(merge);
+                }
+                sqlite3_finalize(merge);
+                snprintf(partitions + length, sizeof(totals->partitions) - length, ", %d (summary)", year);
+            } else if (execBound(db, "ATTACH DATABASE :path AS archive;", year,
+                                 (const char *)sqlite3_column_text(stmt, 1))) {
+                ensureCurrencyColumn(db, "archive", "income");
+                ensureCurrencyColumn(db, "archive", "expenses");
+                addPartitionRange(db, "archive", from, to, &totals->income);
+                sqlite3_exec(db, "DETACH DATABASE archive;", 0, 0, NULL);
+                snprintf(partitions + length, sizeof(totals->partitions) - length, ", %d (archive)", year);
+            } else {
+                printf("Warning: Archive for %d could not be opened; its rows are missing from this report.\n", year);
+            }
+        }
+    }
+    sqlite3_finalize(stmt);
+
+    if (sqlite3_prepare_v2(db, "SELECT IFNULL(SUM(total), 0) FROM temp.range_categories;", -1, &stmt,
+                           NULL) == SQLITE_OK && sqlite3_step(stmt) == SQLITE_ROW) {
+        totals->expenses = sqlite3_column_double(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+}
+
+// Function to print the per-category totals left by collectRangeTotals, largest first
+void showRangeCategories(sqlite3 *db) {
+    const char *category_sql = "SELECT category, total FROM temp.range_categories ORDER BY total DESC;";
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, category_sql, -1, &stmt, NULL) == SQLITE_OK) {
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            const char *category = (const char *)sqlite3_column_text(stmt, 0);
+            printf(" - %s: $%.2f\n", category[0] ? category : "(none)", sqlite3_column_double(stmt, 1));
+        }
+    }
+    sqlite3_finalize(stmt);
+}
+
+// Function to report income and expenses between two dates (inclusive) across the ledger and
+// its archives
+void showRangeReport(sqlite3 *db, const char *from, const char *to) {
+    RangeTotals totals;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    collectRangeTotals(db, from, to, &totals);
+
+    printf("\n=== Report %s to %s ===\n", from, to);
+    printf("Total Income: $%.2f\n", totals.income);
+
+    printf("\nExpense Breakdown by Category:\n");
+    showRangeCategories(db);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("\nTotal Expenses: $%.2f\n", totals.expenses);
+    printf("Net: $%.2f\n", totals.income - totals.expenses);
+    printf("Partitions read: %s (%.2f ms)\n", totals.partitions,
+           (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1e6);
+    reportMissingRates();
+    metricsObserveReport(METRIC_REPORT_RANGE, &start);
+}
+
+// Function to prompt for a date range and show the report
+void showRangeReportPrompt(sqlite3 *db) {
+    char from[11], to[11];
+
+    printf("Enter start date (YYYY-MM-DD): ");
+    getValidDateInput(from, sizeof(from));
+    printf("Enter end date (YYYY-MM-DD): ");
+    getValidDateInput(to, sizeof(to));
+    showRangeReport(db, from, to);
+}
@@ -0,0 +1,900 @@
+#define _XOPEN_SOURCE 700
+#include "backup.h"
+#include "batch.h"
+#include "utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <pthread.h>
+#include <zlib.h>
+#include <sqlite3.h>
+
+// Tables copied by a backup. Tables with an id are backed up incrementally: new rows by id
+// high-water mark, updates and deletes through backup_changelog. The small settings tables
+// are copied whole every time. Derived tables (search index, history, totals) are rebuilt
+// by the backfills in their initialize functions when a restored ledger is first opened.
+// New tables go at the end: backup records refer to tables by their index in this list.
+static const struct {
+    const char *name;
+    int incremental;
+} backup_tables[] = {
+    {"income", 1},
+    {"expenses", 1},
+    {"savings_goals", 1},
+    {"recurring", 1},
+    {"goal_contributions", 1},
+    {"category_limits", 0},
+    {"last_processed_month", 0},
+    {"category_rules", 0},
+    {"exchange_rates", 0},
+    {"archives", 0},                  // Summaries of archived years; reports add them to the live rows
+    {"archive_category_totals", 0},
+    {"recurring_postings", 1},        // Posting fingerprints can't be rebuilt from the rows
+    {"ledger_currency", 0},           // The base currency the NULL-currency rows are in
+};
+#define BACKUP_TABLE_COUNT (int)(sizeof(backup_tables) / sizeof(backup_tables[0]))
+
+// Record types in the compressed stream
+enum {
+    RECORD_END = 0,
+    RECORD_SCHEMA = 1,   // text: CREATE TABLE statement
+    RECORD_ROW = 2,      // table, column count, values; inserted or replaced
+    RECORD_DELETE = 3,   // table, id
+    RECORD_CLEAR = 4     // table; delete every row before the rows that follow
+};
+
+enum {
+    VALUE_NULL = 0,
+    VALUE_INTEGER = 1,
+    VALUE_REAL = 2,
+    VALUE_TEXT = 3
+};
+
+typedef struct {
+    FILE *file;
+    z_stream stream;
+    size_t in_used;
+    int64_t raw_size;
+    int64_t compressed_size;
+    int64_t records;
+    uint32_t checksum;
+    int failed;
+    unsigned char in[BACKUP_CHUNK_SIZE];
+    unsigned char out[BACKUP_CHUNK_SIZE];
+} BackupWriter;
+
+typedef struct {
+    FILE *file;
+    z_stream stream;
+    size_t out_pos;
+    size_t out_len;
+    uint32_t checksum;
+    int finished;
+    int failed;
+    unsigned char in[BACKUP_CHUNK_SIZE];
+    unsigned char out[BACKUP_CHUNK_SIZE];
+} BackupReader;
+
+// Function to create the backup log, the per-table high-water marks and the change log.
+// The change log triggers do nothing until the first backup exists.
+int initializeBackupTracking(sqlite3 *db) {
+    char sql[4096];
+    size_t length = snprintf(sql, sizeof(sql),
+        "CREATE TABLE IF NOT EXISTS backups ("
+        "sequence INTEGER PRIMARY KEY, "
+        "kind TEXT NOT NULL, "
+        "base_sequence INTEGER NOT NULL, "
+        "path TEXT NOT NULL, "
+        "created TEXT NOT NULL, "
+        "raw_size INTEGER, "
+        "compressed_size INTEGER, "
+        "record_count INTEGER, "
+        "duration_ms REAL);"
+        "CREATE TABLE IF NOT EXISTS backup_state ("
+        "table_name TEXT PRIMARY KEY, "
+        "last_id INTEGER NOT NULL);"
+        "CREATE TABLE IF NOT EXISTS backup_changelog ("
+        "seq INTEGER PRIMARY KEY AUTOINCREMENT, "
+        "table_name TEXT NOT NULL, "
+        "row_id INTEGER NOT NULL);");
+
+    for (int i = 0; i < BACKUP_TABLE_COUNT; i++) {
+        if (!backup_tables[i].incremental) {
+            continue;
+        }
+        const char *name = backup_tables[i].name;
+        length += snprintf(sql + length, sizeof(sql) - length,
+            "CREATE TRIGGER IF NOT EXISTS %s_backup_au AFTER UPDATE ON %s WHEN EXISTS (SELECT 1 FROM backups) BEGIN "
+            "INSERT INTO backup_changelog (table_name, row_id) VALUES ('%s', old.id); END;"
+            "CREATE TRIGGER IF NOT EXISTS %s_backup_ad AFTER DELETE ON %s WHEN EXISTS (SELECT 1 FROM backups) BEGIN "
+            "INSERT INTO backup_changelog (table_name, row_id) VALUES ('%s', old.id); END;",
+            name, name, name, name, name, name);
+    }
+
+    char *err_msg = NULL;
+    if (sqlite3_exec(db, sql, 0, 0, &err_msg) != SQLITE_OK) {
+        printf("Error: Failed to create backup tables: %s\n", err_msg);
+        sqlite3_free(err_msg);
+        return 0;
+    }
+    return 1;
+}
+
+// Compress whatever is buffered; flush is Z_NO_FLUSH while writing and Z_FINISH at the end
+static void deflateBuffered(BackupWriter *writer, int flush) {
+    writer->stream.next_in = writer->in;
+    writer->stream.avail_in = writer->in_used;
+    do {
+        writer->stream.next_out = writer->out;
+        writer->stream.avail_out = sizeof(writer->out);
+        deflate(&writer->stream, flush);
+        size_t have = sizeof(writer->out) - writer->stream.avail_out;
+        if (have > 0 && fwrite(writer->out, 1, have, writer->file) != have) {
+            writer->failed = 1;
+        }
+        writer->compressed_size += have;
+    } while (writer->stream.avail_out == 0);
+    writer->in_used = 0;
+}
+
+static void writerPut(BackupWriter *writer, const void *data, size_t length) {
+    const unsigned char *bytes = data;
+    writer->checksum = computeChecksum(data, length, writer->checksum);
+    writer->raw_size += length;
+
+    while (length > 0) {
+        size_t room = sizeof(writer->in) - writer->in_used;
+        size_t take = length < room ? length : room;
+        memcpy(writer->in + writer->in_used, bytes, take);
+        writer->in_used += take;
+        bytes += take;
+        length -= take;
+        if (writer->in_used == sizeof(writer->in)) {
+            deflateBuffered(writer, Z_NO_FLUSH);
+        }
+    }
+}
+
+static void writerPutU8(BackupWriter *writer, uint8_t value) {
+    writerPut(writer, &value, 1);
+}
+
+static void writerPutText(BackupWriter *writer, const char *text, uint32_t length) {
+    writerPut(writer, &length, sizeof(length));
+    writerPut(writer, text, length);
+}
+
+// Write the current row of stmt (every column of a backed-up table) as one record
+static void writeRowRecord(BackupWriter *writer, int table, sqlite3_stmt *stmt) {
+    int columns = sqlite3_column_count(stmt);
+    writerPutU8(writer, RECORD_ROW);
+    writerPutU8(writer, table);
+    writerPutU8(writer, columns);
+
+    for (int i = 0; i < columns; i++) {
+        switch (sqlite3_column_type(stmt, i)) {
+            case SQLITE_INTEGER: {
+                int64_t value = sqlite3_column_int64(stmt, i);
+                writerPutU8(writer, VALUE_INTEGER);
+                writerPut(writer, &value, sizeof(value));
+                break;
+            }
+            case SQLITE_FLOAT: {
+                double value = sqlite3_column_double(stmt, i);
+                writerPutU8(writer, VALUE_REAL);
+                writerPut(writer, &value, sizeof(value));
+                break;
+            }
+            case SQLITE_NULL:
+                writerPutU8(writer, VALUE_NULL);
+                break;
+            default:
+                writerPutU8(writer, VALUE_TEXT);
+                writerPutText(writer, (const char *)sqlite3_column_text(stmt, i), sqlite3_column_bytes(stmt, i));
+                break;
+        }
+    }
+    writer->records++;
+}
+
+static int64_t queryInt64(sqlite3 *db, const char *sql, const char *text) {
+    sqlite3_stmt *stmt;
+    int64_t value = 0;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) == SQLITE_OK) {
+        if (text != NULL) {
+            sqlite3_bind_text(stmt, 1, text, -1, SQLITE_STATIC);
+        }
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            value = sqlite3_column_int64(stmt, 0);
+        }
+    }
+    sqlite3_finalize(stmt);
+    return value;
+}
+
+// CRC-32 of the CREATE statements of the backed-up tables. Increments only apply on top of a
+// base with the same schema, so a change (such as an added column) forces a new base.
+static int64_t backupSchemaChecksum(sqlite3 *db) {
+    const char *sql = "SELECT sql FROM sqlite_master WHERE type = 'table' AND name = ?;";
+    sqlite3_stmt *stmt;
+    unsigned int checksum = 0;
+
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) == SQLITE_OK) {
+        for (int i = 0; i < BACKUP_TABLE_COUNT; i++) {
+            sqlite3_bind_text(stmt, 1, backup_tables[i].name, -1, SQLITE_STATIC);
+            if (sqlite3_step(stmt) == SQLITE_ROW) {
+                checksum = computeChecksum(sqlite3_column_text(stmt, 0), sqlite3_column_bytes(stmt, 0), checksum);
+            }
+            sqlite3_reset(stmt);
+        }
+    }
+    sqlite3_finalize(stmt);
+    return checksum;
+}
+
+// Stream rows of a table into the backup; only rows after since_id for incremental tables
+static int writeTableRows(sqlite3 *db, BackupWriter *writer, int table, int64_t since_id) {
+    char sql[256];
+    sqlite3_stmt *stmt;
+
+    if (backup_tables[table].incremental) {
+        snprintf(sql, sizeof(sql), "SELECT * FROM %s WHERE id > ? ORDER BY id;", backup_tables[table].name);
+    } else {
+        snprintf(sql, sizeof(sql), "SELECT * FROM %s;", backup_tables[table].name);
+    }
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        return 0;
+    }
+    sqlite3_bind_int64(stmt, 1, since_id);
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        writeRowRecord(writer, table, stmt);
+    }
+    sqlite3_finalize(stmt);
+    return 1;
+}
+
+// Write the current state of every row updated or deleted since the last backup. Rows above
+// the previous high-water mark are skipped: the id scan already carries their latest values.
+static int writeChangedRows(sqlite3 *db, BackupWriter *writer, const int64_t *since_ids) {
+    const char *changes_sql = "SELECT DISTINCT table_name, row_id FROM backup_changelog ORDER BY table_name, row_id;";
+    sqlite3_stmt *changes;
+    sqlite3_stmt *lookups[BACKUP_TABLE_COUNT] = {0};
+
+    if (sqlite3_prepare_v2(db, changes_sql, -1, &changes, NULL) != SQLITE_OK) {
+        return 0;
+    }
+    while (sqlite3_step(changes) == SQLITE_ROW) {
+        const char *name = (const char *)sqlite3_column_text(changes, 0);
+        int64_t row_id = sqlite3_column_int64(changes, 1);
+        int table = 0;
+        while (table < BACKUP_TABLE_COUNT && strcmp(backup_tables[table].name, name) != 0) {
+            table++;
+        }
+        if (table == BACKUP_TABLE_COUNT || row_id > since_ids[table]) {
+            continue;
+        }
+
+        if (lookups[table] == NULL) {
+            char sql[128];
+            snprintf(sql, sizeof(sql), "SELECT * FROM %s WHERE id = ?;", name);
+            sqlite3_prepare_v2(db, sql, -1, &lookups[table], NULL);
+        }
+        sqlite3_bind_int64(lookups[table], 1, row_id);
+        if (sqlite3_step(lookups[table]) == SQLITE_ROW) {
+            writeRowRecord(writer, table, lookups[table]);
+        } else {
+            writerPutU8(writer, RECORD_DELETE);
+            writerPutU8(writer, table);
+            writerPut(writer, &row_id, sizeof(row_id));
+            writer->records++;
+        }
+        sqlite3_reset(lookups[table]);
+    }
+    sqlite3_finalize(changes);
+    for (int i = 0; i < BACKUP_TABLE_COUNT; i++) {
+        sqlite3_finalize(lookups[i]);
+    }
+    return 1;
+}
+
+// Backups go in BACKUP_DIR next to the ledger, named <ledger>_NNNNNN.flb
+static void backupPath(sqlite3 *db, int64_t sequence, char *path, size_t size) {
+    const char *db_path = sqlite3_db_filename(db, "main");
+    if (db_path == NULL || db_path[0] == '\0') {
+        db_path = "finance_lite.db";
+    }
+    const char *slash = strrchr(db_path, '/');
+    const char *stem = slash ? slash + 1 : db_path;
+    int dir_length = slash ? (int)(slash - db_path + 1) : 0;
+    size_t stem_length = strlen(stem);
+    if (stem_length > 3 && strcmp(stem + stem_length - 3, ".db") == 0) {
+        stem_length -= 3;
+    }
+    snprintf(path, size, "%.*s%s/%.*s_%06lld.flb", dir_length, db_path, BACKUP_DIR,
+             (int)stem_length, stem, (long long)sequence);
+}
+
+// Function to write a compressed backup: a full base, or an increment holding only what
+// changed since the previous backup. Returns 1 on success.
+int createBackup(sqlite3 *db, int force_base) {
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    // Hold the batch lock for the whole backup so the rows read and the high-water marks
+    // recorded come from the same transaction
+    beginBatchedWrite();
+    sqlite3_exec(db, "SAVEPOINT backup;", 0, 0, NULL);
+
+    int64_t sequence = queryInt64(db, "SELECT IFNULL(MAX(sequence), 0) FROM backups;", NULL) + 1;
+    int64_t base_sequence = queryInt64(db, "SELECT IFNULL(MAX(sequence), 0) FROM backups WHERE kind = 'base';", NULL);
+    int64_t chain_length = sequence - base_sequence;
+    int64_t changelog_seq = queryInt64(db, "SELECT IFNULL(MAX(seq), 0) FROM backup_changelog;", NULL);
+
+    char path[1024];
+    if (base_sequence > 0) {
+        backupPath(db, base_sequence, path, sizeof(path));
+    }
+    int64_t schema_checksum = backupSchemaChecksum(db);
+    BackupKind kind = BACKUP_INCREMENT;
+    if (force_base || base_sequence == 0 || chain_length > BACKUP_MAX_CHAIN || access(path, R_OK) != 0 ||
+        queryInt64(db, "SELECT last_id FROM backup_state WHERE table_name = ?;", BACKUP_SCHEMA_KEY) != schema_checksum) {
+        kind = BACKUP_BASE;
+        base_sequence = sequence;
+    }
+
+    int64_t since_ids[BACKUP_TABLE_COUNT] = {0};
+    int64_t last_ids[BACKUP_TABLE_COUNT] = {0};
+    for (int i = 0; i < BACKUP_TABLE_COUNT; i++) {
+        if (backup_tables[i].incremental) {
+            char sql[128];
+            snprintf(sql, sizeof(sql), "SELECT IFNULL(MAX(id), 0) FROM %s;", backup_tables[i].name);
+            last_ids[i] = queryInt64(db, sql, NULL);
+            if (kind == BACKUP_INCREMENT) {
+                since_ids[i] = queryInt64(db, "SELECT last_id FROM backup_state WHERE table_name = ?;",
+                                          backup_tables[i].name);
+            }
+        }
+    }
+
+    backupPath(db, sequence, path, sizeof(path));
+    char dir[1024];
+    snprintf(dir, sizeof(dir), "%s", path);
+    *strrchr(dir, '/') = '\0';
+    mkdir(dir, 0755);
+
+    char tmp_path[1100];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+    BackupWriter *writer = calloc(1, sizeof(BackupWriter));
+    writer->file = fopen(tmp_path, "wb");
+    if (writer->file == NULL || deflateInit(&writer->stream, Z_DEFAULT_COMPRESSION) != Z_OK) {
+        printf("Error: Could not create backup file %s.\n", tmp_path);
+        if (writer->file) {
+            fclose(writer->file);
+        }
+        free(writer);
+        sqlite3_exec(db, "ROLLBACK TO backup; RELEASE backup;", 0, 0, NULL);
+        endBatchedWrite();
+        return 0;
+    }
+
+    BackupHeader header = {0};
+    fwrite(&header, sizeof(header), 1, writer->file);   // Placeholder until the sizes are known
+
+    int ok = 1;
+    if (kind == BACKUP_BASE) {
+        for (int i = 0; i < BACKUP_TABLE_COUNT; i++) {
+            char sql[128];
+            snprintf(sql, sizeof(sql), "SELECT sql FROM sqlite_master WHERE type = 'table' AND name = '%s';",
+                     backup_tables[i].name);
+            sqlite3_stmt *stmt;
+            if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) == SQLITE_OK && sqlite3_step(stmt) == SQLITE_ROW) {
+                writerPutU8(writer, RECORD_SCHEMA);
+                writerPutText(writer, (const char *)sqlite3_column_text(stmt, 0), sqlite3_column_bytes(stmt, 0));
+            }
+            sqlite3_finalize(stmt);
+        }
+    } else {
+        ok = writeChangedRows(db, writer, since_ids);
+    }
+    for (int i = 0; ok && i < BACKUP_TABLE_COUNT; i++) {
+        if (kind == BACKUP_INCREMENT && !backup_tables[i].incremental) {
+            writerPutU8(writer, RECORD_CLEAR);
+            writerPutU8(writer, i);
+        }
+        ok = writeTableRows(db, writer, i, since_ids[i]);
+    }
+    writerPutU8(writer, RECORD_END);
+    deflateBuffered(writer, Z_FINISH);
+    deflateEnd(&writer->stream);
+
+    memcpy(header.magic, BACKUP_MAGIC, sizeof(header.magic));
+    header.version = BACKUP_VERSION;
+    header.kind = kind;
+    header.sequence = sequence;
+    header.base_sequence = base_sequence;
+    header.created = time(NULL);
+    header.raw_size = writer->raw_size;
+    header.compressed_size = writer->compressed_size;
+    header.record_count = writer->records;
+    header.raw_checksum = writer->checksum;
+    header.header_checksum = computeChecksum(&header, offsetof(BackupHeader, header_checksum), 0);
+
+    ok = ok && !writer->failed && fseek(writer->file, 0, SEEK_SET) == 0 &&
+         fwrite(&header, sizeof(header), 1, writer->file) == 1 && fflush(writer->file) == 0 &&
+         fsync(fileno(writer->file)) == 0;
+    ok = (fclose(writer->file) == 0) && ok;
+    free(writer);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double elapsed_ms = (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1e6;
+
+    // Record the backup and advance the high-water marks only once the file is safely written
+    if (ok) {
+        sqlite3_stmt *stmt;
+        const char *log_sql = "INSERT INTO backups (sequence, kind, base_sequence, path, created, raw_size, "
+                              "compressed_size, record_count, duration_ms) "
+                              "VALUES (?, ?, ?, ?, datetime('now', 'localtime'), ?, ?, ?, ?);";
+        ok = sqlite3_prepare_v2(db, log_sql, -1, &stmt, NULL) == SQLITE_OK;
+        if (ok) {
+            sqlite3_bind_int64(stmt, 1, sequence);
+            sqlite3_bind_text(stmt, 2, kind == BACKUP_BASE ? "base" : "increment", -1, SQLITE_STATIC);
+            sqlite3_bind_int64(stmt, 3, base_sequence);
+            sqlite3_bind_text(stmt, 4, path, -1, SQLITE_STATIC);
+            sqlite3_bind_int64(stmt, 5, header.raw_size);
+            sqlite3_bind_int64(stmt, 6, header.compressed_size);
+            sqlite3_bind_int64(stmt, 7, header.record_count);
+            sqlite3_bind_double(stmt, 8, elapsed_ms);
+            ok = sqlite3_step(stmt) == SQLITE_DONE;
+        }
+        sqlite3_finalize(stmt);
+
+        const char *state_sql = "INSERT INTO backup_state (table_name, last_id) VALUES (?, ?) "
+                                "ON CONFLICT(table_name) DO UPDATE SET last_id = excluded.last_id;";
+        for (int i = 0; ok && i < BACKUP_TABLE_COUNT; i++) {
+            if (backup_tables[i].incremental && sqlite3_prepare_v2(db, state_sql, -1, &stmt, NULL) == SQLITE_OK) {
+                sqlite3_bind_text(stmt, 1, backup_tables[i].name, -1, SQLITE_STATIC);
+                sqlite3_bind_int64(stmt, 2, last_ids[i]);
+                ok = sqlite3_step(stmt) == SQLITE_DONE;
+                sqlite3_finalize(stmt);
+            }
+        }
+        if (ok && sqlite3_prepare_v2(db, state_sql, -1, &stmt, NULL) == SQLITE_OK) {
+            sqlite3_bind_text(stmt, 1, BACKUP_SCHEMA_KEY, -1, SQLITE_STATIC);
+            sqlite3_bind_int64(stmt, 2, schema_checksum);
+            ok = sqlite3_step(stmt) == SQLITE_DONE;
+            sqlite3_finalize(stmt);
+        }
+
+        if (ok && sqlite3_prepare_v2(db, "DELETE FROM backup_changelog WHERE seq <= ?;", -1, &stmt, NULL) == SQLITE_OK) {
+            sqlite3_bind_int64(stmt, 1, changelog_seq);
+            ok = sqlite3_step(stmt) == SQLITE_DONE;
+            sqlite3_finalize(stmt);
+        }
+        ok = ok && rename(tmp_path, path) == 0;
+    }
+
+    if (!ok) {
+        printf("Error: Backup failed: %s\n", sqlite3_errmsg(db));
+        remove(tmp_path);
+        sqlite3_exec(db, "ROLLBACK TO backup;", 0, 0, NULL);
+    }
+    sqlite3_exec(db, "RELEASE backup;", 0, 0, NULL);
+    endBatchedWrite();
+    flushBatch();
+
+    if (ok) {
+        printf("Backup %lld (%s", (long long)sequence, kind == BACKUP_BASE ? "base" : "increment");
+        if (kind == BACKUP_INCREMENT) {
+            printf(" on base %lld", (long long)base_sequence);
+        }
+        printf("): %lld records, %.1f KB -> %.1f KB compressed (%.1f%%) in %.2f ms\n",
+               (long long)header.record_count, header.raw_size / 1024.0, header.compressed_size / 1024.0,
+               header.raw_size ? header.compressed_size * 100.0 / header.raw_size : 0, elapsed_ms);
+        printf("Saved to %s\n", path);
+    }
+    return ok;
+}
+
+// Decompress into dst; returns 0 if the stream ends early or is corrupt
+static int readerGet(BackupReader *reader, void *dst, size_t length) {
+    unsigned char *bytes = dst;
+    while (length > 0) {
+        if (reader->out_pos == reader->out_len) {
+            if (reader->finished || reader->failed) {
+                return 0;
+            }
+            if (reader->stream.avail_in == 0) {
+                reader->stream.avail_in = fread(reader->in, 1, sizeof(reader->in), reader->file);
+                reader->stream.next_in = reader->in;
+            }
+            reader->stream.next_out = reader->out;
+            reader->stream.avail_out = sizeof(reader->out);
+            int rc = inflate(&reader->stream, Z_NO_FLUSH);
+            if (rc == Z_STREAM_END) {
+                reader->finished = 1;
+            } else if (rc != Z_OK) {
+                reader->failed = 1;
+            }
+            reader->out_pos = 0;
+            reader->out_len = sizeof(reader->out) - reader->stream.avail_out;
+            continue;
+        }
+        size_t take = reader->out_len - reader->out_pos;
+        if (take > length) {
+            take = length;
+        }
+        memcpy(bytes, reader->out + reader->out_pos, take);
+        reader->checksum = computeChecksum(bytes, take, reader->checksum);
+        reader->out_pos += take;
+        bytes += take;
+        length -= take;
+    }
+    return 1;
+}
+
+static int readerGetText(BackupReader *reader, char **buffer, uint32_t *capacity) {
+    uint32_t length;
+    if (!readerGet(reader, &length, sizeof(length))) {
+        return 0;
+    }
+    if (length + 1 > *capacity) {
+        *capacity = length + 1;
+        *buffer = realloc(*buffer, *capacity);
+    }
+    if (!readerGet(reader, *buffer, length)) {
+        return 0;
+    }
+    (*buffer)[length] = '\0';
+    return 1;
+}
+
+static int readBackupHeader(FILE *file, BackupHeader *header) {
+    return fread(header, sizeof(*header), 1, file) == 1 &&
+           memcmp(header->magic, BACKUP_MAGIC, sizeof(header->magic)) == 0 &&
+           header->version == BACKUP_VERSION &&
+           header->header_checksum == computeChecksum(header, offsetof(BackupHeader, header_checksum), 0);
+}
+
+// Replay one backup file into the target database
+static int applyBackupFile(sqlite3 *db, const char *path, int64_t expected_base, int64_t *records) {
+    BackupHeader header;
+    BackupReader *reader = calloc(1, sizeof(BackupReader));
+    reader->file = fopen(path, "rb");
+    if (reader->file == NULL || !readBackupHeader(reader->file, &header) ||
+        header.base_sequence != expected_base || inflateInit(&reader->stream) != Z_OK) {
+        printf("Error: %s is missing or is not part of backup chain %lld.\n", path, (long long)expected_base);
+        if (reader->file) {
+            fclose(reader->file);
+        }
+        free(reader);
+        return 0;
+    }
+
+    sqlite3_stmt *inserts[BACKUP_TABLE_COUNT] = {0};
+    char *text = NULL;
+    uint32_t text_capacity = 0;
+    int ok = 1;
+
+    while (ok) {
+        uint8_t type, table, columns;
+        if (!readerGet(reader, &type, 1)) {
+            ok = 0;
+            break;
+        }
+        if (type == RECORD_END) {
+            break;
+        }
+        if (type == RECORD_SCHEMA) {
+            ok = readerGetText(reader, &text, &text_capacity) && sqlite3_exec(db, text, 0, 0, NULL) == SQLITE_OK;
+            continue;
+        }
+        if (!readerGet(reader, &table, 1) || table >= BACKUP_TABLE_COUNT) {
+            ok = 0;
+            break;
+        }
+
+        char sql[512];
+        if (type == RECORD_CLEAR) {
+            snprintf(sql, sizeof(sql), "DELETE FROM %s;", backup_tables[table].name);
+            ok = sqlite3_exec(db, sql, 0, 0, NULL) == SQLITE_OK;
+        } else if (type == RECORD_DELETE) {
+            int64_t row_id;
+            snprintf(sql, sizeof(sql), "DELETE FROM %s WHERE id = %lld;", backup_tables[table].name,
+                     readerGet(reader, &row_id, sizeof(row_id)) ? (long long)row_id : -1LL);
+            ok = sqlite3_exec(db, sql, 0, 0, NULL) == SQLITE_OK;
+            (*records)++;
+        } else if (type == RECORD_ROW && readerGet(reader, &columns, 1) && columns > 0 && columns <= 64) {
+            if (inserts[table] == NULL) {
+                size_t length = snprintf(sql, sizeof(sql), "INSERT OR REPLACE INTO %s VALUES (?", backup_tables[table].name);
+                for (int i = 1; i < columns; i++) {
+                    length += snprintf(sql + length, sizeof(sql) - length, ", ?");
+                }
+                snprintf(sql + length, sizeof(sql) - length, ");");
+                if (sqlite3_prepare_v2(db, sql, -1, &inserts[table], NULL) != SQLITE_OK) {
+                    ok = 0;
+                    break;
+                }
+            }
+            sqlite3_stmt *stmt = inserts[table];
+            for (int i = 0; ok && i < columns; i++) {
+                uint8_t tag;
+                int64_t integer;
+                double real;
+                ok = readerGet(reader, &tag, 1);
+                if (!ok || tag == VALUE_NULL) {
+                    sqlite3_bind_null(stmt, i + 1);
+                } else if (tag == VALUE_INTEGER && (ok = readerGet(reader, &integer, sizeof(integer)))) {
+                    sqlite3_bind_int64(stmt, i + 1, integer);
+                } else if (tag == VALUE_REAL && (ok = readerGet(reader, &real, sizeof(real)))) {
+                    sqlite3_bind_double(stmt, i + 1, real);
+                } else if (tag == VALUE_TEXT && (ok = readerGetText(reader, &text, &text_capacity))) {
+                    sqlite3_bind_text(stmt, i + 1, text, -1, SQLITE_TRANSIENT);
+                } else {
+                    ok = 0;
+                }
+            }
+            ok = ok && sqlite3_step(stmt) == SQLITE_DONE;
+            sqlite3_reset(stmt);
+            (*records)++;
+        } else {
+            ok = 0;
+        }
+    }
+
+    if (ok && reader->checksum != header.raw_checksum) {
+        ok = 0;
+    }
+    if (!ok) {
+        printf("Error: %s is corrupt or could not be applied: %s\n", path, sqlite3_errmsg(db));
+    }
+    for (int i = 0; i < BACKUP_TABLE_COUNT; i++) {
+        sqlite3_finalize(inserts[i]);
+    }
+    free(text);
+    inflateEnd(&reader->stream);
+    fclose(reader->file);
+    free(reader);
+    return ok;
+}
+
+// Path of another file in the same chain: the six digits before ".flb" hold the sequence
+static int chainPath(const char *path, int64_t sequence, char *out, size_t size) {
+    size_t length = strlen(path);
+    if (length < 10 || strcmp(path + length - 4, ".flb") != 0 || length >= size) {
+        return 0;
+    }
+    memcpy(out, path, length + 1);
+    char digits[8];
+    snprintf(digits, sizeof(digits), "%06lld", (long long)sequence);
+    memcpy(out + length - 10, digits, 6);
+    return 1;
+}
+
+// Function to rebuild a ledger from a backup: its base plus every increment up to it.
+// The target must not exist yet.
+int restoreBackup(const char *backup_path, const char *target_path) {
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    BackupHeader header;
+    FILE *file = fopen(backup_path, "rb");
+    int valid = file != NULL && readBackupHeader(file, &header);
+    if (file) {
+        fclose(file);
+    }
+    if (!valid) {
+        printf("Error: %s is not a Finance Lite backup.\n", backup_path);
+        return 0;
+    }
+    if (access(target_path, F_OK) == 0) {
+        printf("Error: %s already exists. Restore into a new file.\n", target_path);
+        return 0;
+    }
+
+    sqlite3 *db;
+    if (sqlite3_open(target_path, &db) != SQLITE_OK) {
+        printf("Error: Cannot open database: %s\n", sqlite3_errmsg(db));
+        sqlite3_close(db);
+        return 0;
+    }
+
+    int ok = sqlite3_exec(db, "BEGIN;", 0, 0, NULL) == SQLITE_OK;
+    int64_t records = 0;
+    for (int64_t sequence = header.base_sequence; ok && sequence <= header.sequence; sequence++) {
+        char path[1024];
+        ok = chainPath(backup_path, sequence, path, sizeof(path)) &&
+             applyBackupFile(db, path, header.base_sequence, &records);
+    }
+    ok = ok && sqlite3_exec(db, "COMMIT;", 0, 0, NULL) == SQLITE_OK;
+    sqlite3_close(db);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if (!ok) {
+        remove(target_path);
+        printf("Error: Restore failed; %s was not created.\n", target_path);
+        return 0;
+    }
+    printf("Restored %s from backups %lld-%lld: %lld records in %.2f ms.\n", target_path,
+           (long long)header.base_sequence, (long long)header.sequence, (long long)records,
+           (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1e6);
+    return 1;
+}
+
+// Function to prompt for a backup file and a new ledger to restore it into
+void restoreBackupPrompt(void) {
+    char backup_path[INPUT_LINE_MAX];
+    char target_path[INPUT_LINE_MAX];
+
+    printf("Enter backup file to restore (e.g. %s/finance_lite_000001.flb): ", BACKUP_DIR);
+    getValidStringInput(backup_path, sizeof(backup_path));
+    printf("Enter new database file to restore into: ");
+    getValidStringInput(target_path, sizeof(target_path));
+    restoreBackup(backup_path, target_path);
+}
+
+// State of the one online backup that may run at a time
+static pthread_mutex_t online_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_t online_thread;
+static int online_running = 0;       // Thread started and not yet joined
+static int online_done = 0;          // Thread has finished copying (or failed)
+static int online_ok = 0;
+static int online_pages_per_step = ONLINE_BACKUP_DEFAULT_PAGES;
+static int online_total_pages = 0;
+static int online_remaining_pages = 0;
+static sqlite3 *online_source = NULL;
+static char online_path[1024];
+
+// Background thread: copy the ledger a few pages at a time through the SQLite backup API.
+// It shares the app's connection, so the app's own writes are folded into the copy as they
+// happen instead of forcing a restart; between steps the connection is free for the app.
+static void *onlineBackupThread(void *arg) {
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    char tmp_path[1100];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", online_path);
+    remove(tmp_path);
+
+    sqlite3 *dest;
+    sqlite3_backup *backup = NULL;
+    int rc = sqlite3_open(tmp_path, &dest);
+    if (rc == SQLITE_OK) {
+        backup = sqlite3_backup_init(dest, "main", online_source, "main");
+    }
+    if (backup == NULL) {
+        printf("\nError: Online backup could not start: %s\n", sqlite3_errmsg(dest));
+        sqlite3_close(dest);
+        pthread_mutex_lock(&online_lock);
+        online_done = 1;
+        pthread_mutex_unlock(&online_lock);
+        return NULL;
+    }
+
+    int next_report = 10;   // Print progress every 10%
+    do {
+        rc = sqlite3_backup_step(backup, online_pages_per_step);
+
+        pthread_mutex_lock(&online_lock);
+        online_total_pages = sqlite3_backup_pagecount(backup);
+        online_remaining_pages = sqlite3_backup_remaining(backup);
+        pthread_mutex_unlock(&online_lock);
+
+        int percent = online_total_pages ? (online_total_pages - online_remaining_pages) * 100 / online_total_pages : 100;
+        if (percent >= next_report && rc != SQLITE_DONE) {
+            printf("\n[Online backup] %d%% (%d/%d pages)\n", percent,
+                   online_total_pages - online_remaining_pages, online_total_pages);
+            fflush(stdout);
+            next_report = percent / 10 * 10 + 10;
+        }
+        if (rc == SQLITE_OK || rc == SQLITE_BUSY || rc == SQLITE_LOCKED) {
+            struct timespec pause = {0, ONLINE_BACKUP_PAUSE_MS * 1000000L};
+            nanosleep(&pause, NULL);
+        }
+    } while (rc == SQLITE_OK || rc == SQLITE_BUSY || rc == SQLITE_LOCKED);
+
+    sqlite3_backup_finish(backup);
+    int copied = (rc == SQLITE_DONE && sqlite3_errcode(dest) == SQLITE_OK);
+    sqlite3_close(dest);
+    // link() fails instead of replacing a file that appeared at the destination meanwhile
+    int ok = copied && link(tmp_path, online_path) == 0;
+    remove(tmp_path);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if (ok) {
+        printf("\n[Online backup] Done: %d pages copied to %s in %.2f ms.\n", online_total_pages, online_path,
+               (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1e6);
+    } else {
+        printf("\n[Online backup] Failed: %s\n", copied ? "destination already exists" : sqlite3_errstr(rc));
+    }
+    fflush(stdout);
+
+    pthread_mutex_lock(&online_lock);
+    online_ok = ok;
+    online_done = 1;
+    pthread_mutex_unlock(&online_lock);
+    return NULL;
+}
+
+// Function to start copying the ledger to dest_path in the background. Returns 0 if a copy
+// is already running or the thread could not be started.
+int startOnlineBackup(sqlite3 *db, const char *dest_path, int pages_per_step) {
+    pthread_mutex_lock(&online_lock);
+    if (online_running && !online_done) {
+        pthread_mutex_unlock(&online_lock);
+        printf("Error: An online backup is already running.\n");
+        return 0;
+    }
+    pthread_mutex_unlock(&online_lock);
+    finishOnlineBackup();   // Reap the previous, finished copy
+
+    if (!sqlite3_threadsafe()) {
+        printf("Error: This SQLite build is not thread-safe; online backup is unavailable.\n");
+        return 0;
+    }
+    if (access(dest_path, F_OK) == 0) {
+        printf("Error: %s already exists. Back up into a new file.\n", dest_path);
+        return 0;
+    }
+
+    online_source = db;
+    online_pages_per_step = pages_per_step > 0 ? pages_per_step : ONLINE_BACKUP_DEFAULT_PAGES;
+    online_total_pages = 0;
+    online_remaining_pages = 0;
+    online_done = 0;
+    online_ok = 0;
+    snprintf(online_path, sizeof(online_path), "%s", dest_path);
+
+    if (pthread_create(&online_thread, NULL, onlineBackupThread, NULL) != 0) {
+        printf("Error: Could not start the online backup thread.\n");
+        return 0;
+    }
+    online_running = 1;
+    static int exit_hook_registered = 0;
+    if (!exit_hook_registered) {
+        atexit(finishOnlineBackup);   // Leaving at end of input still waits for the copy
+        exit_hook_registered = 1;
+    }
+    printf("Online backup to %s started (%d pages per step).\n", online_path, online_pages_per_step);
+    return 1;
+}
+
+// Function to prompt for a destination and step size, then start an online backup
+void startOnlineBackupPrompt(sqlite3 *db) {
+    char dest_path[INPUT_LINE_MAX];
+    char pages[32];
+    int pages_per_step = ONLINE_BACKUP_DEFAULT_PAGES;
+
+    printf("Enter destination database file: ");
+    getValidStringInput(dest_path, sizeof(dest_path));
+    printf("Pages per step (blank for %d): ", ONLINE_BACKUP_DEFAULT_PAGES);
+    if (getOptionalStringInput(pages, sizeof(pages)) > 0 && !parseIntToken(pages, &pages_per_step)) {
+        pages_per_step = ONLINE_BACKUP_DEFAULT_PAGES;
+    }
+    startOnlineBackup(db, dest_path, pages_per_step);
+}
+
+// Function to report the progress of the current or last online backup
+void showOnlineBackupStatus(void) {
+    pthread_mutex_lock(&online_lock);
+    if (!online_running) {
+        printf("No online backup has been started.\n");
+    } else if (!online_done) {
+        printf("Online backup to %s: %d/%d pages copied.\n", online_path,
+               online_total_pages - online_remaining_pages, online_total_pages);
+    } else {
+        printf("Last online backup to %s %s.\n", online_path, online_ok ? "completed" : "failed");
+    }
+    pthread_mutex_unlock(&online_lock);
+}
+
+// Function to wait for a running online backup; call before closing the ledger connection
+void finishOnlineBackup(void) {
+    if (online_running) {
+        pthread_join(online_thread, NULL);
+        online_running = 0;
+    }
+}
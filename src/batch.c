@@ -0,0 +1,173 @@
+#define _XOPEN_SOURCE 700
+#include "batch.h"
+#include "journal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <time.h>
+#include <pthread.h>
+#include <sqlite3.h>
+
+static sqlite3 *batch_db = NULL;
+static pthread_mutex_t batch_lock = PTHREAD_MUTEX_INITIALIZER;
+static int batch_max_writes = 0;      // 0 = batching disabled, every write commits on its own
+static int batch_max_ms = BATCH_DEFAULT_MAX_MS;
+static int batch_pending = 0;         // Writes in the open transaction
+static int batch_owned = 0;           // The open transaction was started by beginBatchedWrite
+static struct timespec batch_started; // When the open transaction began
+static void (*shutdown_handler)(sqlite3 *db) = NULL;
+
+static long elapsedMs(const struct timespec *since) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - since->tv_sec) * 1000L + (now.tv_nsec - since->tv_nsec) / 1000000L;
+}
+
+// Commit the open batch; caller holds batch_lock. A transaction some other code opened with its
+// own BEGIN is left alone, so only its owner ever commits it.
+static void flushBatchLocked() {
+    if (batch_owned && batch_db != NULL && !sqlite3_get_autocommit(batch_db)) {
+        char *err_msg = NULL;
+        if (sqlite3_exec(batch_db, "COMMIT;", 0, 0, &err_msg) != SQLITE_OK) {
+            printf("Error: Failed to commit batched writes: %s\n", err_msg);
+            sqlite3_free(err_msg);
+        }
+    }
+    batch_owned = 0;
+    batch_pending = 0;
+}
+
+// Dedicated thread that owns SIGINT/SIGTERM and commits batches that have waited too long
+static void *batchGuardThread(void *arg) {
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+
+    while (1) {
+        struct timespec timeout = {0, 100 * 1000000L};
+        int sig = sigtimedwait(&signals, NULL, &timeout);
+
+        if (sig == SIGINT || sig == SIGTERM) {
+            // Commit our own batch, then shut down exactly as the menu exit does. A transaction
+            // opened elsewhere, such as a half-finished import, is not committed and is rolled
+            // back by SQLite when the process exits.
+            pthread_mutex_lock(&batch_lock);
+            flushBatchLocked();
+            sqlite3 *db = batch_db;
+            int unfinished = (db != NULL && !sqlite3_get_autocommit(db));
+            pthread_mutex_unlock(&batch_lock);
+            if (shutdown_handler != NULL && db != NULL) {
+                shutdown_handler(db);
+            } else {
+                closeJournal();
+            }
+            if (unfinished) {
+                printf("\nInterrupted. The unfinished operation was discarded; earlier changes are saved.\n");
+            } else {
+                printf("\nInterrupted. Pending changes saved. Goodbye!\n");
+            }
+            exit(0);
+        }
+
+        pthread_mutex_lock(&batch_lock);
+        if (batch_pending > 0 && elapsedMs(&batch_started) >= batch_max_ms) {
+            flushBatchLocked();
+        }
+        pthread_mutex_unlock(&batch_lock);
+    }
+    return NULL;
+}
+
+// Function to set up batching and graceful shutdown; call before any other thread is started
+void initBatchMode(sqlite3 *db) {
+    batch_db = db;
+
+    // Block the shutdown signals here so every thread created afterwards inherits the mask
+    // and only the guard thread ever sees them
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, NULL);
+
+    pthread_t guard;
+    if (pthread_create(&guard, NULL, batchGuardThread, NULL) == 0) {
+        pthread_detach(guard);
+    } else {
+        pthread_sigmask(SIG_UNBLOCK, &signals, NULL);
+        printf("Warning: Unable to start batch guard thread.\n");
+    }
+    atexit(flushBatch);
+
+    // FINANCE_LITE_BATCH=writes[:milliseconds] turns batching on for scripted sessions
+    const char *setting = getenv("FINANCE_LITE_BATCH");
+    if (setting != NULL) {
+        int max_writes = BATCH_DEFAULT_MAX_WRITES, max_ms = BATCH_DEFAULT_MAX_MS;
+        sscanf(setting, "%d:%d", &max_writes, &max_ms);
+        setBatchMode(max_writes, max_ms);
+    }
+}
+
+// Function to register the session shutdown sequence the guard thread runs on SIGINT/SIGTERM
+void setShutdownHandler(void (*handler)(sqlite3 *db)) {
+    shutdown_handler = handler;
+}
+
+// Function to turn batching on (max_writes > 0) or off (max_writes <= 0, commits pending writes)
+void setBatchMode(int max_writes, int max_ms) {
+    pthread_mutex_lock(&batch_lock);
+    flushBatchLocked();
+    batch_max_writes = (max_writes > 0) ? max_writes : 0;
+    batch_max_ms = (max_ms > 0) ? max_ms : BATCH_DEFAULT_MAX_MS;
+    pthread_mutex_unlock(&batch_lock);
+
+    if (batch_max_writes) {
+        printf("Batch mode on: commit every %d writes or %d ms.\n", batch_max_writes, batch_max_ms);
+    } else {
+        printf("Batch mode off.\n");
+    }
+}
+
+int batchModeEnabled(void) {
+    return batch_max_writes > 0;
+}
+
+// Function to call before a write: opens the batch transaction when needed
+void beginBatchedWrite(void) {
+    pthread_mutex_lock(&batch_lock);
+    if (batch_max_writes && batch_db != NULL && sqlite3_get_autocommit(batch_db)) {
+        if (sqlite3_exec(batch_db, "BEGIN;", 0, 0, NULL) == SQLITE_OK) {
+            clock_gettime(CLOCK_MONOTONIC, &batch_started);
+            batch_owned = 1;
+            batch_pending = 0;
+        }
+    }
+}
+
+// Function to call after a write: commits once the batch is large enough
+void endBatchedWrite(void) {
+    if (batch_owned && batch_db != NULL && !sqlite3_get_autocommit(batch_db)) {
+        if (++batch_pending >= batch_max_writes || elapsedMs(&batch_started) >= batch_max_ms) {
+            flushBatchLocked();
+        }
+    }
+    pthread_mutex_unlock(&batch_lock);
+}
+
+// Function to commit any batched writes immediately
+void flushBatch(void) {
+    pthread_mutex_lock(&batch_lock);
+    flushBatchLocked();
+    pthread_mutex_unlock(&batch_lock);
+}
+
+// Function to commit any batched writes and detach from the connection; call before
+// sqlite3_close so the exit handlers and the guard thread never touch the closed handle
+void closeBatchMode(void) {
+    pthread_mutex_lock(&batch_lock);
+    flushBatchLocked();
+    batch_db = NULL;
+    batch_max_writes = 0;
+    pthread_mutex_unlock(&batch_lock);
+}
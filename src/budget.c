@@ -1,5 +1,7 @@
 #define _XOPEN_SOURCE 700
 #include "budget.h"
+#include "currency.h"
+#include "metrics.h"
 #include <stdio.h>
 #include <time.h>
 #include <sqlite3.h>
@@ -33,9 +35,12 @@ void calculateDailyBudget(sqlite3 *db, Budget *budget) {
     float total_income = 0;
     float total_expenses = 0;
     float total_savings_today = 0;
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
 
     // Fetch total income (recurring + one-time)
-    const char *income_sql = "SELECT IFNULL(SUM(amount), 0) FROM income;";
+    const char *income_sql = "SELECT (SELECT IFNULL(SUM(to_base(amount, currency, date)), 0) FROM income) + "
+                             "(SELECT IFNULL(SUM(income_total), 0) FROM archives);";
     sqlite3_stmt *stmt;
     if (sqlite3_prepare_v2(db, income_sql, -1, &stmt, NULL) == SQLITE_OK) {
         if (sqlite3_step(stmt) == SQLITE_ROW) {
@@ -54,7 +59,8 @@ void calculateDailyBudget(sqlite3 *db, Budget *budget) {
     sqlite3_finalize(stmt);
 
     // Fetch total expenses (recurring + one-time)
-    const char *expense_sql = "SELECT IFNULL(SUM(amount), 0) FROM expenses;";
+    const char *expense_sql = "SELECT (SELECT IFNULL(SUM(to_base(amount, currency, date)), 0) FROM expenses) + "
+                              "(SELECT IFNULL(SUM(expense_total), 0) FROM archives);";
     if (sqlite3_prepare_v2(db, expense_sql, -1, &stmt, NULL) == SQLITE_OK) {
         if (sqlite3_step(stmt) == SQLITE_ROW) {
             total_expenses = sqlite3_column_double(stmt, 0);
@@ -117,14 +123,19 @@ void calculateDailyBudget(sqlite3 *db, Budget *budget) {
     printf("Total Expenses: $%.2f\n", total_expenses);
     printf("Total Savings Needed for Today: $%.2f\n", total_savings_today);
     printf("Daily Budget (after savings): $%.2f\n", daily_budget);
+    reportMissingRates();
+    metricsObserveReport(METRIC_REPORT_DAILY_BUDGET, &start);
 }
 
 // Function to show analytics
 void showAnalytics(sqlite3 *db) {
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
     printf("\n=== Budget Analytics ===\n");
 
-    // 1. Calculate Total Income
-    const char *income_sql = "SELECT SUM(amount) FROM income;";
+    // 1. Calculate Total Income (archived years come from their summary rows)
+    const char *income_sql = "SELECT (SELECT IFNULL(SUM(to_base(amount, currency, date)), 0) FROM income) + "
+                             "(SELECT IFNULL(SUM(income_total), 0) FROM archives);";
     sqlite3_stmt *stmt;
     sqlite3_prepare_v2(db, income_sql, -1, &stmt, NULL);
     float total_income = 0;
@@ -135,7 +146,8 @@ void showAnalytics(sqlite3 *db) {
     printf("Total Monthly Income: $%.2f\n", total_income);
 
     // 2. Calculate Total Expenses
-    const char *expense_sql = "SELECT SUM(amount) FROM expenses;";
+    const char *expense_sql = "SELECT (SELECT IFNULL(SUM(to_base(amount, currency, date)), 0) FROM expenses) + "
+                              "(SELECT IFNULL(SUM(expense_total), 0) FROM archives);";
     sqlite3_prepare_v2(db, expense_sql, -1, &stmt, NULL);
     float total_expenses = 0;
     if (sqlite3_step(stmt) == SQLITE_ROW) {
@@ -146,7 +158,10 @@ void showAnalytics(sqlite3 *db) {
 
     // 3. Breakdown of Expenses by Category
     printf("\nExpense Breakdown by Category:\n");
-    const char *category_sql = "SELECT category, SUM(amount) FROM expenses GROUP BY category ORDER BY SUM(amount) DESC;";
+    const char *category_sql = "SELECT category, SUM(amount) FROM ("
+                               "SELECT category, to_base(amount, currency, date) AS amount FROM expenses "
+                               "UNION ALL SELECT NULLIF(category, ''), total FROM archive_category_totals) "
+                               "GROUP BY category ORDER BY SUM(amount) DESC;";
     sqlite3_prepare_v2(db, category_sql, -1, &stmt, NULL);
     while (sqlite3_step(stmt) == SQLITE_ROW) {
         printf(" - %s: $%.2f\n",
@@ -191,6 +206,8 @@ void showAnalytics(sqlite3 *db) {
         printf("\n⚠ Warning: Your expenses exceed your income. Consider adjusting spending.\n");
     }
 
+    reportMissingRates();
     printf("\n=== End of Analytics ===\n");
+    metricsObserveReport(METRIC_REPORT_ANALYTICS, &start);
 }
 
@@ -0,0 +1,210 @@
+#define _XOPEN_SOURCE 700
+#include "category_limits.h"
+#include "utils.h"
+#include "currency.h"
+#include "schema.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sqlite3.h>
+
+// Running spend for one category in the tracked month
+typedef struct {
+    char name[MAX_NAME_LENGTH];
+    float limit;   // 0 when the category has no limit
+    float spent;
+    int used;
+} CategoryBucket;
+
+// Open-addressing hash table so each insert can be checked without querying expenses
+static CategoryBucket *buckets = NULL;
+static int bucket_capacity = 0;
+static int bucket_count = 0;
+static int tracked_month = -1;   // year * 12 + month - 1
+
+static int monthIndexFromDate(const char *date) {
+    int year, month;
+    if (date == NULL || sscanf(date, "%d-%d", &year, &month) != 2 || month < 1 || month > 12) {
+        return -1;
+    }
+    return year * 12 + month - 1;
+}
+
+static int currentMonthIndex(void) {
+    time_t t = time(NULL);
+    struct tm *tm_info = localtime(&t);
+    return (tm_info->tm_year + 1900) * 12 + tm_info->tm_mon;
+}
+
+// A new month started while the program was running: reset the running totals. The wall
+// clock decides, so an expense dated in a later month can't move the tracked month.
+static void rollOverMonth(void) {
+    int month = currentMonthIndex();
+    if (month > tracked_month) {
+        for (int i = 0; i < bucket_capacity; i++) {
+            buckets[i].spent = 0;
+        }
+        tracked_month = month;
+    }
+}
+
+static CategoryBucket *findBucket(const char *name, int create);
+
+static void growBuckets() {
+    CategoryBucket *old = buckets;
+    int old_capacity = bucket_capacity;
+
+    bucket_capacity = bucket_capacity ? bucket_capacity * 2 : 64;
+    buckets = calloc(bucket_capacity, sizeof(CategoryBucket));
+    bucket_count = 0;
+
+    for (int i = 0; i < old_capacity; i++) {
+        if (old[i].used) {
+            *findBucket(old[i].name, 1) = old[i];
+        }
+    }
+    free(old);
+}
+
+// Look up a category, optionally inserting an empty bucket for it
+static CategoryBucket *findBucket(const char *name, int create) {
+    if (create && (bucket_count + 1) * 10 > bucket_capacity * 7) {
+        growBuckets();
+    }
+    if (bucket_capacity == 0) {
+        return NULL;
+    }
+
+    unsigned int mask = bucket_capacity - 1;
+    for (unsigned int i = hashString(name) & mask;; i = (i + 1) & mask) {
+        if (!buckets[i].used) {
+            if (!create) {
+                return NULL;
+            }
+            memset(&buckets[i], 0, sizeof(CategoryBucket));
+            snprintf(buckets[i].name, sizeof(buckets[i].name), "%s", name);
+            buckets[i].used = 1;
+            bucket_count++;
+            return &buckets[i];
+        }
+        if (strncmp(buckets[i].name, name, MAX_NAME_LENGTH - 1) == 0) {
+            return &buckets[i];
+        }
+    }
+}
+
+static LimitStatus bucketStatus(const CategoryBucket *bucket) {
+    if (bucket == NULL || bucket->limit <= 0) {
+        return LIMIT_NONE;
+    }
+    if (bucket->spent > bucket->limit) {
+        return LIMIT_OVER;
+    }
+    if (bucket->spent >= bucket->limit * LIMIT_NEAR_RATIO) {
+        return LIMIT_NEAR;
+    }
+    return LIMIT_UNDER;
+}
+
+// Function to load limits and this month's per-category spend into memory
+void loadCategoryLimits(sqlite3 *db) {
+    free(buckets);
+    buckets = NULL;
+    bucket_capacity = 0;
+    bucket_count = 0;
+
+    tracked_month = currentMonthIndex();
+    char month_start[24], next_month_start[24];
+    snprintf(month_start, sizeof(month_start), "%04d-%02d-01", tracked_month / 12, tracked_month % 12 + 1);
+    snprintf(next_month_start, sizeof(next_month_start), "%04d-%02d-01", (tracked_month + 1) / 12,
+             (tracked_month + 1) % 12 + 1);
+
+    sqlite3_stmt *stmt;
+    const char *limits_sql = "SELECT category, monthly_limit FROM category_limits;";
+    if (sqlite3_prepare_v2(db, limits_sql, -1, &stmt, NULL) == SQLITE_OK) {
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            CategoryBucket *bucket = findBucket((const char *)sqlite3_column_text(stmt, 0), 1);
+            bucket->limit = sqlite3_column_double(stmt, 1);
+        }
+    }
+    sqlite3_finalize(stmt);
+
+    const char *spend_sql = "SELECT category, SUM(to_base(amount, currency, date)) FROM expenses "
+                            "WHERE date >= ? AND date < ? GROUP BY category;";
+    if (sqlite3_prepare_v2(db, spend_sql, -1, &stmt, NULL) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, month_start, -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 2, next_month_start, -1, SQLITE_STATIC);
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            const char *category = (const char *)sqlite3_column_text(stmt, 0);
+            if (category != NULL) {
+                findBucket(category, 1)->spent = sqlite3_column_double(stmt, 1);
+            }
+        }
+    }
+    sqlite3_finalize(stmt);
+    reportMissingRates();   // Spending without a rate doesn't count toward the limits
+}
+
+// Function to add an expense to the running totals and report where its category stands
+LimitStatus recordCategorySpend(const char *category, float amount, const char *date) {
+    rollOverMonth();
+    if (category == NULL || monthIndexFromDate(date) != tracked_month) {
+        return bucketStatus(category ? findBucket(category, 0) : NULL);   // Back- and future-dated expenses don't count towards this month
+    }
+
+    CategoryBucket *bucket = findBucket(category, 1);
+    bucket->spent += amount;
+    return bucketStatus(bucket);
+}
+
+// Function to set or update the monthly limit for a category
+void setCategoryLimit(sqlite3 *db) {
+    char category[MAX_NAME_LENGTH];
+    float limit;
+
+    printf("Enter expense category: ");
+    getValidStringInput(category, MAX_NAME_LENGTH);
+
+    printf("Enter monthly limit: $");
+    limit = getValidFloatInput();
+
+    CategoryLimitRow row = { .category = category, .monthly_limit = limit };
+    sqlite3_stmt *stmt;
+
+    if (sqlite3_prepare_v2(db, SCHEMA_UPSERT_SQL(SCHEMA_CATEGORY_LIMITS) ";", -1, &stmt, NULL) == SQLITE_OK) {
+        schemaBind_category_limits(stmt, &row);
+        if (sqlite3_step(stmt) == SQLITE_DONE) {
+            findBucket(category, 1)->limit = limit;
+            printf("Limit set: %s - $%.2f per month\n", category, limit);
+        } else {
+            printf("Error: Failed to set category limit: %s\n", sqlite3_errmsg(db));
+        }
+    }
+    sqlite3_finalize(stmt);
+}
+
+static void printLimitGroup(const char *title, LimitStatus status) {
+    int found = 0;
+
+    printf("\n%s:\n", title);
+    for (int i = 0; i < bucket_capacity; i++) {
+        if (buckets[i].used && bucketStatus(&buckets[i]) == status) {
+            printf(" - %s: $%.2f / $%.2f (%.2f%%)\n", buckets[i].name, buckets[i].spent,
+                   buckets[i].limit, buckets[i].spent / buckets[i].limit * 100);
+            found = 1;
+        }
+    }
+    if (!found) {
+        printf(" (none)\n");
+    }
+}
+
+// Function to list categories over, near and under their monthly limit
+void showCategoryLimitReport(void) {
+    rollOverMonth();
+    printf("\n=== Category Limits (%04d-%02d) ===\n", tracked_month / 12, tracked_month % 12 + 1);
+    printLimitGroup("Over Limit", LIMIT_OVER);
+    printLimitGroup("Near Limit", LIMIT_NEAR);
+    printLimitGroup("Under Limit", LIMIT_UNDER);
+}
@@ -0,0 +1,566 @@
+#define _XOPEN_SOURCE 700
+#include "consolidate.h"
+#include "currency.h"
+#include "utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sqlite3.h>
+#include <cjson/cJSON.h>
+
+typedef enum {
+    TASK_INCOME,
+    TASK_EXPENSES,
+    TASK_DETAILS      // Recurring entries and savings goals; one per ledger
+} TaskKind;
+
+// A slice of work: one ledger, one table, one row id range
+typedef struct {
+    int ledger;
+    TaskKind kind;
+    sqlite3_int64 first_id;
+    sqlite3_int64 last_id;
+} ConsolidateTask;
+
+typedef struct {
+    char name[MAX_NAME_LENGTH];
+    double total;
+    int used;
+} CategoryTotal;
+
+// Per-category totals in an open-addressing table; memory grows with categories, not rows
+typedef struct {
+    CategoryTotal *slots;
+    int capacity;
+    int count;
+} CategoryTable;
+
+typedef struct {
+    char type[16];
+    char description[MAX_NAME_LENGTH];
+    double amount;
+} RecurringItem;
+
+typedef struct {
+    char name[MAX_NAME_LENGTH];
+    double target_amount;
+    double saved_amount;
+} GoalItem;
+
+// Everything gathered from one ledger. Totals are summed by the workers after joining;
+// the detail lists are written only by that ledger's TASK_DETAILS task.
+typedef struct {
+    const char *path;
+    int ok;
+    int has_currency;               // 0 for a ledger from before currencies: every row is in its base
+    char currency[CURRENCY_CODE_SIZE];   // The ledger's base currency
+    double income;
+    double expenses;
+    double recurring_expenses;
+    RecurringItem *recurring;
+    int recurring_count;
+    GoalItem *goals;
+    int goal_count;
+} LedgerResult;
+
+typedef struct {
+    const ConsolidateTask *tasks;
+    int task_count;
+    int *next_task;                 // Shared work queue position
+    pthread_mutex_t *queue_lock;
+    LedgerResult *ledgers;
+    int ledger_count;
+    CategoryTable categories;       // This worker's partial totals
+    double *ledger_income;          // [ledger_count]
+    double *ledger_expenses;
+    long long rows;
+    int started;
+} ConsolidateWorker;
+
+static void addCategoryTotal(CategoryTable *table, const char *name, double amount);
+
+static void growCategoryTable(CategoryTable *table) {
+    CategoryTotal *old = table->slots;
+    int old_capacity = table->capacity;
+
+    table->capacity = table->capacity ? table->capacity * 2 : 64;
+    table->slots = calloc(table->capacity, sizeof(CategoryTotal));
+    table->count = 0;
+    for (int i = 0; i < old_capacity; i++) {
+        if (old[i].used) {
+            addCategoryTotal(table, old[i].name, old[i].total);
+        }
+    }
+    free(old);
+}
+
+static void addCategoryTotal(CategoryTable *table, const char *name, double amount) {
+    if ((table->count + 1) * 10 > table->capacity * 7) {
+        growCategoryTable(table);
+    }
+    unsigned int mask = table->capacity - 1;
+    for (unsigned int i = hashString(name) & mask;; i = (i + 1) & mask) {
+        CategoryTotal *slot = &table->slots[i];
+        if (!slot->used) {
+            snprintf(slot->name, sizeof(slot->name), "%s", name);
+            slot->used = 1;
+            slot->total = amount;
+            table->count++;
+            return;
+        }
+        if (strncmp(slot->name, name, MAX_NAME_LENGTH - 1) == 0) {
+            slot->total += amount;
+            return;
+        }
+    }
+}
+
+// Open a ledger read-only with to_base() converting with its own rates into its base currency
+static sqlite3 *openLedger(const char *path, char *base) {
+    sqlite3 *db = NULL;
+    if (sqlite3_open_v2(path, &db, SQLITE_OPEN_READONLY, NULL) != SQLITE_OK ||
+        !registerLedgerCurrencyFunctions(db, base)) {
+        sqlite3_close(db);
+        return NULL;
+    }
+    sqlite3_busy_timeout(db, 5000);
+    return db;
+}
+
+static int hasCurrencyColumns(sqlite3 *db) {
+    sqlite3_stmt *stmt;
+    int columns = 0;
+    const char *sql = "SELECT (SELECT COUNT(*) FROM pragma_table_info('income') WHERE name = 'currency') + "
+                      "(SELECT COUNT(*) FROM pragma_table_info('expenses') WHERE name = 'currency');";
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) == SQLITE_OK && sqlite3_step(stmt) == SQLITE_ROW) {
+        columns = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    return columns == 2;
+}
+
+static void loadLedgerDetails(sqlite3 *db, LedgerResult *ledger) {
+    sqlite3_stmt *stmt;
+
+    const char *recurring_sql = "SELECT type, description, amount FROM recurring ORDER BY id;";
+    if (sqlite3_prepare_v2(db, recurring_sql, -1, &stmt, NULL) == SQLITE_OK) {
+        int capacity = 0;
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            if (ledger->recurring_count == capacity) {
+                capacity = capacity ? capacity * 2 : 16;
+                ledger->recurring = realloc(ledger->recurring, capacity * sizeof(RecurringItem));
+            }
+            RecurringItem *item = &ledger->recurring[ledger->recurring_count++];
+            snprintf(item->type, sizeof(item->type), "%s", (const char *)sqlite3_column_text(stmt, 0));
+            snprintf(item->description, sizeof(item->description), "%s", (const char *)sqlite3_column_text(stmt, 1));
+            item->amount = sqlite3_column_double(stmt, 2);
+            if (strcmp(item->type, "expense") == 0) {
+                ledger->recurring_expenses += item->amount;
+            }
+        }
+    }
+    sqlite3_finalize(stmt);
+
+    const char *goals_sql = "SELECT name, target_amount, saved_amount FROM savings_goals ORDER BY id;";
+    if (sqlite3_prepare_v2(db, goals_sql, -1, &stmt, NULL) == SQLITE_OK) {
+        int capacity = 0;
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            if (ledger->goal_count == capacity) {
+                capacity = capacity ? capacity * 2 : 16;
+                ledger->goals = realloc(ledger->goals, capacity * sizeof(GoalItem));
+            }
+            GoalItem *goal = &ledger->goals[ledger->goal_count++];
+            const unsigned char *name = sqlite3_column_text(stmt, 0);
+            snprintf(goal->name, sizeof(goal->name), "%s", name ? (const char *)name : "");
+            goal->target_amount = sqlite3_column_double(stmt, 1);
+            goal->saved_amount = sqlite3_column_double(stmt, 2);
+        }
+    }
+    sqlite3_finalize(stmt);
+}
+
+// Add the summaries of the ledger's archived years, as Show Analytics does. A ledger from
+// before archiving existed has no archives table and nothing to add.
+static void addArchiveSummaries(sqlite3 *db, ConsolidateWorker *worker, int ledger) {
+    sqlite3_stmt *stmt;
+
+    if (sqlite3_prepare_v2(db, "SELECT IFNULL(SUM(income_total), 0) FROM archives;", -1, &stmt, NULL) == SQLITE_OK &&
+        sqlite3_step(stmt) == SQLITE_ROW) {
+        worker->ledger_income[ledger] += sqlite3_column_double(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+
+    if (sqlite3_prepare_v2(db, "SELECT category, total FROM archive_category_totals;", -1, &stmt, NULL) == SQLITE_OK) {
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            const unsigned char *category = sqlite3_column_text(stmt, 0);
+            double amount = sqlite3_column_double(stmt, 1);
+            addCategoryTotal(&worker->categories, category && category[0] ? (const char *)category : "(none)", amount);
+            worker->ledger_expenses[ledger] += amount;
+        }
+    }
+    sqlite3_finalize(stmt);
+}
+
+// Worker thread: pull tasks until the queue is empty, each on this worker's own connection
+static void *consolidateWorker(void *arg) {
+    ConsolidateWorker *worker = arg;
+    sqlite3 **connections = calloc(worker->ledger_count, sizeof(sqlite3 *));
+
+    // Amounts are converted to the ledger's base currency; rows with no rate are left out
+    const char *income_sql = "SELECT IFNULL(SUM(to_base(amount, currency, date)), 0), COUNT(*) FROM income "
+                             "WHERE id BETWEEN ? AND ?;";
+    const char *expense_sql = "SELECT category, IFNULL(SUM(to_base(amount, currency, date)), 0), COUNT(*) FROM expenses "
+                              "WHERE id BETWEEN ? AND ? GROUP BY category;";
+    const char *base_income_sql = "SELECT IFNULL(SUM(amount), 0), COUNT(*) FROM income WHERE id BETWEEN ? AND ?;";
+    const char *base_expense_sql = "SELECT category, SUM(amount), COUNT(*) FROM expenses "
+                                   "WHERE id BETWEEN ? AND ? GROUP BY category;";
+
+    while (1) {
+        pthread_mutex_lock(worker->queue_lock);
+        int index = (*worker->next_task)++;
+        pthread_mutex_unlock(worker->queue_lock);
+        if (index >= worker->task_count) {
+            break;
+        }
+
+        const ConsolidateTask *task = &worker->tasks[index];
+        LedgerResult *ledger = &worker->ledgers[task->ledger];
+        if (connections[task->ledger] == NULL) {
+            char base[CURRENCY_CODE_SIZE];
+            connections[task->ledger] = openLedger(ledger->path, base);
+        }
+        sqlite3 *db = connections[task->ledger];
+        if (db == NULL) {
+            continue;
+        }
+
+        if (task->kind == TASK_DETAILS) {
+            loadLedgerDetails(db, ledger);
+            addArchiveSummaries(db, worker, task->ledger);
+            continue;
+        }
+
+        sqlite3_stmt *stmt;
+        const char *sql = task->kind == TASK_INCOME ? (ledger->has_currency ? income_sql : base_income_sql)
+                                                    : (ledger->has_currency ? expense_sql : base_expense_sql);
+        if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+            continue;
+        }
+        sqlite3_bind_int64(stmt, 1, task->first_id);
+        sqlite3_bind_int64(stmt, 2, task->last_id);
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            if (task->kind == TASK_INCOME) {
+                worker->ledger_income[task->ledger] += sqlite3_column_double(stmt, 0);
+                worker->rows += sqlite3_column_int64(stmt, 1);
+            } else {
+                const unsigned char *category = sqlite3_column_text(stmt, 0);
+                double amount = sqlite3_column_double(stmt, 1);
+                addCategoryTotal(&worker->categories, category ? (const char *)category : "(none)", amount);
+                worker->ledger_expenses[task->ledger] += amount;
+                worker->rows += sqlite3_column_int64(stmt, 2);
+            }
+        }
+        sqlite3_finalize(stmt);
+    }
+
+    for (int i = 0; i < worker->ledger_count; i++) {
+        sqlite3_close(connections[i]);
+    }
+    free(connections);
+    return NULL;
+}
+
+// Read the id range of a table so it can be cut into fixed-size tasks
+static int readIdRange(sqlite3 *db, const char *sql, sqlite3_int64 *first, sqlite3_int64 *last) {
+    sqlite3_stmt *stmt;
+    int ok = 0;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) == SQLITE_OK && sqlite3_step(stmt) == SQLITE_ROW) {
+        *first = sqlite3_column_int64(stmt, 0);
+        *last = sqlite3_column_int64(stmt, 1);
+        ok = 1;
+    }
+    sqlite3_finalize(stmt);
+    return ok;
+}
+
+static void addRangeTasks(ConsolidateTask **tasks, int *count, int *capacity, int ledger, TaskKind kind,
+                          sqlite3_int64 first, sqlite3_int64 last) {
+    for (sqlite3_int64 lo = first; lo <= last; lo += CONSOLIDATE_CHUNK_ROWS) {
+        if (*count == *capacity) {
+            *capacity = *capacity ? *capacity * 2 : 64;
+            *tasks = realloc(*tasks, *capacity * sizeof(ConsolidateTask));
+        }
+        ConsolidateTask *task = &(*tasks)[(*count)++];
+        task->ledger = ledger;
+        task->kind = kind;
+        task->first_id = lo;
+        task->last_id = lo + CONSOLIDATE_CHUNK_ROWS - 1;
+    }
+}
+
+static int compareCategoryTotals(const void *a, const void *b) {
+    double diff = ((const CategoryTotal *)b)->total - ((const CategoryTotal *)a)->total;
+    return (diff > 0) - (diff < 0);
+}
+
+static void writeConsolidatedJSON(const char *json_path, const LedgerResult *ledgers, int count,
+                                  const CategoryTotal *categories, int category_count, double total_income,
+                                  const char *currency) {
+    cJSON *json_budget = cJSON_CreateObject();
+    cJSON_AddStringToObject(json_budget, "currency", currency != NULL ? currency : baseCurrency());
+
+    cJSON *json_ledgers = cJSON_CreateArray();
+    for (int i = 0; i < count; i++) {
+        if (!ledgers[i].ok) {
+            continue;
+        }
+        cJSON *ledger = cJSON_CreateObject();
+        cJSON_AddStringToObject(ledger, "file", ledgers[i].path);
+        cJSON_AddNumberToObject(ledger, "income", ledgers[i].income);
+        cJSON_AddNumberToObject(ledger, "expenses", ledgers[i].expenses);
+        cJSON_AddNumberToObject(ledger, "recurring_expenses", ledgers[i].recurring_expenses);
+        cJSON_AddItemToArray(json_ledgers, ledger);
+    }
+    cJSON_AddItemToObject(json_budget, "ledgers", json_ledgers);
+    cJSON_AddNumberToObject(json_budget, "income", total_income);
+
+    // Expenses are exported per category rather than per row to keep the export bounded
+    cJSON *json_expenses = cJSON_CreateArray();
+    for (int i = 0; i < category_count; i++) {
+        cJSON *expense = cJSON_CreateObject();
+        cJSON_AddStringToObject(expense, "category", categories[i].name);
+        cJSON_AddNumberToObject(expense, "amount", categories[i].total);
+        cJSON_AddItemToArray(json_expenses, expense);
+    }
+    cJSON_AddItemToObject(json_budget, "expenses", json_expenses);
+
+    cJSON *json_savings = cJSON_CreateArray();
+    cJSON *json_recurring = cJSON_CreateArray();
+    for (int i = 0; i < count; i++) {
+        for (int j = 0; j < ledgers[i].goal_count; j++) {
+            cJSON *goal = cJSON_CreateObject();
+            cJSON_AddStringToObject(goal, "name", ledgers[i].goals[j].name);
+            cJSON_AddNumberToObject(goal, "target_amount", ledgers[i].goals[j].target_amount);
+            cJSON_AddNumberToObject(goal, "saved_amount", ledgers[i].goals[j].saved_amount);
+            cJSON_AddStringToObject(goal, "source", ledgers[i].path);
+            cJSON_AddItemToArray(json_savings, goal);
+        }
+        for (int j = 0; j < ledgers[i].recurring_count; j++) {
+            cJSON *entry = cJSON_CreateObject();
+            cJSON_AddStringToObject(entry, "type", ledgers[i].recurring[j].type);
+            cJSON_AddStringToObject(entry, "description", ledgers[i].recurring[j].description);
+            cJSON_AddNumberToObject(entry, "amount", ledgers[i].recurring[j].amount);
+            cJSON_AddStringToObject(entry, "source", ledgers[i].path);
+            cJSON_AddItemToArray(json_recurring, entry);
+        }
+    }
+    cJSON_AddItemToObject(json_budget, "savings_goals", json_savings);
+    cJSON_AddItemToObject(json_budget, "recurring_entries", json_recurring);
+
+    FILE *file = fopen(json_path, "w");
+    if (file) {
+        char *json_string = cJSON_Print(json_budget);
+        fprintf(file, "%s", json_string);
+        fclose(file);
+        printf("Consolidated budget exported to %s.\n", json_path);
+        free(json_string);
+    } else {
+        printf("Error: Could not save to file.\n");
+    }
+    cJSON_Delete(json_budget);
+}
+
+// Function to merge several ledger files into one analytics report and JSON export.
+// Each table is cut into row id ranges that worker threads scan in parallel, each worker
+// on its own read-only connections; only per-category totals are kept in memory.
+int consolidateLedgers(const char **paths, int count, const char *json_path) {
+    if (count < 1 || count > CONSOLIDATE_MAX_LEDGERS) {
+        printf("Error: Between 1 and %d ledger files can be consolidated.\n", CONSOLIDATE_MAX_LEDGERS);
+        return 0;
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    LedgerResult *ledgers = calloc(count, sizeof(LedgerResult));
+    ConsolidateTask *tasks = NULL;
+    int task_count = 0, task_capacity = 0;
+
+    // Plan the tasks from each ledger's id ranges. Amounts can only be added up across ledgers
+    // kept in the same base currency, the first usable ledger's.
+    const char *currency = NULL;
+    for (int i = 0; i < count; i++) {
+        ledgers[i].path = paths[i];
+        sqlite3 *db = openLedger(paths[i], ledgers[i].currency);
+        sqlite3_int64 first, last;
+
+        if (db == NULL || !readIdRange(db, "SELECT IFNULL(MIN(id), 1), IFNULL(MAX(id), 0) FROM income;", &first, &last)) {
+            printf("Error: %s is not a Finance Lite ledger.\n", paths[i]);
+            sqlite3_close(db);
+            continue;
+        }
+        if (currency != NULL && strcmp(ledgers[i].currency, currency) != 0) {
+            printf("Error: %s is kept in %s, but the other ledgers are in %s; leaving it out.\n", paths[i],
+                   ledgers[i].currency, currency);
+            sqlite3_close(db);
+            continue;
+        }
+        currency = ledgers[i].currency;
+        ledgers[i].has_currency = hasCurrencyColumns(db);
+        addRangeTasks(&tasks, &task_count, &task_capacity, i, TASK_INCOME, first, last);
+        if (readIdRange(db, "SELECT IFNULL(MIN(id), 1), IFNULL(MAX(id), 0) FROM expenses;", &first, &last)) {
+            addRangeTasks(&tasks, &task_count, &task_capacity, i, TASK_EXPENSES, first, last);
+        }
+        addRangeTasks(&tasks, &task_count, &task_capacity, i, TASK_DETAILS, 0, 0);
+        ledgers[i].ok = 1;
+        sqlite3_close(db);
+    }
+
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    int thread_count = (cores > 0) ? (int)cores : 1;
+    if (thread_count > task_count) {
+        thread_count = task_count > 0 ? task_count : 1;
+    }
+
+    pthread_mutex_t queue_lock = PTHREAD_MUTEX_INITIALIZER;
+    int next_task = 0;
+    pthread_t *threads = malloc(thread_count * sizeof(pthread_t));
+    ConsolidateWorker *workers = calloc(thread_count, sizeof(ConsolidateWorker));
+
+    for (int i = 0; i < thread_count; i++) {
+        workers[i].tasks = tasks;
+        workers[i].task_count = task_count;
+        workers[i].next_task = &next_task;
+        workers[i].queue_lock = &queue_lock;
+        workers[i].ledgers = ledgers;
+        workers[i].ledger_count = count;
+        workers[i].ledger_income = calloc(count, sizeof(double));
+        workers[i].ledger_expenses = calloc(count, sizeof(double));
+
+        workers[i].started = (pthread_create(&threads[i], NULL, consolidateWorker, &workers[i]) == 0);
+        if (!workers[i].started) {
+            consolidateWorker(&workers[i]);  // Fall back to draining the queue inline
+        }
+    }
+
+    // Merge the workers' partial totals
+    CategoryTable merged = {0};
+    long long rows = 0;
+    for (int i = 0; i < thread_count; i++) {
+        if (workers[i].started) {
+            pthread_join(threads[i], NULL);
+        }
+        for (int j = 0; j < workers[i].categories.capacity; j++) {
+            if (workers[i].categories.slots[j].used) {
+                addCategoryTotal(&merged, workers[i].categories.slots[j].name, workers[i].categories.slots[j].total);
+            }
+        }
+        for (int j = 0; j < count; j++) {
+            ledgers[j].income += workers[i].ledger_income[j];
+            ledgers[j].expenses += workers[i].ledger_expenses[j];
+        }
+        rows += workers[i].rows;
+        free(workers[i].categories.slots);
+        free(workers[i].ledger_income);
+        free(workers[i].ledger_expenses);
+    }
+    free(workers);
+    free(threads);
+    free(tasks);
+
+    // Compact and sort the categories by spend, as in showAnalytics()
+    CategoryTotal *categories = malloc((merged.count > 0 ? merged.count : 1) * sizeof(CategoryTotal));
+    int category_count = 0;
+    for (int i = 0; i < merged.capacity; i++) {
+        if (merged.slots[i].used) {
+            categories[category_count++] = merged.slots[i];
+        }
+    }
+    free(merged.slots);
+    qsort(categories, category_count, sizeof(CategoryTotal), compareCategoryTotals);
+
+    double total_income = 0, total_expenses = 0, recurring_expenses = 0;
+    int ledger_ok = 0;
+    for (int i = 0; i < count; i++) {
+        total_income += ledgers[i].income;
+        total_expenses += ledgers[i].expenses;
+        recurring_expenses += ledgers[i].recurring_expenses;
+        ledger_ok += ledgers[i].ok;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double elapsed_ms = (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1e6;
+
+    printf("\n=== Consolidated Analytics (%d ledgers) ===\n", ledger_ok);
+    if (currency != NULL) {
+        printf("Amounts in %s.\n", currency);
+    }
+    for (int i = 0; i < count; i++) {
+        if (ledgers[i].ok) {
+            printf(" - %s: Income $%.2f, Expenses $%.2f\n", ledgers[i].path, ledgers[i].income, ledgers[i].expenses);
+        }
+    }
+    printf("\nTotal Monthly Income: $%.2f\n", total_income);
+    printf("Total Expenses: $%.2f\n", total_expenses);
+
+    printf("\nExpense Breakdown by Category:\n");
+    for (int i = 0; i < category_count; i++) {
+        printf(" - %s: $%.2f\n", categories[i].name, categories[i].total);
+    }
+    printf("\nTotal Recurring Expenses: $%.2f\n", recurring_expenses);
+
+    printf("\nSavings Goals Progress:\n");
+    for (int i = 0; i < count; i++) {
+        for (int j = 0; j < ledgers[i].goal_count; j++) {
+            const GoalItem *goal = &ledgers[i].goals[j];
+            printf(" - %s (%s): $%.2f / $%.2f (%.2f%% complete)\n", goal->name, ledgers[i].path,
+                   goal->saved_amount, goal->target_amount,
+                   goal->target_amount > 0 ? goal->saved_amount / goal->target_amount * 100 : 0);
+        }
+    }
+
+    double remaining_budget = total_income - (total_expenses + recurring_expenses);
+    printf("\nRemaining Budget After Expenses: $%.2f\n", remaining_budget);
+    if (remaining_budget > 0) {
+        printf("\n✔ You have a positive balance. Consider saving or investing.\n");
+    } else {
+        printf("\n⚠ Warning: Your expenses exceed your income. Consider adjusting spending.\n");
+    }
+    reportMissingRates();
+    printf("\nScanned %lld rows in %.2f ms using %d thread(s).\n", rows, elapsed_ms, thread_count);
+    printf("\n=== End of Analytics ===\n");
+
+    if (json_path != NULL && json_path[0] != '\0') {
+        writeConsolidatedJSON(json_path, ledgers, count, categories, category_count, total_income, currency);
+    }
+
+    for (int i = 0; i < count; i++) {
+        free(ledgers[i].recurring);
+        free(ledgers[i].goals);
+    }
+    free(categories);
+    free(ledgers);
+    return ledger_ok == count;
+}
+
+// Function to prompt for ledger files and an export path, then consolidate them
+void consolidateLedgersPrompt(void) {
+    char files[INPUT_LINE_MAX];
+    char json_path[INPUT_LINE_MAX];
+    const char *paths[CONSOLIDATE_MAX_LEDGERS];
+    int count = 0;
+
+    printf("Enter ledger files to consolidate (separated by spaces): ");
+    getValidStringInput(files, sizeof(files));
+    printf("Enter JSON export file (blank to skip): ");
+    getOptionalStringInput(json_path, sizeof(json_path));
+
+    char *cursor = files;
+    char *path;
+    while ((path = nextToken(&cursor, 0)) != NULL && count < CONSOLIDATE_MAX_LEDGERS) {
+        paths[count++] = path;
+    }
+    consolidateLedgers(paths, count, json_path);
+}
@@ -0,0 +1,520 @@
+#define _XOPEN_SOURCE 700
+#include "currency.h"
+#include "batch.h"
+#include "utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sqlite3.h>
+
+static const char *currency_schema_sql =
+    "CREATE TABLE IF NOT EXISTS exchange_rates ("
+    "currency TEXT NOT NULL, "
+    "date TEXT NOT NULL, "
+    "rate REAL NOT NULL CHECK (rate > 0), "
+    "PRIMARY KEY (currency, date));"
+
+    // The base currency is fixed when the ledger is first opened: rows with a NULL currency are
+    // in it, so changing it later would re-denominate them
+    "CREATE TABLE IF NOT EXISTS ledger_currency ("
+    "id INTEGER PRIMARY KEY CHECK (id = 1), "
+    "base TEXT NOT NULL);";
+
+// Rates of one currency for every day from its first rate to its last, so a conversion is
+// an array index instead of a search or a query
+typedef struct {
+    char code[CURRENCY_CODE_SIZE];
+    int first_day;       // Days since 1970-01-01
+    int day_count;
+    double *rates;       // rates[day - first_day]
+} CurrencyRates;
+
+// The rates of a ledger other than the one initializeCurrency opened, for read-only
+// connections such as consolidation; fixed once loaded, so lookups take no lock
+typedef struct {
+    char base[CURRENCY_CODE_SIZE];
+    CurrencyRates *currencies;
+    int currency_count;
+} LedgerRates;
+
+static CurrencyRates *currencies = NULL;
+static int currency_count = 0;
+static pthread_rwlock_t rates_lock = PTHREAD_RWLOCK_INITIALIZER;
+static char base_currency[CURRENCY_CODE_SIZE] = "";
+static atomic_long missing_rates = 0;   // Conversions left out since the last report
+
+// Days since 1970-01-01 of a YYYY-MM-DD date, or -1 if it isn't one
+static int dayNumber(const char *date) {
+    if (date == NULL) {
+        return -1;
+    }
+    for (int i = 0; i < 10; i++) {
+        if ((i == 4 || i == 7) ? date[i] != '-' : (date[i] < '0' || date[i] > '9')) {
+            return -1;
+        }
+    }
+    int year = (date[0] - '0') * 1000 + (date[1] - '0') * 100 + (date[2] - '0') * 10 + (date[3] - '0');
+    int month = (date[5] - '0') * 10 + (date[6] - '0');
+    int day = (date[8] - '0') * 10 + (date[9] - '0');
+    if (year < 1970 || month < 1 || month > 12 || day < 1 || day > 31) {
+        return -1;
+    }
+
+    // Count from March so the leap day falls at the end of the year
+    year -= month <= 2;
+    int era = year / 400;
+    int year_of_era = year - era * 400;
+    int day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return era * 146097 + day_of_era - 719468;
+}
+
+static void freeRateCache(CurrencyRates *list, int count) {
+    for (int i = 0; i < count; i++) {
+        free(list[i].rates);
+    }
+    free(list);
+}
+
+// Read a ledger's exchange_rates table into a rate list
+static int loadRateList(sqlite3 *db, CurrencyRates **result, int *result_count) {
+    sqlite3_stmt *stmt;
+    CurrencyRates *list = NULL, *current = NULL;
+    int count = 0, capacity = 0, day_capacity = 0;
+
+    if (sqlite3_prepare_v2(db, "SELECT currency, date, rate FROM exchange_rates ORDER BY currency, date;", -1,
+                           &stmt, NULL) != SQLITE_OK) {
+        printf("SQLite Error: %s\n", sqlite3_errmsg(db));
+        return 0;
+    }
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        const char *code = (const char *)sqlite3_column_text(stmt, 0);
+        int day = dayNumber((const char *)sqlite3_column_text(stmt, 1));
+        double rate = sqlite3_column_double(stmt, 2);
+        if (code == NULL || day < 0) {
+            continue;
+        }
+
+        if (current == NULL || strcmp(current->code, code) != 0) {
+            if (count == capacity) {
+                capacity = capacity ? capacity * 2 : 8;
+                list = realloc(list, capacity * sizeof(CurrencyRates));
+            }
+            current = &list[count++];
+            snprintf(current->code, sizeof(current->code), "%s", code);
+            current->first_day = day;
+            current->day_count = 0;
+            current->rates = NULL;
+            day_capacity = 0;
+        }
+
+        // Carry the previous rate forward over the days without one
+        int index = day - current->first_day;
+        if (index >= day_capacity) {
+            while (index >= day_capacity) {
+                day_capacity = day_capacity ? day_capacity * 2 : 64;
+            }
+            current->rates = realloc(current->rates, day_capacity * sizeof(double));
+        }
+        for (int i = current->day_count; i < index; i++) {
+            current->rates[i] = current->rates[current->day_count - 1];
+        }
+        current->rates[index] = rate;
+        current->day_count = index + 1;
+    }
+    sqlite3_finalize(stmt);
+    *result = list;
+    *result_count = count;
+    return 1;
+}
+
+// Rebuild the in-memory rates from the exchange_rates table
+static int reloadRateCache(sqlite3 *db) {
+    CurrencyRates *list;
+    int count;
+    if (!loadRateList(db, &list, &count)) {
+        return 0;
+    }
+
+    pthread_rwlock_wrlock(&rates_lock);
+    freeRateCache(currencies, currency_count);
+    currencies = list;
+    currency_count = count;
+    pthread_rwlock_unlock(&rates_lock);
+    return 1;
+}
+
+// Rate of currency on day (-1 for no usable date: the latest rate), or 0 if it has none.
+// Days before the first rate use that first rate.
+static double lookupRate(const CurrencyRates *list, int count, const char *currency, int day) {
+    for (int i = 0; i < count; i++) {
+        if (strcmp(list[i].code, currency) == 0) {
+            int index = day < 0 ? list[i].day_count - 1 : day - list[i].first_day;
+            if (index < 0) {
+                index = 0;
+            } else if (index >= list[i].day_count) {
+                index = list[i].day_count - 1;
+            }
+            return list[i].rates[index];
+        }
+    }
+    return 0;
+}
+
+static void freeLedgerRates(void *rates) {
+    freeRateCache(((LedgerRates *)rates)->currencies, ((LedgerRates *)rates)->currency_count);
+    free(rates);
+}
+
+// SQL function to_base(amount, currency, date). NULL when there is no rate, so SUM leaves
+// the row out and the report can say so. Connections registered with
+// registerLedgerCurrencyFunctions carry their own ledger's rates as user data. Not
+// SQLITE_DETERMINISTIC: the result changes when rates are loaded.
+static void toBaseFunction(sqlite3_context *context, int argc, sqlite3_value **argv) {
+    (void)argc;
+    if (sqlite3_value_type(argv[1]) == SQLITE_NULL) {
+        sqlite3_result_value(context, argv[0]);   // Base currency: no lookup
+        return;
+    }
+
+    const LedgerRates *ledger = sqlite3_user_data(context);
+    const char *currency = (const char *)sqlite3_value_text(argv[1]);
+    int found = 1;
+    double amount = sqlite3_value_double(argv[0]);
+    if (ledger == NULL) {
+        amount = convertToBase(amount, currency, (const char *)sqlite3_value_text(argv[2]), &found);
+    } else if (currency[0] != '\0' && strcmp(currency, ledger->base) != 0) {
+        double rate = lookupRate(ledger->currencies, ledger->currency_count, currency,
+                                 dayNumber((const char *)sqlite3_value_text(argv[2])));
+        found = (rate != 0);
+        amount *= rate;
+    }
+    if (found) {
+        sqlite3_result_double(context, amount);
+    } else {
+        atomic_fetch_add(&missing_rates, 1);
+        sqlite3_result_null(context);
+    }
+}
+
+// Function to add the currency column to an income or expenses table created before it existed
+int ensureCurrencyColumn(sqlite3 *db, const char *schema, const char *table) {
+    char sql[160];
+    sqlite3_stmt *stmt;
+    int columns = 0, has_currency = 0;
+
+    snprintf(sql, sizeof(sql), "PRAGMA %s.table_info(%s);", schema, table);
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        printf("SQLite Error: %s\n", sqlite3_errmsg(db));
+        return 0;
+    }
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        columns++;
+        has_currency |= strcmp((const char *)sqlite3_column_text(stmt, 1), "currency") == 0;
+    }
+    sqlite3_finalize(stmt);
+    if (columns == 0 || has_currency) {
+        return 1;   // Not created yet, or already migrated
+    }
+
+    char *err_msg = NULL;
+    snprintf(sql, sizeof(sql), "ALTER TABLE %s.%s ADD COLUMN currency TEXT;", schema, table);
+    if (sqlite3_exec(db, sql, 0, 0, &err_msg) != SQLITE_OK) {
+        printf("Error: Failed to add currency to %s: %s\n", table, err_msg);
+        sqlite3_free(err_msg);
+        return 0;
+    }
+    return 1;
+}
+
+// Check a three-letter code and upper-case it into code; "" for blank input.
+// Returns 0 if the input is not a three-letter code.
+static int parseCurrencyCode(const char *text, char *code) {
+    char buffer[INPUT_LINE_MAX];
+    snprintf(buffer, sizeof(buffer), "%s", text);
+    char *cursor = buffer;
+    char *token = nextToken(&cursor, 0);
+
+    code[0] = '\0';
+    if (token == NULL) {
+        return 1;
+    }
+    if (nextToken(&cursor, 0) != NULL || strlen(token) != CURRENCY_CODE_SIZE - 1) {
+        return 0;
+    }
+    // ASCII only, so the result doesn't depend on the locale
+    for (int i = 0; i < CURRENCY_CODE_SIZE - 1; i++) {
+        char c = token[i];
+        if (c >= 'a' && c <= 'z') {
+            c = c - 'a' + 'A';
+        } else if (c < 'A' || c > 'Z') {
+            return 0;
+        }
+        code[i] = c;
+    }
+    code[CURRENCY_CODE_SIZE - 1] = '\0';
+    return 1;
+}
+
+// The base currency FINANCE_LITE_CURRENCY asks for, or "" when it is unset or invalid
+static void requestedBaseCurrency(char *code) {
+    const char *setting = getenv("FINANCE_LITE_CURRENCY");
+    if (setting != NULL && !parseCurrencyCode(setting, code)) {
+        printf("Error: FINANCE_LITE_CURRENCY must be a three-letter code; ignoring it.\n");
+        code[0] = '\0';
+    } else if (setting == NULL) {
+        code[0] = '\0';
+    }
+}
+
+// Read the base currency stored in a ledger into base; returns 0 if none is stored yet
+static int storedBaseCurrency(sqlite3 *db, char *base) {
+    sqlite3_stmt *stmt;
+    int found = 0;
+    if (sqlite3_prepare_v2(db, "SELECT base FROM ledger_currency WHERE id = 1;", -1, &stmt, NULL) == SQLITE_OK &&
+        sqlite3_step(stmt) == SQLITE_ROW) {
+        snprintf(base, CURRENCY_CODE_SIZE, "%s", (const char *)sqlite3_column_text(stmt, 0));
+        found = 1;
+    }
+    sqlite3_finalize(stmt);
+    return found;
+}
+
+// Function to create the rate table, migrate the ledger, load the rates and register to_base().
+// The first open stores the base currency (FINANCE_LITE_CURRENCY, else the default); later
+// opens use the stored one and refuse a FINANCE_LITE_CURRENCY that differs.
+int initializeCurrency(sqlite3 *db) {
+    char requested[CURRENCY_CODE_SIZE];
+    requestedBaseCurrency(requested);
+
+    char *err_msg = NULL;
+    if (sqlite3_exec(db, currency_schema_sql, 0, 0, &err_msg) != SQLITE_OK) {
+        printf("Error: Failed to create exchange rate table: %s\n", err_msg);
+        sqlite3_free(err_msg);
+        return 0;
+    }
+
+    if (storedBaseCurrency(db, base_currency)) {
+        if (requested[0] != '\0' && strcmp(requested, base_currency) != 0) {
+            printf("Error: This ledger is kept in %s. FINANCE_LITE_CURRENCY=%s would re-denominate every amount "
+                   "in it; unset it or set it to %s.\n", base_currency, requested, base_currency);
+            return 0;
+        }
+    } else {
+        snprintf(base_currency, sizeof(base_currency), "%s", requested[0] ? requested : CURRENCY_DEFAULT_BASE);
+        sqlite3_stmt *stmt;
+        int ok = 0;
+        if (sqlite3_prepare_v2(db, "INSERT INTO ledger_currency (id, base) VALUES (1, ?);", -1, &stmt,
+                               NULL) == SQLITE_OK) {
+            sqlite3_bind_text(stmt, 1, base_currency, -1, SQLITE_STATIC);
+            ok = (sqlite3_step(stmt) == SQLITE_DONE);
+        }
+        sqlite3_finalize(stmt);
+        if (!ok) {
+            printf("Error: Failed to store the base currency: %s\n", sqlite3_errmsg(db));
+            return 0;
+        }
+    }
+    return ensureCurrencyColumn(db, "main", "income") && ensureCurrencyColumn(db, "main", "expenses") &&
+           reloadRateCache(db) && registerCurrencyFunctions(db);
+}
+
+// Function to register to_base() on a read-only connection to another ledger. Amounts are
+// converted with that ledger's own rates into its own base currency, which is copied to base.
+// A ledger that never stored one is taken to be in FINANCE_LITE_CURRENCY or the default.
+int registerLedgerCurrencyFunctions(sqlite3 *db, char *base) {
+    LedgerRates *rates = calloc(1, sizeof(LedgerRates));
+    if (!storedBaseCurrency(db, rates->base)) {
+        requestedBaseCurrency(rates->base);
+        if (rates->base[0] == '\0') {
+            snprintf(rates->base, sizeof(rates->base), "%s", CURRENCY_DEFAULT_BASE);
+        }
+    }
+
+    // A ledger from before currencies has no rate table and needs no rates
+    sqlite3_stmt *stmt;
+    int has_rates = sqlite3_prepare_v2(db, "SELECT 1 FROM sqlite_master WHERE name = 'exchange_rates';", -1, &stmt,
+                                       NULL) == SQLITE_OK && sqlite3_step(stmt) == SQLITE_ROW;
+    sqlite3_finalize(stmt);
+    if (has_rates && !loadRateList(db, &rates->currencies, &rates->currency_count)) {
+        free(rates);
+        return 0;
+    }
+
+    snprintf(base, CURRENCY_CODE_SIZE, "%s", rates->base);
+    if (sqlite3_create_function_v2(db, "to_base", 3, SQLITE_UTF8, rates, toBaseFunction,
+                                   NULL, NULL, freeLedgerRates) != SQLITE_OK) {
+        printf("SQLite Error: %s\n", sqlite3_errmsg(db));
+        return 0;
+    }
+    return 1;
+}
+
+// Function to register to_base() on a connection; other connections to an initialized ledger
+// share the rates already in memory
+int registerCurrencyFunctions(sqlite3 *db) {
+    if (sqlite3_create_function(db, "to_base", 3, SQLITE_UTF8, NULL, toBaseFunction, NULL, NULL) != SQLITE_OK) {
+        printf("SQLite Error: %s\n", sqlite3_errmsg(db));
+        return 0;
+    }
+    return 1;
+}
+
+// Function to get the currency reports are converted to
+const char *baseCurrency(void) {
+    return base_currency[0] ? base_currency : CURRENCY_DEFAULT_BASE;
+}
+
+// Function to turn user input into a currency code; blank or the base currency gives "".
+// Returns 0 if the input is not a three-letter code.
+int normalizeCurrencyCode(const char *text, char *code) {
+    if (!parseCurrencyCode(text, code)) {
+        return 0;
+    }
+    if (strcmp(code, baseCurrency()) == 0) {
+        code[0] = '\0';
+    }
+    return 1;
+}
+
+// Function to convert an amount on a date to the base currency. Dates before a currency's
+// first rate use that first rate; *found is 0 when the currency has no rates at all.
+double convertToBase(double amount, const char *currency, const char *date, int *found) {
+    *found = 1;
+    if (currency == NULL || currency[0] == '\0' || strcmp(currency, baseCurrency()) == 0) {
+        return amount;
+    }
+
+    pthread_rwlock_rdlock(&rates_lock);
+    double rate = lookupRate(currencies, currency_count, currency, dayNumber(date));
+    pthread_rwlock_unlock(&rates_lock);
+
+    if (rate == 0) {
+        *found = 0;
+    }
+    return amount * rate;
+}
+
+// Function to load rates from a CSV file of currency,YYYY-MM-DD,rate lines, where rate is
+// base units per unit of the currency. Rates already in the table for the same day are replaced.
+// Lines are read and parsed with the same tokenizers as a bank statement import.
+int loadExchangeRates(sqlite3 *db, const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        printf("Error: Could not open %s.\n", path);
+        return 0;
+    }
+    LineReader *reader = malloc(sizeof(LineReader));
+    initLineReader(reader, fd);
+
+    const char *insert_sql = "INSERT INTO exchange_rates (currency, date, rate) VALUES (?, ?, ?) "
+                             "ON CONFLICT(currency, date) DO UPDATE SET rate = excluded.rate;";
+    sqlite3_stmt *stmt;
+    char *line;
+    int line_number = 0, loaded = 0, skipped = 0, ok = 1;
+
+    beginBatchedWrite();
+    sqlite3_exec(db, "SAVEPOINT load_rates;", 0, 0, NULL);
+    if (sqlite3_prepare_v2(db, insert_sql, -1, &stmt, NULL) != SQLITE_OK) {
+        printf("SQLite Error: %s\n", sqlite3_errmsg(db));
+        ok = 0;
+    }
+    while (ok && (line = readLine(reader)) != NULL) {
+        char date[11], code[CURRENCY_CODE_SIZE];
+        int year, month, day;
+        double rate;
+        line_number++;
+        line[strcspn(line, "\r")] = '\0';
+        if (line[strspn(line, " \t")] == '\0' || line[strspn(line, " \t")] == '#') {
+            continue;
+        }
+
+        char *cursor = line;
+        char *code_text = nextToken(&cursor, ',');
+        char *date_text = nextToken(&cursor, ',');
+        char *rate_text = nextToken(&cursor, ',');
+        if (date_text == NULL || rate_text == NULL || !normalizeCurrencyCode(code_text, code) ||
+            !parseDateToken(date_text, &year, &month, &day) || !parseDecimalToken(rate_text, &rate) || rate <= 0) {
+            if (line_number > 1) {   // The first line may be a header
+                printf("Warning: Skipping line %d of %s.\n", line_number, path);
+                skipped++;
+            }
+            continue;
+        }
+        snprintf(date, sizeof(date), "%04d-%02d-%02d", year, month, day);
+        if (dayNumber(date) < 0) {
+            printf("Warning: Skipping line %d of %s.\n", line_number, path);
+            skipped++;
+            continue;
+        }
+        if (code[0] == '\0') {
+            skipped++;   // A rate for the base currency is always 1
+            continue;
+        }
+
+        sqlite3_bind_text(stmt, 1, code, -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 2, date, -1, SQLITE_STATIC);
+        sqlite3_bind_double(stmt, 3, rate);
+        if (sqlite3_step(stmt) != SQLITE_DONE) {
+            printf("SQLite Error: %s\n", sqlite3_errmsg(db));
+            ok = 0;
+        }
+        sqlite3_reset(stmt);
+        loaded++;
+    }
+    sqlite3_finalize(stmt);
+    close(fd);
+    free(reader);
+
+    if (!ok) {
+        sqlite3_exec(db, "ROLLBACK TO load_rates;", 0, 0, NULL);
+    }
+    sqlite3_exec(db, "RELEASE load_rates;", 0, 0, NULL);
+    endBatchedWrite();
+
+    if (ok && reloadRateCache(db)) {
+        printf("Loaded %d exchange rates from %s", loaded, path);
+        if (skipped > 0) {
+            printf(" (%d lines skipped)", skipped);
+        }
+        printf(".\n");
+    }
+    return ok;
+}
+
+// Function to prompt for a rate file, load it and list the rates now in effect
+void loadExchangeRatesPrompt(sqlite3 *db) {
+    char path[INPUT_LINE_MAX];
+
+    printf("Exchange rate file (blank for %s): ", CURRENCY_RATES_FILE);
+    if (getOptionalStringInput(path, sizeof(path)) == 0) {
+        snprintf(path, sizeof(path), "%s", CURRENCY_RATES_FILE);
+    }
+    if (!loadExchangeRates(db, path)) {
+        return;
+    }
+
+    pthread_rwlock_rdlock(&rates_lock);
+    printf("\n--- Exchange Rates (in %s) ---\n", baseCurrency());
+    for (int i = 0; i < currency_count; i++) {
+        printf("%s: %d days of rates, latest %.6f\n", currencies[i].code, currencies[i].day_count,
+               currencies[i].rates[currencies[i].day_count - 1]);
+    }
+    if (currency_count == 0) {
+        printf("No exchange rates loaded.\n");
+    }
+    pthread_rwlock_unlock(&rates_lock);
+}
+
+// Function to warn about amounts a report left out for lack of a rate
+void reportMissingRates(void) {
+    long missing = atomic_exchange(&missing_rates, 0);
+    if (missing > 0) {
+        printf("Warning: %ld conversions had no exchange rate and were left out; load rates from Reports & Tools.\n",
+               missing);
+    }
+}
@@ -2,6 +2,19 @@
 #include "budget.h"
 #include "utils.h"
 #include "database.h"
+#include "category_limits.h"
+#include "journal.h"
+#include "batch.h"
+#include "search.h"
+#include "listing.h"
+#include "history.h"
+#include "savings.h"
+#include "backup.h"
+#include "schema.h"
+#include "dedupe.h"
+#include "currency.h"
+#include "metrics.h"
+#include "snapshot.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
@@ -17,55 +30,228 @@ void initializeDatabase(sqlite3 **db, const char *db_name) {
         exit(1);
     }
 
-    // Create savings_goals table
-    const char *sql_savings_goals =
-        "CREATE TABLE IF NOT EXISTS savings_goals ("
-        "id INTEGER PRIMARY KEY AUTOINCREMENT, "
-        "name TEXT NOT NULL, "
-        "target_amount REAL, "
-        "saved_amount REAL DEFAULT 0, "
-        "due_date TEXT);";
-        
-    // Create income table
-    const char *sql_income =
-        "CREATE TABLE IF NOT EXISTS income ("
-        "id INTEGER PRIMARY KEY AUTOINCREMENT, "
-        "amount REAL, "
-        "date TEXT);";
-    
-    // Create expenses table
-    const char *sql_expenses =
-        "CREATE TABLE IF NOT EXISTS expenses ("
-        "id INTEGER PRIMARY KEY AUTOINCREMENT, "
-        "category TEXT, "
-        "amount REAL, "
-        "date TEXT);";
-    
+    // Core tables come from the definitions in schema.h
+    const char *sql_core_tables =
+        SCHEMA_CREATE_SQL(SCHEMA_SAVINGS_GOALS)
+        SCHEMA_CREATE_SQL(SCHEMA_INCOME)
+        SCHEMA_CREATE_SQL(SCHEMA_EXPENSES)
+        SCHEMA_CREATE_SQL(SCHEMA_RECURRING)
+        SCHEMA_CREATE_SQL(SCHEMA_LAST_PROCESSED_MONTH)
+        SCHEMA_CREATE_SQL(SCHEMA_CATEGORY_LIMITS)
+        SCHEMA_CREATE_SQL(SCHEMA_JOURNAL_STATE)
+        SCHEMA_CREATE_SQL(SCHEMA_CATEGORY_RULES);
+
+    // Create archive summary tables: one row per archived year, and its per-category totals
+    const char *sql_archives =
+        "CREATE TABLE IF NOT EXISTS archives ("
+        "year INTEGER PRIMARY KEY, "
+        "path TEXT NOT NULL, "
+        "income_total REAL NOT NULL DEFAULT 0, "
+        "income_count INTEGER NOT NULL DEFAULT 0, "
+        "expense_total REAL NOT NULL DEFAULT 0, "
+        "expense_count INTEGER NOT NULL DEFAULT 0);"
+        "CREATE TABLE IF NOT EXISTS archive_category_totals ("
+        "year INTEGER NOT NULL, "
+        "category TEXT NOT NULL, "
+        "total REAL NOT NULL, "
+        "count INTEGER NOT NULL, "
+        "PRIMARY KEY (year, category));";
+
+    // Indexes for date-ordered and per-category listings
+    const char *sql_listing_indexes =
+        "CREATE INDEX IF NOT EXISTS idx_income_date ON income(date);"
+        "CREATE INDEX IF NOT EXISTS idx_expenses_date ON expenses(date);"
+        "CREATE INDEX IF NOT EXISTS idx_expenses_category_date ON expenses(category, date);";
+
     char *err_msg = NULL;
 
     // Execute all the table creation queries
-    if (sqlite3_exec(*db, sql_savings_goals, 0, 0, &err_msg) != SQLITE_OK ||
-        sqlite3_exec(*db, sql_income, 0, 0, &err_msg) != SQLITE_OK ||
-        sqlite3_exec(*db, sql_expenses, 0, 0, &err_msg) != SQLITE_OK) {
+    if (sqlite3_exec(*db, sql_core_tables, 0, 0, &err_msg) != SQLITE_OK ||
+        sqlite3_exec(*db, sql_listing_indexes, 0, 0, &err_msg) != SQLITE_OK ||
+        sqlite3_exec(*db, sql_archives, 0, 0, &err_msg) != SQLITE_OK) {
         printf("Error: Failed to create tables: %s\n", err_msg);
         sqlite3_free(err_msg);
         sqlite3_close(*db);
         exit(1);
     }
 
+    // Add the currency column to older ledgers before anything copies their rows
+    if (!initializeCurrency(*db)) {
+        sqlite3_close(*db);
+        exit(1);
+    }
+
+    // Create the search index, change history, contribution ledger, posting fingerprints,
+    // backup change log, snapshot change counter and metrics row counts
+    if (!initializeSearchIndex(*db) || !initializeHistory(*db) || !initializeSavingsLedger(*db) ||
+        !initializePostingTable(*db) || !initializeBackupTracking(*db) || !initializeSnapshotTracking(*db) ||
+        !initializeRowCounts(*db)) {
+        sqlite3_close(*db);
+        exit(1);
+    }
+
+    // Wait for the journal compactor instead of failing when it holds the write lock
+    sqlite3_busy_timeout(*db, 5000);
+
+    // Fold in any journaled operations that were not compacted before the last exit
+    replayJournal(*db, db_name);
+
+    // Fingerprint rows added since the last run, including replayed ones, for duplicate checks
+    if (!initializeFingerprints(*db)) {
+        sqlite3_close(*db);
+        exit(1);
+    }
+
     printf("Database initialized successfully.\n");
 }
 
 
 
+// Open a savepoint for a recurring posting, so its row and fingerprint are kept together;
+// does nothing for an ordinary row (posting 0)
+static int beginPosting(sqlite3 *db, uint64_t posting) {
+    return posting == 0 || sqlite3_exec(db, "SAVEPOINT recurring_posting;", 0, 0, NULL) == SQLITE_OK;
+}
+
+// Record the posting fingerprint after its row and close the savepoint, undoing the row when
+// either write failed; returns whether both were written
+static int endPosting(sqlite3 *db, uint64_t posting, int ok) {
+    if (posting == 0) {
+        return ok;
+    }
+    ok = ok && recordRecurringPosting(db, posting);
+    if (!ok) {
+        printf("Error: Failed to record recurring posting: %s\n", sqlite3_errmsg(db));
+        sqlite3_exec(db, "ROLLBACK TO recurring_posting;", 0, 0, NULL);
+    }
+    if (sqlite3_exec(db, "RELEASE recurring_posting;", 0, 0, NULL) != SQLITE_OK) {
+        ok = 0;
+    }
+    return ok;
+}
+
+// Write a single income row, with its recurring posting fingerprint unless posting is 0.
+// Journal records have no currency or posting, so those rows are always written directly.
+static int writeIncome(sqlite3 *db, float amount, const char *date, const char *currency, uint64_t posting) {
+    if (currency != NULL && currency[0] == '\0') {
+        currency = NULL;
+    }
+    if (journalEnabled() && currency == NULL && posting == 0) {
+        int ok = journalAppendIncome(amount, date);
+        metricsCountInsert(METRIC_INCOME, ok);
+        if (ok) {
+            rememberFingerprint(transactionFingerprint(FINGERPRINT_INCOME, date, amount, NULL, currency));
+        }
+        return ok;
+    }
+
+    IncomeRow row = { .amount = amount, .date = date, .currency = currency };
+    sqlite3_stmt *stmt = NULL;
+    int ok = 0;
+
+    beginBatchedWrite();
+    if (beginPosting(db, posting)) {
+        if (sqlite3_prepare_v2(db, SCHEMA_INSERT_SQL(SCHEMA_INCOME) ";", -1, &stmt, NULL) == SQLITE_OK) {
+            schemaBind_income(stmt, &row);
+            ok = (sqlite3_step(stmt) == SQLITE_DONE);
+        }
+        if (!ok) {
+            printf("Error: Failed to add income: %s\n", sqlite3_errmsg(db));
+        }
+        sqlite3_finalize(stmt);
+        ok = endPosting(db, posting, ok);
+    }
+    endBatchedWrite();
+    metricsCountInsert(METRIC_INCOME, ok);
+    if (ok) {
+        rememberFingerprint(transactionFingerprint(FINGERPRINT_INCOME, date, amount, NULL, currency));
+        if (posting != 0) {
+            rememberFingerprint(posting);
+        }
+    }
+    return ok;
+}
+
+// Write a single expense row, with its recurring posting fingerprint unless posting is 0,
+// and check it against the category limit
+static int writeExpense(sqlite3 *db, const char *category, float amount, const char *date, const char *currency,
+                        uint64_t posting) {
+    int ok = 0;
+
+    if (currency != NULL && currency[0] == '\0') {
+        currency = NULL;
+    }
+    if (journalEnabled() && currency == NULL && posting == 0) {
+        ok = journalAppendExpense(category, amount, date);
+    } else {
+        ExpenseRow row = { .category = category, .amount = amount, .date = date, .currency = currency };
+        sqlite3_stmt *stmt = NULL;
+
+        beginBatchedWrite();
+        if (beginPosting(db, posting)) {
+            if (sqlite3_prepare_v2(db, SCHEMA_INSERT_SQL(SCHEMA_EXPENSES) ";", -1, &stmt, NULL) == SQLITE_OK) {
+                schemaBind_expenses(stmt, &row);
+                ok = (sqlite3_step(stmt) == SQLITE_DONE);
+            }
+            if (!ok) {
+                printf("Error: Failed to add expense: %s\n", sqlite3_errmsg(db));
+            }
+            sqlite3_finalize(stmt);
+            ok = endPosting(db, posting, ok);
+        }
+        endBatchedWrite();
+    }
+    metricsCountInsert(METRIC_EXPENSES, ok);
+
+    if (ok) {
+        rememberFingerprint(transactionFingerprint(FINGERPRINT_EXPENSE, date, amount, category, currency));
+        if (posting != 0) {
+            rememberFingerprint(posting);
+        }
+        int found;   // Limits are in the base currency; an expense without a rate doesn't count yet
+        LimitStatus status = recordCategorySpend(category, convertToBase(amount, currency, date, &found), date);
+        if (status == LIMIT_OVER) {
+            printf("Warning: %s is over its monthly limit.\n", category);
+        } else if (status == LIMIT_NEAR) {
+            printf("Warning: %s is near its monthly limit.\n", category);
+        }
+    }
+    return ok;
+}
+
+// Function to write a single income row; currency is NULL or "" for the base currency
+int addIncomeRecord(sqlite3 *db, float amount, const char *date, const char *currency) {
+    return writeIncome(db, amount, date, currency, 0);
+}
+
+// Function to write a single expense row and check it against the category limit
+int addExpenseRecord(sqlite3 *db, const char *category, float amount, const char *date, const char *currency) {
+    return writeExpense(db, category, amount, date, currency, 0);
+}
+
+// Prompt for a currency until the input is a valid code; blank means the base currency
+static void getCurrencyInput(char *currency) {
+    char input[INPUT_LINE_MAX];
+    while (1) {
+        printf("Currency (blank for %s): ", baseCurrency());
+        getOptionalStringInput(input, sizeof(input));
+        if (normalizeCurrencyCode(input, currency)) {
+            return;
+        }
+        printf("Error: Please enter a three-letter currency code such as EUR.\n");
+    }
+}
+
 // Function to insert income
 void insertIncome(sqlite3 *db) {
     float amount;
     int is_recurring;
     char date[20];
+    char currency[CURRENCY_CODE_SIZE];
 
     printf("Enter income amount: $");
     amount = getValidFloatInput();  // Ensure valid positive amount
+    getCurrencyInput(currency);
 
     printf("Is this recurring income? (1 = Yes, 0 = No): ");
     is_recurring = getValidIntInput();  // Ensure valid input for is_recurring
@@ -101,8 +287,7 @@ void insertIncome(sqlite3 *db) {
             case 3:
                 // Allow custom date input
                 printf("Enter custom date (YYYY-MM-DD): ");
-                fgets(date, sizeof(date), stdin);
-                date[strcspn(date, "\n")] = 0;  // Remove trailing newline
+                getValidDateInput(date, sizeof(date));
                 break;
 
             default:
@@ -111,19 +296,19 @@ void insertIncome(sqlite3 *db) {
         }
     }
 
+    // Identical income on the same day is allowed, but is probably entered twice by mistake
+    if (fingerprintSeen(transactionFingerprint(FINGERPRINT_INCOME, date, amount, NULL, currency))) {
+        printf("Warning: Income of $%.2f on %s is already recorded; adding it again.\n", amount, date);
+    }
+
     // Insert income into the database
-    const char *sql = "INSERT INTO income (amount, date) VALUES (?, ?);";
-    sqlite3_stmt *stmt;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) == SQLITE_OK) {
-        sqlite3_bind_double(stmt, 1, amount);
-        sqlite3_bind_text(stmt, 2, date, -1, SQLITE_STATIC);
-        if (sqlite3_step(stmt) == SQLITE_DONE) {
-            printf("Income added: $%.2f on %s\n", amount, date);
+    if (addIncomeRecord(db, amount, date, currency)) {
+        if (currency[0] != '\0') {
+            printf("Income added: %.2f %s on %s\n", amount, currency, date);
         } else {
-            printf("Error: Failed to add income: %s\n", sqlite3_errmsg(db));
+            printf("Income added: $%.2f on %s\n", amount, date);
         }
     }
-    sqlite3_finalize(stmt);
 }
 
 void insertExpense(sqlite3 *db) {
@@ -131,12 +316,14 @@ void insertExpense(sqlite3 *db) {
     float amount;
     int is_recurring;
     char date[20];
+    char currency[CURRENCY_CODE_SIZE];
 
     printf("Enter expense category: ");
-    scanf("%s", category);
+    getValidStringInput(category, MAX_NAME_LENGTH);
 
     printf("Enter amount: $");
     amount = getValidFloatInput();  // Ensure valid positive amount
+    getCurrencyInput(currency);
 
     printf("Is this a recurring expense? (1 = Yes, 0 = No): ");
     is_recurring = getValidIntInput();  // Ensure valid input for is_recurring
@@ -172,8 +359,7 @@ void insertExpense(sqlite3 *db) {
             case 3:
                 // Allow custom date input
                 printf("Enter custom date (YYYY-MM-DD): ");
-                fgets(date, sizeof(date), stdin);
-                date[strcspn(date, "\n")] = 0;  // Remove trailing newline
+                getValidDateInput(date, sizeof(date));
                 break;
 
             default:
@@ -182,31 +368,28 @@ void insertExpense(sqlite3 *db) {
         }
     }
 
+    if (fingerprintSeen(transactionFingerprint(FINGERPRINT_EXPENSE, date, amount, category, currency))) {
+        printf("Warning: %s - $%.2f on %s is already recorded; adding it again.\n", category, amount, date);
+    }
+
     // Insert expense into the database
-    const char *sql = "INSERT INTO expenses (category, amount, date) VALUES (?, ?, ?);";
-    sqlite3_stmt *stmt;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) == SQLITE_OK) {
-        sqlite3_bind_text(stmt, 1, category, -1, SQLITE_STATIC);
-        sqlite3_bind_double(stmt, 2, amount);
-        sqlite3_bind_text(stmt, 3, date, -1, SQLITE_STATIC);
-        if (sqlite3_step(stmt) == SQLITE_DONE) {
-            printf("Expense added: %s - $%.2f on %s\n", category, amount, date);
+    if (addExpenseRecord(db, category, amount, date, currency)) {
+        if (currency[0] != '\0') {
+            printf("Expense added: %s - %.2f %s on %s\n", category, amount, currency, date);
         } else {
-            printf("Error: Failed to add expense: %s\n", sqlite3_errmsg(db));
+            printf("Expense added: %s - $%.2f on %s\n", category, amount, date);
         }
     }
-    sqlite3_finalize(stmt);
 }
 
 // Function to insert a savings goal
 void insertSavingsGoal(sqlite3 *db, const char *name, float target_amount, const char *due_date) {
-    const char *sql = "INSERT INTO savings_goals (name, target_amount, saved_amount, due_date) VALUES (?, ?, 0, ?);";
+    SavingsGoalRow row = { .name = name, .target_amount = target_amount, .saved_amount = 0, .due_date = due_date };
     sqlite3_stmt *stmt;
 
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) == SQLITE_OK) {
-        sqlite3_bind_text(stmt, 1, name, -1, SQLITE_STATIC);
-        sqlite3_bind_double(stmt, 2, target_amount);
-        sqlite3_bind_text(stmt, 3, due_date, -1, SQLITE_STATIC);
+    beginBatchedWrite();
+    if (sqlite3_prepare_v2(db, SCHEMA_INSERT_SQL(SCHEMA_SAVINGS_GOALS) ";", -1, &stmt, NULL) == SQLITE_OK) {
+        schemaBind_savings_goals(stmt, &row);
 
         if (sqlite3_step(stmt) == SQLITE_DONE) {
             printf("Savings goal added: %s - Target: $%.2f, Due: %s\n", name, target_amount, due_date);
@@ -215,39 +398,38 @@ void insertSavingsGoal(sqlite3 *db, const char *name, float target_amount, const
         }
     }
     sqlite3_finalize(stmt);
+    endBatchedWrite();
 }
 
-// Function to update savings goal
+// Function to update savings goal by recording a contribution dated today
 void updateSavingsGoal(sqlite3 *db, int goal_id, float amount) {
-    const char *sql = "UPDATE savings_goals SET saved_amount = saved_amount + ? WHERE id = ? RETURNING id;";
-    sqlite3_stmt *stmt;
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    sqlite3_bind_double(stmt, 1, amount);
-    sqlite3_bind_int(stmt, 2, goal_id);
-    sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
-    if (sqlite3_step(stmt) == SQLITE_ROW) {
+    GoalContribution contribution = { .goal_id = goal_id, .amount = amount };
+    time_t t = time(NULL);
+    strftime(contribution.date, sizeof(contribution.date), "%Y-%m-%d", localtime(&t));
+
+    if (postGoalContributions(db, &contribution, 1) == 1) {
         printf("Savings goal updated successfully.\n");
-    } else {
-        printf("Error: Goal ID not found.\n");
-    }   
+    }
 }
 
 // Function to fetch and display savings goals
 void fetchSavingsGoals(sqlite3 *db) {
-    const char *sql = "SELECT id, name, target_amount, saved_amount, due_date FROM savings_goals;";
-    sqlite3_stmt *stmt;
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    ListCursor cursor = {0};
+    ListPage page;
+
     printf("\n--- Savings Goals ---\n");
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        printf("[ID: %d] Goal: %s, Target: $%.2f, Saved: $%.2f, Due: %s\n",
-            sqlite3_column_int(stmt, 0),  // ID
-            sqlite3_column_text(stmt, 1),  // Name
-            sqlite3_column_double(stmt, 2), // Target amount
-            sqlite3_column_double(stmt, 3), // Saved amount
-            sqlite3_column_text(stmt, 4)); // Due date
+    // Walk the goals a page at a time so memory stays flat however many there are
+    while (!cursor.done && fetchListPage(db, LIST_SAVINGS_GOALS, LIST_BY_ID, NULL, &cursor, LIST_PAGE_MAX, &page)) {
+        for (int i = 0; i < page.count; i++) {
+            printf("[ID: %lld] Goal: %s, Target: $%.2f, Saved: $%.2f, Due: %s\n",
+                (long long)page.rows[i].id,     // ID
+                page.rows[i].label,             // Name
+                page.rows[i].amount,            // Target amount
+                page.rows[i].saved_amount,      // Saved amount
+                page.rows[i].date);             // Due date
+        }
+        cursor = page.next;
     }
-    sqlite3_finalize(stmt);
 }
 
 // Function to save budget into a JSON file
@@ -255,8 +437,11 @@ void saveBudgetToJSON(sqlite3 *db, const char *filename) {
     // Create a JSON object
     cJSON *json_budget = cJSON_CreateObject();
 
+    // Totals are in the base currency; each expense keeps its own currency and amount
+    cJSON_AddStringToObject(json_budget, "currency", baseCurrency());
+
     // Export income
-    const char *income_sql = "SELECT SUM(amount) FROM income;";
+    const char *income_sql = "SELECT SUM(to_base(amount, currency, date)) FROM income;";
     sqlite3_stmt *stmt;
     sqlite3_prepare_v2(db, income_sql, -1, &stmt, NULL);
     float total_income = 0;
@@ -268,26 +453,38 @@ void saveBudgetToJSON(sqlite3 *db, const char *filename) {
 
     // Export expenses
     cJSON *json_expenses = cJSON_CreateArray();
-    const char *expense_sql = "SELECT category, amount FROM expenses;";
-    sqlite3_prepare_v2(db, expense_sql, -1, &stmt, NULL);
+    ExpenseRow expense_row;
+    sqlite3_prepare_v2(db, SCHEMA_SELECT_SQL(SCHEMA_EXPENSES) ";", -1, &stmt, NULL);
     while (sqlite3_step(stmt) == SQLITE_ROW) {
+        schemaRead_expenses(stmt, &expense_row);
         cJSON *expense = cJSON_CreateObject();
-        cJSON_AddStringToObject(expense, "category", (const char*)sqlite3_column_text(stmt, 0));
-        cJSON_AddNumberToObject(expense, "amount", sqlite3_column_double(stmt, 1));
+        cJSON_AddStringToObject(expense, "category", expense_row.category);
+        cJSON_AddNumberToObject(expense, "amount", expense_row.amount);
+        cJSON_AddStringToObject(expense, "currency", expense_row.currency && expense_row.currency[0]
+                                                         ? expense_row.currency : baseCurrency());
+        int found;
+        double base_amount = convertToBase(expense_row.amount, expense_row.currency, expense_row.date, &found);
+        if (found) {
+            cJSON_AddNumberToObject(expense, "base_amount", base_amount);
+        } else {
+            cJSON_AddNullToObject(expense, "base_amount");
+        }
         cJSON_AddItemToArray(json_expenses, expense);
     }
     sqlite3_finalize(stmt);
+    reportMissingRates();
     cJSON_AddItemToObject(json_budget, "expenses", json_expenses);
 
     // Export savings goals
     cJSON *json_savings = cJSON_CreateArray();
-    const char *savings_sql = "SELECT name, target_amount, saved_amount FROM savings_goals;";
-    sqlite3_prepare_v2(db, savings_sql, -1, &stmt, NULL);
+    SavingsGoalRow goal_row;
+    sqlite3_prepare_v2(db, SCHEMA_SELECT_SQL(SCHEMA_SAVINGS_GOALS) ";", -1, &stmt, NULL);
     while (sqlite3_step(stmt) == SQLITE_ROW) {
+        schemaRead_savings_goals(stmt, &goal_row);
         cJSON *goal = cJSON_CreateObject();
-        cJSON_AddStringToObject(goal, "name", (const char*)sqlite3_column_text(stmt, 0));
-        cJSON_AddNumberToObject(goal, "target_amount", sqlite3_column_double(stmt, 1));
-        cJSON_AddNumberToObject(goal, "saved_amount", sqlite3_column_double(stmt, 2));
+        cJSON_AddStringToObject(goal, "name", goal_row.name);
+        cJSON_AddNumberToObject(goal, "target_amount", goal_row.target_amount);
+        cJSON_AddNumberToObject(goal, "saved_amount", goal_row.saved_amount);
         cJSON_AddItemToArray(json_savings, goal);
     }
     sqlite3_finalize(stmt);
@@ -295,13 +492,14 @@ void saveBudgetToJSON(sqlite3 *db, const char *filename) {
 
     // Export recurring transactions
     cJSON *json_recurring = cJSON_CreateArray();
-    const char *recurring_sql = "SELECT type, description, amount FROM recurring;";
-    sqlite3_prepare_v2(db, recurring_sql, -1, &stmt, NULL);
+    RecurringRow recurring_row;
+    sqlite3_prepare_v2(db, SCHEMA_SELECT_SQL(SCHEMA_RECURRING) ";", -1, &stmt, NULL);
     while (sqlite3_step(stmt) == SQLITE_ROW) {
+        schemaRead_recurring(stmt, &recurring_row);
         cJSON *entry = cJSON_CreateObject();
-        cJSON_AddStringToObject(entry, "type", (const char*)sqlite3_column_text(stmt, 0));
-        cJSON_AddStringToObject(entry, "description", (const char*)sqlite3_column_text(stmt, 1));
-        cJSON_AddNumberToObject(entry, "amount", sqlite3_column_double(stmt, 2));
+        cJSON_AddStringToObject(entry, "type", recurring_row.type);
+        cJSON_AddStringToObject(entry, "description", recurring_row.description);
+        cJSON_AddNumberToObject(entry, "amount", recurring_row.amount);
         cJSON_AddItemToArray(json_recurring, entry);
     }
     sqlite3_finalize(stmt);
@@ -347,23 +545,28 @@ void getLastProcessedMonth(sqlite3 *db, int *year, int *month) {
 
 // Function to update the last processed month
 void updateLastProcessedMonth(sqlite3 *db, int year, int month) {
-    const char *sql = "INSERT INTO last_processed_month (id, year, month) VALUES (1, ?, ?) "
-                      "ON CONFLICT(id) DO UPDATE SET year = excluded.year, month = excluded.month;";
+    LastProcessedMonthRow row = { .id = 1, .year = year, .month = month };
     sqlite3_stmt *stmt;
 
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) == SQLITE_OK) {
-        sqlite3_bind_int(stmt, 1, year);
-        sqlite3_bind_int(stmt, 2, month);
+    beginBatchedWrite();
+    if (sqlite3_prepare_v2(db, SCHEMA_UPSERT_SQL(SCHEMA_LAST_PROCESSED_MONTH) ";", -1, &stmt, NULL) == SQLITE_OK) {
+        schemaBind_last_processed_month(stmt, &row);
         sqlite3_step(stmt);
     }
 
     sqlite3_finalize(stmt);
+    endBatchedWrite();
 }
 
 // Function to apply recurring income and expenses automatically at the start of a new month
 void applyRecurringTransactions(sqlite3 *db) {
+    applyRecurringTransactionsAt(db, time(NULL));
+}
+
+// Function to apply recurring entries as if the current time were t, so a simulated clock
+// can step across month boundaries
+void applyRecurringTransactionsAt(sqlite3 *db, time_t t) {
     // Get current date
-    time_t t = time(NULL);
     struct tm *current_time = localtime(&t);
     int current_year = current_time->tm_year + 1900;
     int current_month = current_time->tm_mon + 1;
@@ -380,62 +583,54 @@ void applyRecurringTransactions(sqlite3 *db) {
 
     printf("\nApplying recurring income and expenses for %d/%d...\n", current_month, current_year);
 
-    // Generate the current date in YYYY-MM-DD format
+    // Generate the current date in YYYY-MM-DD format, and the month that postings are checked against
     char date[20];
+    char month[8];
     strftime(date, sizeof(date), "%Y-%m-%d", localtime(&t));
+    strftime(month, sizeof(month), "%Y-%m", localtime(&t));
 
     // Process recurring income
-    const char *recurring_income_sql = "SELECT description, amount FROM recurring WHERE type = 'income';";
+    const char *recurring_income_sql = SCHEMA_SELECT_SQL(SCHEMA_RECURRING) " WHERE type = 'income';";
     sqlite3_stmt *stmt;
+    RecurringRow entry;
 
     if (sqlite3_prepare_v2(db, recurring_income_sql, -1, &stmt, NULL) == SQLITE_OK) {
         while (sqlite3_step(stmt) == SQLITE_ROW) {
-            const char *description = (const char*)sqlite3_column_text(stmt, 0);
-            float amount = sqlite3_column_double(stmt, 1);
-
-            // Insert recurring income into the income table
-            const char *insert_income_sql = "INSERT INTO income (amount, date) VALUES (?, ?);";
-            sqlite3_stmt *income_stmt;
-
-            if (sqlite3_prepare_v2(db, insert_income_sql, -1, &income_stmt, NULL) == SQLITE_OK) {
-                sqlite3_bind_double(income_stmt, 1, amount);
-                sqlite3_bind_text(income_stmt, 2, date, -1, SQLITE_STATIC);
-                
-                if (sqlite3_step(income_stmt) == SQLITE_DONE) {
-                    printf("Added recurring income: %s - $%.2f on %s\n", description, amount, date);
-                } else {
-                    printf("Error: Failed to insert recurring income: %s\n", sqlite3_errmsg(db));
-                }
+            schemaRead_recurring(stmt, &entry);
+            uint64_t posting = postingFingerprint(FINGERPRINT_RECURRING_INCOME, month, entry.id, entry.amount, entry.description);
+            if (fingerprintSeen(posting)) {
+                printf("Skipped recurring income: %s - $%.2f is already posted for %s\n", entry.description, entry.amount, month);
+                metricsCountRecurring(METRIC_INCOME, 0);
+                continue;
+            }
+
+            // Insert recurring income into the income table, bypassing the journal
+            if (writeIncome(db, entry.amount, date, NULL, posting)) {
+                printf("Added recurring income: %s - $%.2f on %s\n", entry.description, entry.amount, date);
+                metricsCountRecurring(METRIC_INCOME, 1);
             }
-            sqlite3_finalize(income_stmt);
         }
     }
     sqlite3_finalize(stmt);
 
     // Process recurring expenses
-    const char *recurring_expense_sql = "SELECT description, amount FROM recurring WHERE type = 'expense';";
+    const char *recurring_expense_sql = SCHEMA_SELECT_SQL(SCHEMA_RECURRING) " WHERE type = 'expense';";
 
     if (sqlite3_prepare_v2(db, recurring_expense_sql, -1, &stmt, NULL) == SQLITE_OK) {
         while (sqlite3_step(stmt) == SQLITE_ROW) {
-            const char *description = (const char*)sqlite3_column_text(stmt, 0);
-            float amount = sqlite3_column_double(stmt, 1);
-
-            // Insert recurring expenses into the expenses table
-            const char *insert_expense_sql = "INSERT INTO expenses (category, amount, date) VALUES (?, ?, ?);";
-            sqlite3_stmt *expense_stmt;
-
-            if (sqlite3_prepare_v2(db, insert_expense_sql, -1, &expense_stmt, NULL) == SQLITE_OK) {
-                sqlite3_bind_text(expense_stmt, 1, description, -1, SQLITE_STATIC);
-                sqlite3_bind_double(expense_stmt, 2, amount);
-                sqlite3_bind_text(expense_stmt, 3, date, -1, SQLITE_STATIC);
-                
-                if (sqlite3_step(expense_stmt) == SQLITE_DONE) {
-                    printf("Added recurring expense: %s - $%.2f on %s\n", description, amount, date);
-                } else {
-                    printf("Error: Failed to insert recurring expense: %s\n", sqlite3_errmsg(db));
-                }
+            schemaRead_recurring(stmt, &entry);
+            uint64_t posting = postingFingerprint(FINGERPRINT_RECURRING_EXPENSE, month, entry.id, entry.amount, entry.description);
+            if (fingerprintSeen(posting)) {
+                printf("Skipped recurring expense: %s - $%.2f is already posted for %s\n", entry.description, entry.amount, month);
+                metricsCountRecurring(METRIC_EXPENSES, 0);
+                continue;
+            }
+
+            // Insert recurring expenses into the expenses table, bypassing the journal
+            if (writeExpense(db, entry.description, entry.amount, date, NULL, posting)) {
+                printf("Added recurring expense: %s - $%.2f on %s\n", entry.description, entry.amount, date);
+                metricsCountRecurring(METRIC_EXPENSES, 1);
             }
-            sqlite3_finalize(expense_stmt);
         }
     }
     sqlite3_finalize(stmt);
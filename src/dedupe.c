@@ -0,0 +1,333 @@
+#define _XOPEN_SOURCE 700
+#include "dedupe.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <pthread.h>
+#include <sqlite3.h>
+
+// Fingerprints of every income and expense row. The table is
+// derived: rows added since the high-water marks in fingerprint_state are fingerprinted
+// when the ledger is opened, so inserts never pay for an extra write.
+static const char *fingerprint_schema_sql =
+    "CREATE TABLE IF NOT EXISTS transaction_fingerprints ("
+    "fingerprint INTEGER PRIMARY KEY);"
+    "CREATE TABLE IF NOT EXISTS fingerprint_state ("
+    "id INTEGER PRIMARY KEY, "
+    "last_income_id INTEGER NOT NULL, "
+    "last_expense_id INTEGER NOT NULL, "
+    "version INTEGER NOT NULL DEFAULT 1);";
+
+// Version 2 hashes the currency of foreign-currency rows. Fingerprints of an older version
+// are dropped and every row is fingerprinted again.
+#define FINGERPRINT_VERSION 2
+
+// Recurring posting fingerprints can't be derived from the rows, so they have their own table.
+// It has an id so backups can copy it incrementally.
+static const char *posting_schema_sql =
+    "CREATE TABLE IF NOT EXISTS recurring_postings ("
+    "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+    "fingerprint INTEGER NOT NULL UNIQUE);";
+
+// All fingerprints seen so far, so checking a row never needs a query
+static FingerprintSet known = {0};
+static pthread_mutex_t known_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Function to compute the 64-bit FNV-1a fingerprint of a transaction. A NULL or empty
+// currency is the base currency and adds nothing, so base rows keep their fingerprints.
+uint64_t transactionFingerprint(char kind, const char *date, double amount, const char *label, const char *currency) {
+    uint64_t hash = 14695981039346656037ULL;
+    int64_t cents = (int64_t)(amount * 100 + (amount < 0 ? -0.5 : 0.5));   // Rounded to whole cents
+
+    hash = (hash ^ (unsigned char)kind) * 1099511628211ULL;
+    for (const char *c = date; c != NULL && *c; c++) {
+        hash = (hash ^ (unsigned char)*c) * 1099511628211ULL;
+    }
+    hash = (hash ^ '|') * 1099511628211ULL;
+    for (int i = 0; i < 8; i++) {
+        hash = (hash ^ (uint8_t)(cents >> (i * 8))) * 1099511628211ULL;
+    }
+    for (const char *c = label; c != NULL && *c; c++) {
+        hash = (hash ^ (unsigned char)tolower((unsigned char)*c)) * 1099511628211ULL;
+    }
+    if (currency != NULL && currency[0] != '\0') {
+        hash = (hash ^ '|') * 1099511628211ULL;
+        for (const char *c = currency; *c; c++) {
+            hash = (hash ^ (unsigned char)toupper((unsigned char)*c)) * 1099511628211ULL;
+        }
+    }
+    return hash ? hash : 1;   // 0 marks an empty slot
+}
+
+// Function to fingerprint a recurring posting. The entry id is folded in, so entries that share
+// an amount and description are told apart.
+uint64_t postingFingerprint(char kind, const char *month, int64_t entry_id, double amount, const char *description) {
+    uint64_t hash = transactionFingerprint(kind, month, amount, description, NULL);
+
+    hash = (hash ^ '#') * 1099511628211ULL;
+    for (int i = 0; i < 8; i++) {
+        hash = (hash ^ (uint8_t)(entry_id >> (i * 8))) * 1099511628211ULL;
+    }
+    return hash ? hash : 1;   // 0 marks an empty slot
+}
+
+static void growFingerprintSet(FingerprintSet *set) {
+    FingerprintSet grown = { .capacity = set->capacity ? set->capacity * 2 : 1024 };
+    grown.slots = calloc(grown.capacity, sizeof(uint64_t));
+
+    for (size_t i = 0; i < set->capacity; i++) {
+        if (set->slots[i] != 0) {
+            fingerprintSetAdd(&grown, set->slots[i]);
+        }
+    }
+    free(set->slots);
+    *set = grown;
+}
+
+// Function to add a fingerprint; returns 0 if it was already there
+int fingerprintSetAdd(FingerprintSet *set, uint64_t fingerprint) {
+    if ((set->count + 1) * 10 > set->capacity * 7) {
+        growFingerprintSet(set);
+    }
+    size_t mask = set->capacity - 1;
+    for (size_t i = fingerprint & mask;; i = (i + 1) & mask) {
+        if (set->slots[i] == fingerprint) {
+            return 0;
+        }
+        if (set->slots[i] == 0) {
+            set->slots[i] = fingerprint;
+            set->count++;
+            return 1;
+        }
+    }
+}
+
+int fingerprintSetContains(const FingerprintSet *set, uint64_t fingerprint) {
+    if (set->capacity == 0) {
+        return 0;
+    }
+    size_t mask = set->capacity - 1;
+    for (size_t i = fingerprint & mask; set->slots[i] != 0; i = (i + 1) & mask) {
+        if (set->slots[i] == fingerprint) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void fingerprintSetFree(FingerprintSet *set) {
+    free(set->slots);
+    memset(set, 0, sizeof(FingerprintSet));
+}
+
+// Fingerprint the rows of one table added after *last_id and advance *last_id
+static int catchUpFingerprints(sqlite3 *db, const char *select_sql, char kind, int has_category,
+                               sqlite3_stmt *insert, int64_t *last_id) {
+    int currency_column = has_category ? 4 : 3;
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, select_sql, -1, &stmt, NULL) != SQLITE_OK) {
+        return 0;
+    }
+    sqlite3_bind_int64(stmt, 1, *last_id);
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        *last_id = sqlite3_column_int64(stmt, 0);
+        uint64_t fingerprint = transactionFingerprint(kind, (const char *)sqlite3_column_text(stmt, 2),
+                                                      sqlite3_column_double(stmt, 1),
+                                                      has_category ? (const char *)sqlite3_column_text(stmt, 3) : NULL,
+                                                      (const char *)sqlite3_column_text(stmt, currency_column));
+        sqlite3_bind_int64(insert, 1, (int64_t)fingerprint);
+        sqlite3_step(insert);
+        sqlite3_reset(insert);
+    }
+    sqlite3_finalize(stmt);
+    return 1;
+}
+
+static int tableExists(sqlite3 *db, const char *name) {
+    sqlite3_stmt *stmt;
+    int exists = 0;
+    if (sqlite3_prepare_v2(db, "SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = ?;", -1, &stmt,
+                           NULL) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, name, -1, SQLITE_STATIC);
+        exists = (sqlite3_step(stmt) == SQLITE_ROW);
+    }
+    sqlite3_finalize(stmt);
+    return exists;
+}
+
+// Add the fingerprint of every income and expense row in the ledger to set, as version 1
+// computed them, without the currency
+static void addRowFingerprints(sqlite3 *db, FingerprintSet *set) {
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, "SELECT amount, date FROM income;", -1, &stmt, NULL) == SQLITE_OK) {
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            fingerprintSetAdd(set, transactionFingerprint(FINGERPRINT_INCOME, (const char *)sqlite3_column_text(stmt, 1),
+                                                          sqlite3_column_double(stmt, 0), NULL, NULL));
+        }
+    }
+    sqlite3_finalize(stmt);
+    if (sqlite3_prepare_v2(db, "SELECT amount, date, category FROM expenses;", -1, &stmt, NULL) == SQLITE_OK) {
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            fingerprintSetAdd(set, transactionFingerprint(FINGERPRINT_EXPENSE, (const char *)sqlite3_column_text(stmt, 1),
+                                                          sqlite3_column_double(stmt, 0),
+                                                          (const char *)sqlite3_column_text(stmt, 2), NULL));
+        }
+    }
+    sqlite3_finalize(stmt);
+}
+
+// Function to create the recurring posting table. Call before initializeBackupTracking, which
+// puts change-log triggers on it. Ledgers from before the table existed kept their posting
+// fingerprints in transaction_fingerprints: every fingerprint there that no current row
+// produces is moved over, so backups include them.
+int initializePostingTable(sqlite3 *db) {
+    int migrate = !tableExists(db, "recurring_postings") && tableExists(db, "transaction_fingerprints");
+    char *err_msg = NULL;
+
+    if (sqlite3_exec(db, "BEGIN;", 0, 0, &err_msg) != SQLITE_OK ||
+        sqlite3_exec(db, posting_schema_sql, 0, 0, &err_msg) != SQLITE_OK) {
+        printf("Error: Failed to create recurring posting table: %s\n", err_msg);
+        sqlite3_free(err_msg);
+        sqlite3_exec(db, "ROLLBACK;", 0, 0, NULL);
+        return 0;
+    }
+
+    int ok = 1;
+    if (migrate) {
+        FingerprintSet rows = {0};
+        sqlite3_stmt *stmt, *insert = NULL;
+        addRowFingerprints(db, &rows);
+        ok = sqlite3_prepare_v2(db, "SELECT fingerprint FROM transaction_fingerprints;", -1, &stmt, NULL) == SQLITE_OK &&
+             sqlite3_prepare_v2(db, "INSERT OR IGNORE INTO recurring_postings (fingerprint) VALUES (?);", -1, &insert,
+                                NULL) == SQLITE_OK;
+        while (ok && sqlite3_step(stmt) == SQLITE_ROW) {
+            int64_t fingerprint = sqlite3_column_int64(stmt, 0);
+            if (!fingerprintSetContains(&rows, (uint64_t)fingerprint)) {
+                sqlite3_bind_int64(insert, 1, fingerprint);
+                ok = (sqlite3_step(insert) == SQLITE_DONE);
+                sqlite3_reset(insert);
+            }
+        }
+        sqlite3_finalize(stmt);
+        sqlite3_finalize(insert);
+        fingerprintSetFree(&rows);
+    }
+    if (!ok || sqlite3_exec(db, "COMMIT;", 0, 0, NULL) != SQLITE_OK) {
+        printf("Error: Failed to move recurring postings: %s\n", sqlite3_errmsg(db));
+        sqlite3_exec(db, "ROLLBACK;", 0, 0, NULL);
+        return 0;
+    }
+    return 1;
+}
+
+// Function to create the fingerprint table, fingerprint rows added since the last run and
+// load every fingerprint into memory; call after the journal has been replayed
+int initializeFingerprints(sqlite3 *db) {
+    sqlite3_stmt *stmt, *insert = NULL;
+    int64_t last_income_id = 0, last_expense_id = 0;
+    char *err_msg = NULL;
+
+    if (sqlite3_exec(db, "BEGIN;", 0, 0, &err_msg) != SQLITE_OK ||
+        sqlite3_exec(db, fingerprint_schema_sql, 0, 0, &err_msg) != SQLITE_OK) {
+        printf("Error: Failed to create fingerprint table: %s\n", err_msg);
+        sqlite3_free(err_msg);
+        sqlite3_exec(db, "ROLLBACK;", 0, 0, NULL);
+        return 0;
+    }
+
+    // Ledgers from before versioning have no version column and hold version 1 fingerprints
+    int has_version = 0;
+    if (sqlite3_prepare_v2(db, "SELECT 1 FROM pragma_table_info('fingerprint_state') WHERE name = 'version';", -1,
+                           &stmt, NULL) == SQLITE_OK) {
+        has_version = (sqlite3_step(stmt) == SQLITE_ROW);
+    }
+    sqlite3_finalize(stmt);
+    int ok = has_version ||
+             sqlite3_exec(db, "ALTER TABLE fingerprint_state ADD COLUMN version INTEGER NOT NULL DEFAULT 1;", 0, 0,
+                          NULL) == SQLITE_OK;
+    if (ok && sqlite3_prepare_v2(db, "INSERT OR IGNORE INTO fingerprint_state (id, last_income_id, last_expense_id, "
+                                     "version) VALUES (1, 0, 0, ?);", -1, &stmt, NULL) == SQLITE_OK) {
+        sqlite3_bind_int(stmt, 1, FINGERPRINT_VERSION);
+        ok = (sqlite3_step(stmt) == SQLITE_DONE);
+    }
+    sqlite3_finalize(stmt);
+
+    int version = FINGERPRINT_VERSION;
+    if (ok && sqlite3_prepare_v2(db, "SELECT last_income_id, last_expense_id, version FROM fingerprint_state WHERE id = 1;",
+                                 -1, &stmt, NULL) == SQLITE_OK && sqlite3_step(stmt) == SQLITE_ROW) {
+        last_income_id = sqlite3_column_int64(stmt, 0);
+        last_expense_id = sqlite3_column_int64(stmt, 1);
+        version = sqlite3_column_int(stmt, 2);
+    }
+    sqlite3_finalize(stmt);
+    if (ok && version != FINGERPRINT_VERSION) {
+        last_income_id = last_expense_id = 0;
+        ok = sqlite3_exec(db, "DELETE FROM transaction_fingerprints;", 0, 0, NULL) == SQLITE_OK;
+    }
+
+    ok = ok &&
+         sqlite3_prepare_v2(db, "INSERT OR IGNORE INTO transaction_fingerprints (fingerprint) VALUES (?);", -1,
+                            &insert, NULL) == SQLITE_OK &&
+         catchUpFingerprints(db, "SELECT id, amount, date, currency FROM income WHERE id > ? ORDER BY id;",
+                             FINGERPRINT_INCOME, 0, insert, &last_income_id) &&
+         catchUpFingerprints(db, "SELECT id, amount, date, category, currency FROM expenses WHERE id > ? ORDER BY id;",
+                             FINGERPRINT_EXPENSE, 1, insert, &last_expense_id);
+    sqlite3_finalize(insert);
+
+    if (ok && sqlite3_prepare_v2(db, "UPDATE fingerprint_state SET last_income_id = ?, last_expense_id = ?, "
+                                     "version = ? WHERE id = 1;", -1, &stmt, NULL) == SQLITE_OK) {
+        sqlite3_bind_int64(stmt, 1, last_income_id);
+        sqlite3_bind_int64(stmt, 2, last_expense_id);
+        sqlite3_bind_int(stmt, 3, FINGERPRINT_VERSION);
+        ok = (sqlite3_step(stmt) == SQLITE_DONE);
+        sqlite3_finalize(stmt);
+    }
+    if (!ok || sqlite3_exec(db, "COMMIT;", 0, 0, NULL) != SQLITE_OK) {
+        printf("Error: Failed to update fingerprints: %s\n", sqlite3_errmsg(db));
+        sqlite3_exec(db, "ROLLBACK;", 0, 0, NULL);
+        return 0;
+    }
+
+    pthread_mutex_lock(&known_lock);
+    fingerprintSetFree(&known);
+    if (sqlite3_prepare_v2(db, "SELECT fingerprint FROM transaction_fingerprints "
+                               "UNION ALL SELECT fingerprint FROM recurring_postings;", -1, &stmt, NULL) == SQLITE_OK) {
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            fingerprintSetAdd(&known, (uint64_t)sqlite3_column_int64(stmt, 0));
+        }
+    }
+    sqlite3_finalize(stmt);
+    pthread_mutex_unlock(&known_lock);
+    return 1;
+}
+
+// Function to check whether a fingerprint has been seen before
+int fingerprintSeen(uint64_t fingerprint) {
+    pthread_mutex_lock(&known_lock);
+    int seen = fingerprintSetContains(&known, fingerprint);
+    pthread_mutex_unlock(&known_lock);
+    return seen;
+}
+
+// Function to note a fingerprint in memory; the table catches up when the ledger is next opened
+void rememberFingerprint(uint64_t fingerprint) {
+    pthread_mutex_lock(&known_lock);
+    fingerprintSetAdd(&known, fingerprint);
+    pthread_mutex_unlock(&known_lock);
+}
+
+// Function to record a recurring posting. Call inside the transaction that writes the posted
+// row, so both are kept or neither is, and remember the fingerprint once the write succeeds.
+int recordRecurringPosting(sqlite3 *db, uint64_t fingerprint) {
+    sqlite3_stmt *stmt;
+    int ok = 0;
+
+    if (sqlite3_prepare_v2(db, "INSERT OR IGNORE INTO recurring_postings (fingerprint) VALUES (?);", -1,
+                           &stmt, NULL) == SQLITE_OK) {
+        sqlite3_bind_int64(stmt, 1, (int64_t)fingerprint);
+        ok = (sqlite3_step(stmt) == SQLITE_DONE);
+    }
+    sqlite3_finalize(stmt);
+    return ok;
+}
@@ -0,0 +1,365 @@
+#define _XOPEN_SOURCE 700
+#include "forecast.h"
+#include "currency.h"
+#include "utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sqlite3.h>
+
+// Convert a YYYY-MM-DD date into a month index (year * 12 + month - 1)
+static int monthIndexFromDate(const char *date) {
+    int year, month;
+    if (date == NULL || sscanf(date, "%d-%d", &year, &month) != 2 || month < 1 || month > 12) {
+        return -1;
+    }
+    return year * 12 + month - 1;
+}
+
+// Function to load recurring entries and historical spending into a forecast model
+int loadForecastModel(sqlite3 *db, ForecastModel *model) {
+    memset(model, 0, sizeof(*model));
+
+    time_t t = time(NULL);
+    struct tm *current_time = localtime(&t);
+    int current_index = (current_time->tm_year + 1900) * 12 + current_time->tm_mon;
+    int start_index = current_index + 1;  // The current month has already been posted
+    model->start_year = start_index / 12;
+    model->start_month = start_index % 12 + 1;
+
+    // Opening balance is everything earned minus everything spent so far, in the base currency
+    const char *balance_sql =
+        "SELECT (SELECT IFNULL(SUM(to_base(amount, currency, date)), 0) FROM income) "
+        "- (SELECT IFNULL(SUM(to_base(amount, currency, date)), 0) FROM expenses) "
+        "+ (SELECT IFNULL(SUM(income_total - expense_total), 0) FROM archives), "
+        "(SELECT MIN(date) FROM expenses);";
+    sqlite3_stmt *stmt;
+    int history_months = 1;
+    if (sqlite3_prepare_v2(db, balance_sql, -1, &stmt, NULL) != SQLITE_OK) {
+        printf("SQLite Error: %s\n", sqlite3_errmsg(db));
+        return 0;
+    }
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        model->opening_balance = sqlite3_column_double(stmt, 0);
+        int first_index = monthIndexFromDate((const char *)sqlite3_column_text(stmt, 1));
+        if (first_index >= 0 && first_index <= current_index) {
+            history_months = current_index - first_index + 1;
+        }
+    }
+    sqlite3_finalize(stmt);
+
+    // Recurring entries, with their start dates turned into forecast month offsets
+    const char *recurring_sql = "SELECT id, type, description, amount, date FROM recurring ORDER BY id ASC;";
+    if (sqlite3_prepare_v2(db, recurring_sql, -1, &stmt, NULL) != SQLITE_OK) {
+        printf("SQLite Error: %s\n", sqlite3_errmsg(db));
+        return 0;
+    }
+    int capacity = 0;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        if (model->entry_count == capacity) {
+            capacity = capacity ? capacity * 2 : 16;
+            model->entries = realloc(model->entries, capacity * sizeof(ForecastEntry));
+        }
+        ForecastEntry *entry = &model->entries[model->entry_count++];
+        const char *type = (const char *)sqlite3_column_text(stmt, 1);
+        const char *description = (const char *)sqlite3_column_text(stmt, 2);
+        double amount = sqlite3_column_double(stmt, 3);
+        int entry_index = monthIndexFromDate((const char *)sqlite3_column_text(stmt, 4));
+
+        entry->id = sqlite3_column_int(stmt, 0);
+        snprintf(entry->description, sizeof(entry->description), "%s", description ? description : "");
+        entry->amount = (type && strcmp(type, "income") == 0) ? amount : -amount;
+        entry->start_offset = (entry_index > start_index) ? entry_index - start_index : 0;
+    }
+    sqlite3_finalize(stmt);
+
+    // Per-category monthly spending rate, excluding categories already posted by recurring expenses
+    const char *category_sql =
+        "SELECT category, IFNULL(SUM(to_base(amount, currency, date)), 0) FROM expenses "
+        "WHERE category NOT IN (SELECT description FROM recurring WHERE type = 'expense') "
+        "GROUP BY category;";
+    if (sqlite3_prepare_v2(db, category_sql, -1, &stmt, NULL) != SQLITE_OK) {
+        printf("SQLite Error: %s\n", sqlite3_errmsg(db));
+        return 0;
+    }
+    capacity = 0;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        if (model->category_count == capacity) {
+            capacity = capacity ? capacity * 2 : 16;
+            model->categories = realloc(model->categories, capacity * sizeof(ForecastCategory));
+        }
+        ForecastCategory *category = &model->categories[model->category_count++];
+        const char *name = (const char *)sqlite3_column_text(stmt, 0);
+        snprintf(category->name, sizeof(category->name), "%s", name ? name : "");
+        category->monthly_rate = sqlite3_column_double(stmt, 1) / history_months;
+    }
+    sqlite3_finalize(stmt);
+    reportMissingRates();
+
+    return 1;
+}
+
+// Function to release memory owned by a forecast model
+void freeForecastModel(ForecastModel *model) {
+    free(model->entries);
+    free(model->categories);
+    memset(model, 0, sizeof(*model));
+}
+
+// Function to project the end-of-month balance for each month of the horizon
+void projectBalances(const ForecastModel *model, int months, double *balances) {
+    double discretionary = 0;
+    for (int i = 0; i < model->category_count; i++) {
+        discretionary += model->categories[i].monthly_rate;
+    }
+
+    double balance = model->opening_balance;
+    for (int m = 0; m < months; m++) {
+        balance -= discretionary;
+        for (int i = 0; i < model->entry_count; i++) {
+            if (m >= model->entries[i].start_offset) {
+                balance += model->entries[i].amount;
+            }
+        }
+        balances[m] = balance;
+    }
+}
+
+// How much a single scenario change moves the balance in month m
+static double scenarioDelta(const ForecastModel *model, const ScenarioChange *change, int m) {
+    switch (change->action) {
+        case SCENARIO_REMOVE_ENTRY: {
+            const ForecastEntry *entry = &model->entries[change->index];
+            return (m >= entry->start_offset) ? -entry->amount : 0;
+        }
+        case SCENARIO_ADD_ENTRY:
+            return (m >= change->entry.start_offset) ? change->entry.amount : 0;
+        case SCENARIO_SCALE_CATEGORY:
+            return -(change->factor - 1.0) * model->categories[change->index].monthly_rate;
+    }
+    return 0;
+}
+
+typedef struct {
+    const ForecastModel *model;
+    const double *base;
+    int months;
+    ForecastScenario *scenarios;
+    int count;
+    int started;
+} ScenarioWork;
+
+// Worker thread: evaluate a contiguous slice of scenarios against the shared base projection
+static void *scenarioWorker(void *arg) {
+    ScenarioWork *work = arg;
+
+    for (int s = 0; s < work->count; s++) {
+        ForecastScenario *scenario = &work->scenarios[s];
+        double adjustment = 0;
+
+        scenario->lowest_balance = 0;
+        scenario->lowest_month = -1;
+        for (int m = 0; m < work->months; m++) {
+            for (int c = 0; c < scenario->change_count; c++) {
+                adjustment += scenarioDelta(work->model, &scenario->changes[c], m);
+            }
+            double balance = work->base[m] + adjustment;
+            if (scenario->lowest_month < 0 || balance < scenario->lowest_balance) {
+                scenario->lowest_balance = balance;
+                scenario->lowest_month = m;
+            }
+        }
+        scenario->final_balance = (work->months > 0) ? work->base[work->months - 1] + adjustment : work->model->opening_balance;
+    }
+    return NULL;
+}
+
+// Function to evaluate what-if scenarios in parallel across the available cores
+void evaluateScenarios(const ForecastModel *model, int months, ForecastScenario *scenarios, int count) {
+    if (count <= 0) {
+        return;
+    }
+
+    double *base = malloc((months > 0 ? months : 1) * sizeof(double));
+    projectBalances(model, months, base);
+
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    int thread_count = (cores > 0) ? (int)cores : 1;
+    if (thread_count > count) {
+        thread_count = count;
+    }
+
+    pthread_t *threads = malloc(thread_count * sizeof(pthread_t));
+    ScenarioWork *work = malloc(thread_count * sizeof(ScenarioWork));
+    int per_thread = count / thread_count;
+    int remainder = count % thread_count;
+    int offset = 0;
+
+    for (int i = 0; i < thread_count; i++) {
+        work[i].model = model;
+        work[i].base = base;
+        work[i].months = months;
+        work[i].scenarios = scenarios + offset;
+        work[i].count = per_thread + (i < remainder ? 1 : 0);
+        offset += work[i].count;
+
+        work[i].started = (pthread_create(&threads[i], NULL, scenarioWorker, &work[i]) == 0);
+        if (!work[i].started) {
+            scenarioWorker(&work[i]);  // Fall back to evaluating this slice inline
+        }
+    }
+    for (int i = 0; i < thread_count; i++) {
+        if (work[i].started) {
+            pthread_join(threads[i], NULL);
+        }
+    }
+
+    free(work);
+    free(threads);
+    free(base);
+}
+
+// Ask for a forecast horizon in months
+static int promptForecastMonths() {
+    printf("Enter number of months to forecast (1-%d): ", FORECAST_MAX_MONTHS);
+    int months = getValidIntInput();
+    if (months < 1) {
+        months = 1;
+    } else if (months > FORECAST_MAX_MONTHS) {
+        months = FORECAST_MAX_MONTHS;
+    }
+    return months;
+}
+
+// Function to display the projected balance for the next N months
+void showForecast(sqlite3 *db) {
+    ForecastModel model;
+    if (!loadForecastModel(db, &model)) {
+        return;
+    }
+
+    int months = promptForecastMonths();
+    double *balances = malloc(months * sizeof(double));
+    projectBalances(&model, months, balances);
+
+    printf("\n=== Balance Forecast ===\n");
+    printf("Opening Balance: $%.2f\n", model.opening_balance);
+
+    printf("\nRecurring Entries:\n");
+    for (int i = 0; i < model.entry_count; i++) {
+        printf(" - %s: %s$%.2f/month from month %d\n", model.entries[i].description,
+               model.entries[i].amount < 0 ? "-" : "+",
+               model.entries[i].amount < 0 ? -model.entries[i].amount : model.entries[i].amount,
+               model.entries[i].start_offset + 1);
+    }
+
+    printf("\nHistorical Spending Rates:\n");
+    for (int i = 0; i < model.category_count; i++) {
+        printf(" - %s: $%.2f/month\n", model.categories[i].name, model.categories[i].monthly_rate);
+    }
+
+    printf("\nProjected End-of-Month Balance:\n");
+    for (int m = 0; m < months; m++) {
+        int index = model.start_year * 12 + model.start_month - 1 + m;
+        printf(" %04d-%02d: $%.2f\n", index / 12, index % 12 + 1, balances[m]);
+    }
+
+    free(balances);
+    freeForecastModel(&model);
+}
+
+static int compareScenarios(const void *a, const void *b) {
+    const ForecastScenario *sa = a, *sb = b;
+    if (sa->final_balance < sb->final_balance) return 1;
+    if (sa->final_balance > sb->final_balance) return -1;
+    return 0;
+}
+
+// Function to compare what-if scenarios built from the current recurring entries and categories
+void showWhatIfForecast(sqlite3 *db) {
+    static const double category_factors[] = {0.75, 0.5};
+    const int factor_count = sizeof(category_factors) / sizeof(category_factors[0]);
+
+    ForecastModel model;
+    if (!loadForecastModel(db, &model)) {
+        return;
+    }
+
+    int months = promptForecastMonths();
+
+    // Optionally try out a recurring entry that doesn't exist yet
+    ForecastEntry added = {0};
+    printf("Add a hypothetical recurring entry? (1 = Yes, 0 = No): ");
+    int add_entry = getValidIntInput() == 1;
+    if (add_entry) {
+        printf("Type (1 = Income, 2 = Expense): ");
+        int income = getValidIntInput() == 1;
+        printf("Enter description: ");
+        getValidStringInput(added.description, MAX_NAME_LENGTH);
+        printf("Enter monthly amount: $");
+        added.amount = income ? getValidFloatInput() : -getValidFloatInput();
+        printf("Starting in forecast month (1-%d): ", months);
+        int start_month = getValidIntInput();
+        added.start_offset = (start_month < 1) ? 0 : (start_month > months ? months - 1 : start_month - 1);
+    }
+
+    // One scenario per removed recurring entry and per category spending cut, plus the baseline
+    // and the hypothetical entry
+    int count = 1 + add_entry + model.entry_count + model.category_count * factor_count;
+    ForecastScenario *scenarios = calloc(count, sizeof(ForecastScenario));
+    ScenarioChange *changes = calloc(count, sizeof(ScenarioChange));
+    int n = 0;
+
+    snprintf(scenarios[n].label, sizeof(scenarios[n].label), "Baseline");
+    n++;
+    if (add_entry) {
+        changes[n].action = SCENARIO_ADD_ENTRY;
+        changes[n].entry = added;
+        scenarios[n].changes = &changes[n];
+        scenarios[n].change_count = 1;
+        snprintf(scenarios[n].label, sizeof(scenarios[n].label), "With %s (%s$%.2f/month from month %d)",
+                 added.description, added.amount < 0 ? "-" : "+", added.amount < 0 ? -added.amount : added.amount,
+                 added.start_offset + 1);
+        n++;
+    }
+    for (int i = 0; i < model.entry_count; i++, n++) {
+        changes[n].action = SCENARIO_REMOVE_ENTRY;
+        changes[n].index = i;
+        scenarios[n].changes = &changes[n];
+        scenarios[n].change_count = 1;
+        snprintf(scenarios[n].label, sizeof(scenarios[n].label), "Without %s", model.entries[i].description);
+    }
+    for (int i = 0; i < model.category_count; i++) {
+        for (int f = 0; f < factor_count; f++, n++) {
+            changes[n].action = SCENARIO_SCALE_CATEGORY;
+            changes[n].index = i;
+            changes[n].factor = category_factors[f];
+            scenarios[n].changes = &changes[n];
+            scenarios[n].change_count = 1;
+            snprintf(scenarios[n].label, sizeof(scenarios[n].label), "%s cut by %.0f%%",
+                     model.categories[i].name, (1.0 - category_factors[f]) * 100);
+        }
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    evaluateScenarios(&model, months, scenarios, count);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double elapsed_ms = (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1e6;
+
+    qsort(scenarios, count, sizeof(ForecastScenario), compareScenarios);
+
+    printf("\n=== What-If Forecast (%d months) ===\n", months);
+    for (int i = 0; i < count; i++) {
+        printf(" - %s: Final $%.2f, Lowest $%.2f (month %d)\n", scenarios[i].label,
+               scenarios[i].final_balance, scenarios[i].lowest_balance, scenarios[i].lowest_month + 1);
+    }
+    printf("Evaluated %d scenarios in %.2f ms.\n", count, elapsed_ms);
+
+    free(changes);
+    free(scenarios);
+    freeForecastModel(&model);
+}
@@ -0,0 +1,218 @@
+#define _XOPEN_SOURCE 700
+#include "history.h"
+#include "archive.h"
+#include "currency.h"
+#include "utils.h"
+#include <stdio.h>
+#include <sqlite3.h>
+
+// Every write to recurring or savings_goals closes the open version of that row (valid_to)
+// and appends the new one; deletes append a zero-length 'delete' version as a tombstone.
+// The live tables are untouched, so everyday reads never see the history.
+#define HISTORY_NOW "strftime('%Y-%m-%d %H:%M:%f', 'now', 'localtime')"
+
+// A version is visible at the end of day ?1 if it started before the next day began and
+// was still open at that point
+#define HISTORY_VISIBLE "change != 'delete' AND valid_from < date(?1, '+1 day') " \
+                        "AND (valid_to IS NULL OR valid_to >= date(?1, '+1 day'))"
+
+static const char *history_schema_sql =
+    "CREATE TABLE IF NOT EXISTS recurring_history ("
+    "version_id INTEGER PRIMARY KEY AUTOINCREMENT, "
+    "entry_id INTEGER NOT NULL, "
+    "type TEXT, "
+    "description TEXT, "
+    "amount REAL, "
+    "date TEXT, "
+    "change TEXT NOT NULL, "
+    "valid_from TEXT NOT NULL, "
+    "valid_to TEXT);"
+    "CREATE TABLE IF NOT EXISTS savings_goals_history ("
+    "version_id INTEGER PRIMARY KEY AUTOINCREMENT, "
+    "goal_id INTEGER NOT NULL, "
+    "name TEXT, "
+    "target_amount REAL, "
+    "saved_amount REAL, "
+    "due_date TEXT, "
+    "change TEXT NOT NULL, "
+    "valid_from TEXT NOT NULL, "
+    "valid_to TEXT);"
+
+    // Only open versions are indexed by row id, so closing one stays cheap as history grows
+    "CREATE INDEX IF NOT EXISTS idx_recurring_history_open ON recurring_history(entry_id) WHERE valid_to IS NULL;"
+    "CREATE INDEX IF NOT EXISTS idx_savings_goals_history_open ON savings_goals_history(goal_id) WHERE valid_to IS NULL;"
+    "CREATE INDEX IF NOT EXISTS idx_recurring_history_valid ON recurring_history(valid_from);"
+    "CREATE INDEX IF NOT EXISTS idx_savings_goals_history_valid ON savings_goals_history(valid_from);";
+
+static const char *history_triggers_sql =
+    "CREATE TRIGGER IF NOT EXISTS recurring_history_ai AFTER INSERT ON recurring BEGIN "
+    "INSERT INTO recurring_history (entry_id, type, description, amount, date, change, valid_from) "
+    "VALUES (new.id, new.type, new.description, new.amount, new.date, 'insert', " HISTORY_NOW "); "
+    "END;"
+    "CREATE TRIGGER IF NOT EXISTS recurring_history_au AFTER UPDATE ON recurring BEGIN "
+    "UPDATE recurring_history SET valid_to = " HISTORY_NOW " WHERE entry_id = old.id AND valid_to IS NULL; "
+    "INSERT INTO recurring_history (entry_id, type, description, amount, date, change, valid_from) "
+    "VALUES (new.id, new.type, new.description, new.amount, new.date, 'update', " HISTORY_NOW "); "
+    "END;"
+    "CREATE TRIGGER IF NOT EXISTS recurring_history_ad AFTER DELETE ON recurring BEGIN "
+    "UPDATE recurring_history SET valid_to = " HISTORY_NOW " WHERE entry_id = old.id AND valid_to IS NULL; "
+    "INSERT INTO recurring_history (entry_id, type, description, amount, date, change, valid_from, valid_to) "
+    "VALUES (old.id, old.type, old.description, old.amount, old.date, 'delete', " HISTORY_NOW ", " HISTORY_NOW "); "
+    "END;"
+
+    "CREATE TRIGGER IF NOT EXISTS savings_goals_history_ai AFTER INSERT ON savings_goals BEGIN "
+    "INSERT INTO savings_goals_history (goal_id, name, target_amount, saved_amount, due_date, change, valid_from) "
+    "VALUES (new.id, new.name, new.target_amount, new.saved_amount, new.due_date, 'insert', " HISTORY_NOW "); "
+    "END;"
+    "CREATE TRIGGER IF NOT EXISTS savings_goals_history_au AFTER UPDATE ON savings_goals BEGIN "
+    "UPDATE savings_goals_history SET valid_to = " HISTORY_NOW " WHERE goal_id = old.id AND valid_to IS NULL; "
+    "INSERT INTO savings_goals_history (goal_id, name, target_amount, saved_amount, due_date, change, valid_from) "
+    "VALUES (new.id, new.name, new.target_amount, new.saved_amount, new.due_date, 'update', " HISTORY_NOW "); "
+    "END;"
+    "CREATE TRIGGER IF NOT EXISTS savings_goals_history_ad AFTER DELETE ON savings_goals BEGIN "
+    "UPDATE savings_goals_history SET valid_to = " HISTORY_NOW " WHERE goal_id = old.id AND valid_to IS NULL; "
+    "INSERT INTO savings_goals_history (goal_id, name, target_amount, saved_amount, due_date, change, valid_from, valid_to) "
+    "VALUES (old.id, old.name, old.target_amount, old.saved_amount, old.due_date, 'delete', " HISTORY_NOW ", " HISTORY_NOW "); "
+    "END;";
+
+// Rows that predate the history tables get an open 'baseline' version valid since forever
+static const char *history_backfill_sql =
+    "INSERT INTO recurring_history (entry_id, type, description, amount, date, change, valid_from) "
+    "SELECT id, type, description, amount, date, 'baseline', '0000-01-01' FROM recurring;"
+    "INSERT INTO savings_goals_history (goal_id, name, target_amount, saved_amount, due_date, change, valid_from) "
+    "SELECT id, name, target_amount, saved_amount, due_date, 'baseline', '0000-01-01' FROM savings_goals;";
+
+// Function to create the history tables and the triggers that feed them
+int initializeHistory(sqlite3 *db) {
+    sqlite3_stmt *stmt;
+    int exists = 0;
+
+    const char *exists_sql = "SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'recurring_history';";
+    if (sqlite3_prepare_v2(db, exists_sql, -1, &stmt, NULL) == SQLITE_OK) {
+        exists = (sqlite3_step(stmt) == SQLITE_ROW);
+    }
+    sqlite3_finalize(stmt);
+
+    char *err_msg = NULL;
+    if (sqlite3_exec(db, "BEGIN;", 0, 0, &err_msg) != SQLITE_OK ||
+        sqlite3_exec(db, history_schema_sql, 0, 0, &err_msg) != SQLITE_OK ||
+        (!exists && sqlite3_exec(db, history_backfill_sql, 0, 0, &err_msg) != SQLITE_OK) ||
+        sqlite3_exec(db, history_triggers_sql, 0, 0, &err_msg) != SQLITE_OK ||
+        sqlite3_exec(db, "COMMIT;", 0, 0, &err_msg) != SQLITE_OK) {
+        printf("Error: Failed to create history tables: %s\n", err_msg);
+        sqlite3_free(err_msg);
+        sqlite3_exec(db, "ROLLBACK;", 0, 0, NULL);
+        return 0;
+    }
+    return 1;
+}
+
+// Function to show the analytics as they stood at the end of a given day (YYYY-MM-DD).
+// Income and expenses are totalled up to that day across the ledger and its archives, as in
+// the date range report; recurring entries and goals come from the version that was valid at
+// that moment.
+void showAnalyticsAsOf(sqlite3 *db, const char *as_of) {
+    RangeTotals totals;
+    collectRangeTotals(db, "", as_of, &totals);
+
+    printf("\n=== Budget Analytics as of %s ===\n", as_of);
+    printf("Total Income: $%.2f\n", totals.income);
+    printf("Total Expenses: $%.2f\n", totals.expenses);
+
+    printf("\nExpense Breakdown by Category:\n");
+    showRangeCategories(db);
+
+    sqlite3_stmt *stmt;
+    printf("\nRecurring Entries:\n");
+    const char *recurring_sql = "SELECT entry_id, type, description, amount FROM recurring_history "
+                                "WHERE " HISTORY_VISIBLE " AND date <= ?1 ORDER BY entry_id;";
+    double recurring_expenses = 0;
+    int found = 0;
+    if (sqlite3_prepare_v2(db, recurring_sql, -1, &stmt, NULL) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, as_of, -1, SQLITE_STATIC);
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            const char *type = (const char *)sqlite3_column_text(stmt, 1);
+            double amount = sqlite3_column_double(stmt, 3);
+            printf(" - [%d] %s - %s: $%.2f\n", sqlite3_column_int(stmt, 0), type,
+                   sqlite3_column_text(stmt, 2), amount);
+            if (type != NULL && type[0] == 'e') {
+                recurring_expenses += amount;
+            }
+            found = 1;
+        }
+    }
+    sqlite3_finalize(stmt);
+    if (!found) {
+        printf(" (none)\n");
+    }
+    printf("Total Recurring Expenses: $%.2f\n", recurring_expenses);
+
+    printf("\nSavings Goals Progress:\n");
+    const char *savings_sql = "SELECT name, target_amount, saved_amount FROM savings_goals_history "
+                              "WHERE " HISTORY_VISIBLE " ORDER BY goal_id;";
+    found = 0;
+    if (sqlite3_prepare_v2(db, savings_sql, -1, &stmt, NULL) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, as_of, -1, SQLITE_STATIC);
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            double target_amount = sqlite3_column_double(stmt, 1);
+            double saved_amount = sqlite3_column_double(stmt, 2);
+            printf(" - %s: $%.2f / $%.2f (%.2f%% complete)\n", sqlite3_column_text(stmt, 0),
+                   saved_amount, target_amount, target_amount > 0 ? saved_amount / target_amount * 100 : 0);
+            found = 1;
+        }
+    }
+    sqlite3_finalize(stmt);
+    if (!found) {
+        printf(" (none)\n");
+    }
+
+    printf("\nRemaining Budget After Expenses: $%.2f\n", totals.income - (totals.expenses + recurring_expenses));
+    printf("Partitions read: %s\n", totals.partitions);
+    reportMissingRates();
+    printf("\n=== End of Analytics ===\n");
+}
+
+// Function to prompt for a date and show the point-in-time analytics
+void showPointInTimeReport(sqlite3 *db) {
+    char as_of[11];
+
+    printf("Show analytics as of (YYYY-MM-DD): ");
+    getValidDateInput(as_of, sizeof(as_of));
+    showAnalyticsAsOf(db, as_of);
+}
+
+// Function to list the most recent changes to recurring entries and savings goals
+void showChangeHistory(sqlite3 *db) {
+    const char *sql =
+        "SELECT valid_from, change, 'Recurring', entry_id, description, amount, NULL FROM recurring_history "
+        "WHERE change != 'baseline' "
+        "UNION ALL "
+        "SELECT valid_from, change, 'Goal', goal_id, name, target_amount, saved_amount FROM savings_goals_history "
+        "WHERE change != 'baseline' "
+        "ORDER BY valid_from DESC LIMIT ?;";
+    sqlite3_stmt *stmt;
+
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        printf("SQLite Error: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+    sqlite3_bind_int(stmt, 1, HISTORY_RECENT_CHANGES);
+
+    printf("\n--- Recent Changes ---\n");
+    int found = 0;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        printf("%.19s %-6s %s [%d] %s - $%.2f", sqlite3_column_text(stmt, 0), sqlite3_column_text(stmt, 1),
+               sqlite3_column_text(stmt, 2), sqlite3_column_int(stmt, 3), sqlite3_column_text(stmt, 4),
+               sqlite3_column_double(stmt, 5));
+        if (sqlite3_column_type(stmt, 6) != SQLITE_NULL) {
+            printf(" (saved $%.2f)", sqlite3_column_double(stmt, 6));
+        }
+        printf("\n");
+        found = 1;
+    }
+    sqlite3_finalize(stmt);
+
+    if (!found) {
+        printf("No changes recorded.\n");
+    }
+}
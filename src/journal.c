@@ -0,0 +1,417 @@
+#define _XOPEN_SOURCE 700
+#include "journal.h"
+#include "utils.h"
+#include "schema.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sqlite3.h>
+
+#define JOURNAL_RECORD_MAGIC 0x524A4C46u   // "FLJR"
+
+enum { JOURNAL_INCOME = 1, JOURNAL_EXPENSE = 2 };
+
+// Fixed-width journal record; the checksum covers every byte before it
+typedef struct {
+    unsigned int magic;
+    unsigned int type;
+    double amount;
+    char date[12];
+    char category[MAX_NAME_LENGTH];
+    unsigned int checksum;
+} JournalRecord;
+
+static int journal_fd = -1;
+static sqlite3 *compactor_db = NULL;
+static pthread_t compactor_thread;
+static pthread_mutex_t journal_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t journal_wake = PTHREAD_COND_INITIALIZER;
+static int stop_requested = 0;
+static off_t appended_end = 0;    // Bytes written to the journal
+static off_t synced_end = 0;      // Bytes known to be on disk
+static int unsynced_records = 0;
+static int offset_stale = 0;      // The journal was emptied but its offset reset is not committed
+
+static void buildJournalPath(const char *db_name, char *path, size_t size) {
+    snprintf(path, size, "%s.oplog", db_name);
+}
+
+// Get the journal offset up to which records are already in SQLite
+static off_t getJournalOffset(sqlite3 *db) {
+    const char *sql = "SELECT offset FROM journal_state WHERE id = 1;";
+    sqlite3_stmt *stmt;
+    off_t offset = 0;
+
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) == SQLITE_OK) {
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            offset = sqlite3_column_int64(stmt, 0);
+        }
+    }
+    sqlite3_finalize(stmt);
+    return offset;
+}
+
+static const char *set_offset_sql = SCHEMA_UPSERT_SQL(SCHEMA_JOURNAL_STATE) ";";
+
+// Store the journal offset; returns 0 if the write failed
+static int setJournalOffset(sqlite3 *db, off_t offset) {
+    sqlite3_stmt *stmt;
+    int ok = 0;
+
+    if (sqlite3_prepare_v2(db, set_offset_sql, -1, &stmt, NULL) == SQLITE_OK) {
+        JournalStateRow row = { .id = 1, .offset = offset };
+        schemaBind_journal_state(stmt, &row);
+        ok = (sqlite3_step(stmt) == SQLITE_DONE);
+    }
+    sqlite3_finalize(stmt);
+    return ok;
+}
+
+// Empty a fully compacted journal. The offset reset is written first and the file is truncated
+// only once that write succeeded, inside the same transaction: a crash before COMMIT leaves an
+// empty file behind a stale offset, which replay recognises, never records behind a zero offset.
+// Returns 1 when both took effect, 0 when neither did and -1 when the file is empty but the
+// offset could not be committed.
+static int resetJournal(sqlite3 *db, int fd) {
+    if (sqlite3_exec(db, "BEGIN IMMEDIATE;", 0, 0, NULL) != SQLITE_OK) {
+        return 0;
+    }
+    if (!setJournalOffset(db, 0) || ftruncate(fd, 0) != 0) {
+        sqlite3_exec(db, "ROLLBACK;", 0, 0, NULL);
+        return 0;
+    }
+    if (sqlite3_exec(db, "COMMIT;", 0, 0, NULL) != SQLITE_OK) {
+        printf("Error: Failed to reset the journal offset: %s\n", sqlite3_errmsg(db));
+        sqlite3_exec(db, "ROLLBACK;", 0, 0, NULL);
+        return -1;
+    }
+    return 1;
+}
+
+static int recordIsValid(const JournalRecord *record) {
+    return record->magic == JOURNAL_RECORD_MAGIC &&
+           record->checksum == computeChecksum(record, offsetof(JournalRecord, checksum), 0);
+}
+
+// Fold the records in [offset, end) into SQLite, moving the stored offset forward in the same
+// transaction so each record is applied exactly once. Returns the offset reached; *corrupt is set
+// when compaction stopped at a torn or damaged record rather than at end or on a database error.
+static off_t compactJournal(sqlite3 *db, int fd, off_t offset, off_t end, long *applied, int *corrupt) {
+    sqlite3_stmt *income_stmt = NULL, *expense_stmt = NULL, *offset_stmt = NULL;
+    JournalRecord *buffer = malloc(JOURNAL_COMPACT_BATCH * sizeof(JournalRecord));
+
+    *applied = 0;
+    *corrupt = 0;
+    if (sqlite3_prepare_v2(db, SCHEMA_INSERT_SQL(SCHEMA_INCOME) ";", -1, &income_stmt, NULL) != SQLITE_OK ||
+        sqlite3_prepare_v2(db, SCHEMA_INSERT_SQL(SCHEMA_EXPENSES) ";", -1, &expense_stmt, NULL) != SQLITE_OK ||
+        sqlite3_prepare_v2(db, set_offset_sql, -1, &offset_stmt, NULL) != SQLITE_OK) {
+        printf("Error: Failed to prepare journal compaction: %s\n", sqlite3_errmsg(db));
+        goto done;
+    }
+
+    while (offset + (off_t)sizeof(JournalRecord) <= end) {
+        size_t wanted = (end - offset) / sizeof(JournalRecord);
+        if (wanted > JOURNAL_COMPACT_BATCH) {
+            wanted = JOURNAL_COMPACT_BATCH;
+        }
+        ssize_t got = pread(fd, buffer, wanted * sizeof(JournalRecord), offset);
+        int count = (got > 0) ? (int)(got / sizeof(JournalRecord)) : 0;
+        if (count == 0) {
+            break;
+        }
+
+        if (sqlite3_exec(db, "BEGIN IMMEDIATE;", 0, 0, NULL) != SQLITE_OK) {
+            break;   // Database busy; try again on the next pass
+        }
+
+        int valid = 0, failed = 0;
+        for (; valid < count; valid++) {
+            JournalRecord *record = &buffer[valid];
+            if (!recordIsValid(record)) {
+                *corrupt = 1;
+                break;
+            }
+            record->date[sizeof(record->date) - 1] = '\0';
+            record->category[sizeof(record->category) - 1] = '\0';
+
+            // Journal records are always in the base currency
+            sqlite3_stmt *stmt = (record->type == JOURNAL_INCOME) ? income_stmt : expense_stmt;
+            if (record->type == JOURNAL_INCOME) {
+                IncomeRow row = { .amount = record->amount, .date = record->date };
+                schemaBind_income(stmt, &row);
+            } else {
+                ExpenseRow row = { .category = record->category, .amount = record->amount, .date = record->date };
+                schemaBind_expenses(stmt, &row);
+            }
+            failed = (sqlite3_step(stmt) != SQLITE_DONE);
+            sqlite3_reset(stmt);
+            if (failed) {
+                break;
+            }
+        }
+
+        if (!failed) {
+            JournalStateRow state = { .id = 1, .offset = offset + (off_t)valid * sizeof(JournalRecord) };
+            schemaBind_journal_state(offset_stmt, &state);
+            failed = (sqlite3_step(offset_stmt) != SQLITE_DONE);
+            sqlite3_reset(offset_stmt);
+        }
+        if (failed || sqlite3_exec(db, "COMMIT;", 0, 0, NULL) != SQLITE_OK) {
+            printf("Error: Journal compaction failed: %s\n", sqlite3_errmsg(db));
+            sqlite3_exec(db, "ROLLBACK;", 0, 0, NULL);
+            *corrupt = 0;
+            break;
+        }
+
+        offset += (off_t)valid * sizeof(JournalRecord);
+        *applied += valid;
+        if (*corrupt) {
+            break;
+        }
+    }
+
+done:
+    sqlite3_finalize(income_stmt);
+    sqlite3_finalize(expense_stmt);
+    sqlite3_finalize(offset_stmt);
+    free(buffer);
+    return offset;
+}
+
+// Function to fold any journal tail left by a previous run into the database
+int replayJournal(sqlite3 *db, const char *db_name) {
+    char path[512];
+    buildJournalPath(db_name, path, sizeof(path));
+
+    int fd = open(path, O_RDWR);
+    if (fd < 0) {
+        return 0;   // No journal, nothing to replay
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return 0;
+    }
+
+    // An offset past the end of an empty file means a reset was interrupted before its COMMIT.
+    // Past the end of a non-empty one, records were lost: keep the file aside instead of
+    // replaying from a position that no longer means anything.
+    off_t offset = getJournalOffset(db);
+    if (offset > st.st_size) {
+        if (st.st_size > 0) {
+            char damaged[530];
+            snprintf(damaged, sizeof(damaged), "%s.corrupt", path);
+            printf("Error: Journal %s is shorter than its recorded offset (%ld of %ld bytes).\n",
+                   path, (long)st.st_size, (long)offset);
+            if (rename(path, damaged) == 0) {
+                printf("The journal was moved to %s and nothing was replayed from it.\n", damaged);
+            } else {
+                printf("Error: Could not move the journal aside; nothing was replayed from it.\n");
+            }
+        }
+        if (!setJournalOffset(db, 0)) {
+            printf("SQLite Error: %s\n", sqlite3_errmsg(db));
+        }
+        close(fd);
+        return 0;
+    }
+
+    long applied = 0;
+    int corrupt = 0;
+    off_t reached = compactJournal(db, fd, offset, st.st_size, &applied, &corrupt);
+
+    if (applied > 0) {
+        printf("Replayed %ld journal record(s).\n", applied);
+    }
+    if (corrupt || (reached < st.st_size && st.st_size - reached < (off_t)sizeof(JournalRecord))) {
+        printf("Warning: Discarded %ld byte(s) of incomplete journal data.\n", (long)(st.st_size - reached));
+        reached = st.st_size;
+    }
+
+    // Everything is in SQLite now: start the journal over
+    if (reached == st.st_size && reached > 0) {
+        resetJournal(db, fd);
+    }
+    close(fd);
+    return (int)applied;
+}
+
+// Flush pending appends to disk; caller holds journal_lock
+static void syncJournalLocked() {
+    if (journal_fd >= 0 && appended_end > synced_end) {
+        fdatasync(journal_fd);
+        synced_end = appended_end;
+        unsynced_records = 0;
+    }
+}
+
+// Background thread: group fsyncs and fold durable records into SQLite
+static void *compactorThread(void *arg) {
+    off_t compacted = getJournalOffset(compactor_db);
+
+    pthread_mutex_lock(&journal_lock);
+    while (1) {
+        if (!stop_requested) {
+            struct timespec deadline;
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_nsec += (long)JOURNAL_SYNC_INTERVAL_MS * 1000000L;
+            deadline.tv_sec += deadline.tv_nsec / 1000000000L;
+            deadline.tv_nsec %= 1000000000L;
+            pthread_cond_timedwait(&journal_wake, &journal_lock, &deadline);
+        }
+        int stopping = stop_requested;
+        syncJournalLocked();
+        // The journal was emptied earlier but its offset is still the old one: retry the reset
+        // before anything is compacted past it
+        if (offset_stale && setJournalOffset(compactor_db, 0)) {
+            offset_stale = 0;
+        }
+        off_t end = synced_end;
+        pthread_mutex_unlock(&journal_lock);
+
+        long applied = 0;
+        int corrupt = 0;
+        compacted = compactJournal(compactor_db, journal_fd, compacted, end, &applied, &corrupt);
+
+        pthread_mutex_lock(&journal_lock);
+        // Nothing was appended meanwhile: truncate so the journal never grows without bound
+        if (compacted > 0 && compacted == end && appended_end == end) {
+            int reset = resetJournal(compactor_db, journal_fd);
+            if (reset != 0) {
+                appended_end = synced_end = compacted = 0;
+                offset_stale = (reset < 0);
+            }
+        }
+        if (stopping) {
+            break;
+        }
+    }
+    pthread_mutex_unlock(&journal_lock);
+    return NULL;
+}
+
+// Function to start journaling inserts for the given database
+int openJournal(const char *db_name) {
+    if (journal_fd >= 0) {
+        return 1;
+    }
+
+    char path[512];
+    buildJournalPath(db_name, path, sizeof(path));
+
+    int fd = open(path, O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (fd < 0) {
+        printf("Error: Unable to open journal %s\n", path);
+        return 0;
+    }
+    if (sqlite3_open(db_name, &compactor_db) != SQLITE_OK) {
+        printf("Error: Unable to open database for journal compaction: %s\n", sqlite3_errmsg(compactor_db));
+        sqlite3_close(compactor_db);
+        compactor_db = NULL;
+        close(fd);
+        return 0;
+    }
+    sqlite3_busy_timeout(compactor_db, 5000);
+
+    struct stat st;
+    fstat(fd, &st);
+    appended_end = synced_end = st.st_size;
+    unsynced_records = 0;
+    stop_requested = 0;
+    journal_fd = fd;
+
+    if (pthread_create(&compactor_thread, NULL, compactorThread, NULL) != 0) {
+        printf("Error: Unable to start journal compaction thread.\n");
+        close(fd);
+        journal_fd = -1;
+        sqlite3_close(compactor_db);
+        compactor_db = NULL;
+        return 0;
+    }
+
+    printf("Journal enabled: %s\n", path);
+    return 1;
+}
+
+// Function to force journaled records to disk before continuing
+void syncJournal(void) {
+    pthread_mutex_lock(&journal_lock);
+    syncJournalLocked();
+    pthread_mutex_unlock(&journal_lock);
+}
+
+// Function to stop journaling after compacting everything into the database
+void closeJournal(void) {
+    if (journal_fd < 0) {
+        return;
+    }
+
+    pthread_mutex_lock(&journal_lock);
+    stop_requested = 1;
+    pthread_cond_signal(&journal_wake);
+    pthread_mutex_unlock(&journal_lock);
+    pthread_join(compactor_thread, NULL);
+
+    close(journal_fd);
+    journal_fd = -1;
+    sqlite3_close(compactor_db);
+    compactor_db = NULL;
+}
+
+int journalEnabled(void) {
+    return journal_fd >= 0;
+}
+
+static int appendRecord(JournalRecord *record) {
+    record->magic = JOURNAL_RECORD_MAGIC;
+    record->checksum = computeChecksum(record, offsetof(JournalRecord, checksum), 0);
+
+    pthread_mutex_lock(&journal_lock);
+    ssize_t written = write(journal_fd, record, sizeof(JournalRecord));
+    int ok = (written == (ssize_t)sizeof(JournalRecord));
+    if (ok) {
+        appended_end += sizeof(JournalRecord);
+        if (++unsynced_records >= JOURNAL_SYNC_RECORDS) {
+            syncJournalLocked();
+        }
+    } else if (written > 0) {
+        // Roll back a short write so the next record starts on a record boundary
+        if (ftruncate(journal_fd, appended_end) != 0) {
+            printf("Error: Journal is damaged; it will be repaired on the next start.\n");
+        }
+    }
+    pthread_mutex_unlock(&journal_lock);
+
+    if (!ok) {
+        printf("Error: Failed to write journal record.\n");
+    }
+    return ok;
+}
+
+// Function to journal an income row instead of writing it to SQLite directly
+int journalAppendIncome(float amount, const char *date) {
+    JournalRecord record;
+    memset(&record, 0, sizeof(record));
+    record.type = JOURNAL_INCOME;
+    record.amount = amount;
+    snprintf(record.date, sizeof(record.date), "%s", date);
+    return appendRecord(&record);
+}
+
+// Function to journal an expense row instead of writing it to SQLite directly
+int journalAppendExpense(const char *category, float amount, const char *date) {
+    JournalRecord record;
+    memset(&record, 0, sizeof(record));
+    record.type = JOURNAL_EXPENSE;
+    record.amount = amount;
+    snprintf(record.date, sizeof(record.date), "%s", date);
+    snprintf(record.category, sizeof(record.category), "%s", category);
+    return appendRecord(&record);
+}
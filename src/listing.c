@@ -0,0 +1,294 @@
+#define _XOPEN_SOURCE 700
+#include "listing.h"
+#include "utils.h"
+#include "batch.h"
+#include <stdio.h>
+#include <string.h>
+#include <sqlite3.h>
+
+// Column lists share one shape so every source fills a ListRow the same way
+static const char *listSelectSql(ListSource source) {
+    switch (source) {
+        case LIST_INCOME:
+            return "SELECT id, 'income', '', amount, 0, date FROM income";
+        case LIST_EXPENSES:
+            return "SELECT id, 'expense', category, amount, 0, date FROM expenses";
+        case LIST_RECURRING:
+            return "SELECT id, type, description, amount, 0, date FROM recurring";
+        default:
+            return "SELECT id, 'goal', name, target_amount, saved_amount, due_date FROM savings_goals";
+    }
+}
+
+// Per-partition select for income and expenses; the page query unions one per partition
+static const char *partitionSelectSql(ListSource source) {
+    return source == LIST_INCOME ? "SELECT id, amount, date FROM %s.income"
+                                 : "SELECT id, category, amount, date FROM %s.expenses";
+}
+
+// Attach the archive file of every archived year the date filter overlaps, as list_archive_N.
+// Archived rows keep their ids and ids are never reused, so the sort keys stay unique across
+// partitions. Returns how many were attached.
+static int attachListArchives(sqlite3 *db, const ListFilter *filter) {
+    const char *from = (filter != NULL && filter->date_from[0]) ? filter->date_from : "0000";
+    const char *to = (filter != NULL && filter->date_to[0]) ? filter->date_to : "9999";
+    const char *sql = "SELECT year, path FROM archives "
+                      "WHERE year BETWEEN CAST(substr(?1, 1, 4) AS INTEGER) AND CAST(substr(?2, 1, 4) AS INTEGER) "
+                      "ORDER BY year;";
+    sqlite3_stmt *stmt;
+    int attached = 0;
+
+    flushBatch();   // ATTACH needs no open transaction
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        return 0;
+    }
+    sqlite3_bind_text(stmt, 1, from, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, to, -1, SQLITE_STATIC);
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        int year = sqlite3_column_int(stmt, 0);
+        if (attached == LIST_ARCHIVE_MAX) {
+            printf("Warning: Only %d archived years can be listed at once; narrow the date range to see %d.\n",
+                   LIST_ARCHIVE_MAX, year);
+            break;
+        }
+        char attach_sql[64];
+        sqlite3_stmt *attach;
+        snprintf(attach_sql, sizeof(attach_sql), "ATTACH DATABASE ? AS list_archive_%d;", attached);
+        int ok = 0;
+        if (sqlite3_prepare_v2(db, attach_sql, -1, &attach, NULL) == SQLITE_OK) {
+            sqlite3_bind_text(attach, 1, (const char *)sqlite3_column_text(stmt, 1), -1, SQLITE_STATIC);
+            ok = (sqlite3_step(attach) == SQLITE_DONE);
+        }
+        sqlite3_finalize(attach);
+        if (ok) {
+            attached++;
+        } else {
+            printf("Warning: Archive for %d could not be opened; its rows are not listed.\n", year);
+        }
+    }
+    sqlite3_finalize(stmt);
+    return attached;
+}
+
+static void detachListArchives(sqlite3 *db, int attached) {
+    for (int i = 0; i < attached; i++) {
+        char sql[64];
+        snprintf(sql, sizeof(sql), "DETACH DATABASE list_archive_%d;", i);
+        sqlite3_exec(db, sql, 0, 0, NULL);
+    }
+}
+
+static void appendCondition(char *sql, size_t size, int *conditions, const char *condition) {
+    size_t length = strlen(sql);
+    snprintf(sql + length, size - length, "%s%s", (*conditions)++ ? " AND " : " WHERE ", condition);
+}
+
+static void copyColumn(char *dest, size_t size, sqlite3_stmt *stmt, int column) {
+    const unsigned char *text = sqlite3_column_text(stmt, column);
+    snprintf(dest, size, "%s", text ? (const char *)text : "");
+}
+
+// Function to fetch one page of rows after the cursor. Each page is a seek on the sort key
+// (id, or date then id) followed by at most page_size + 1 rows, so the cost doesn't grow with
+// how far into the table the cursor is. Date order skips rows without a date. Income and
+// expenses include the archived years the date filter overlaps.
+int fetchListPage(sqlite3 *db, ListSource source, ListOrder order, const ListFilter *filter,
+                  const ListCursor *cursor, int page_size, ListPage *page) {
+    int ledger = (source == LIST_INCOME || source == LIST_EXPENSES);
+    ListCursor start = {0};
+    if (cursor != NULL) {
+        start = *cursor;
+    }
+
+    page->count = 0;
+    page->next = start;
+    if (start.done) {
+        return 1;
+    }
+    if (order == LIST_BY_DATE && !ledger) {
+        printf("Error: Only income and expenses can be listed by date.\n");
+        return 0;
+    }
+    if (page_size < 1 || page_size > LIST_PAGE_MAX) {
+        page_size = page_size < 1 ? LIST_PAGE_DEFAULT : LIST_PAGE_MAX;
+    }
+
+    char sql[2048];
+    int conditions = 0;
+    int archives = ledger ? attachListArchives(db, filter) : 0;
+    if (archives > 0) {
+        // The same shape as listSelectSql, over the ledger and each attached archive
+        snprintf(sql, sizeof(sql), source == LIST_INCOME ? "SELECT id, 'income', '', amount, 0, date FROM ("
+                                                         : "SELECT id, 'expense', category, amount, 0, date FROM (");
+        size_t length = strlen(sql);
+        snprintf(sql + length, sizeof(sql) - length, partitionSelectSql(source), "main");
+        for (int i = 0; i < archives; i++) {
+            char schema[32];
+            snprintf(schema, sizeof(schema), "list_archive_%d", i);
+            length = strlen(sql);
+            snprintf(sql + length, sizeof(sql) - length, " UNION ALL ");
+            length = strlen(sql);
+            snprintf(sql + length, sizeof(sql) - length, partitionSelectSql(source), schema);
+        }
+        length = strlen(sql);
+        snprintf(sql + length, sizeof(sql) - length, ")");
+    } else {
+        snprintf(sql, sizeof(sql), "%s", listSelectSql(source));
+    }
+
+    if (order == LIST_BY_DATE) {
+        appendCondition(sql, sizeof(sql), &conditions,
+                        start.started ? "(date, id) > (?, ?)" : "date IS NOT NULL");
+    } else {
+        appendCondition(sql, sizeof(sql), &conditions, "id > ?");
+    }
+    if (filter != NULL) {
+        if (source == LIST_RECURRING && filter->type[0]) {
+            appendCondition(sql, sizeof(sql), &conditions, "type = ?");
+        }
+        if (source == LIST_EXPENSES && filter->category[0]) {
+            appendCondition(sql, sizeof(sql), &conditions, "category = ?");
+        }
+        if (ledger && filter->date_from[0]) {
+            appendCondition(sql, sizeof(sql), &conditions, "date >= ?");
+        }
+        if (ledger && filter->date_to[0]) {
+            appendCondition(sql, sizeof(sql), &conditions, "date <= ?");
+        }
+    }
+    size_t length = strlen(sql);
+    snprintf(sql + length, sizeof(sql) - length, " ORDER BY %s LIMIT ?;",
+             order == LIST_BY_DATE ? "date, id" : "id");
+
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        printf("SQLite Error: %s\n", sqlite3_errmsg(db));
+        detachListArchives(db, archives);
+        return 0;
+    }
+
+    // Bind in the same order the conditions were appended
+    int index = 1;
+    if (order == LIST_BY_DATE) {
+        if (start.started) {
+            sqlite3_bind_text(stmt, index++, start.last_date, -1, SQLITE_STATIC);
+            sqlite3_bind_int64(stmt, index++, start.last_id);
+        }
+    } else {
+        sqlite3_bind_int64(stmt, index++, start.last_id);
+    }
+    if (filter != NULL) {
+        if (source == LIST_RECURRING && filter->type[0]) {
+            sqlite3_bind_text(stmt, index++, filter->type, -1, SQLITE_STATIC);
+        }
+        if (source == LIST_EXPENSES && filter->category[0]) {
+            sqlite3_bind_text(stmt, index++, filter->category, -1, SQLITE_STATIC);
+        }
+        if (ledger && filter->date_from[0]) {
+            sqlite3_bind_text(stmt, index++, filter->date_from, -1, SQLITE_STATIC);
+        }
+        if (ledger && filter->date_to[0]) {
+            sqlite3_bind_text(stmt, index++, filter->date_to, -1, SQLITE_STATIC);
+        }
+    }
+    sqlite3_bind_int(stmt, index, page_size + 1);   // One extra row tells us whether more remain
+
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        if (page->count == page_size) {
+            break;
+        }
+        // A date that doesn't fit the cursor can't be resumed from exactly; stop rather than repeat rows
+        if (order == LIST_BY_DATE && sqlite3_column_bytes(stmt, 5) >= LIST_DATE_SIZE) {
+            printf("Error: The date of entry %lld is too long to list by date; list by ID instead.\n",
+                   (long long)sqlite3_column_int64(stmt, 0));
+            rc = SQLITE_DONE;
+            break;
+        }
+        ListRow *row = &page->rows[page->count++];
+        row->id = sqlite3_column_int64(stmt, 0);
+        copyColumn(row->type, sizeof(row->type), stmt, 1);
+        copyColumn(row->label, sizeof(row->label), stmt, 2);
+        row->amount = sqlite3_column_double(stmt, 3);
+        row->saved_amount = sqlite3_column_double(stmt, 4);
+        copyColumn(row->date, sizeof(row->date), stmt, 5);
+    }
+    if (rc != SQLITE_ROW && rc != SQLITE_DONE) {
+        printf("SQLite Error: %s\n", sqlite3_errmsg(db));
+        sqlite3_finalize(stmt);
+        detachListArchives(db, archives);
+        return 0;
+    }
+    page->next.done = (rc == SQLITE_DONE);
+    sqlite3_finalize(stmt);
+    detachListArchives(db, archives);
+
+    if (page->count > 0) {
+        const ListRow *last = &page->rows[page->count - 1];
+        page->next.started = 1;
+        page->next.last_id = last->id;
+        snprintf(page->next.last_date, sizeof(page->next.last_date), "%s", last->date);
+    }
+    return 1;
+}
+
+// Prompt for an optional date; a blank line leaves the bound open
+static void getOptionalDateInput(const char *prompt, char *date, int max_len) {
+    int year, month, day;
+    while (1) {
+        printf("%s", prompt);
+        if (getOptionalStringInput(date, max_len) == 0) {
+            return;
+        }
+        if (parseDateToken(date, &year, &month, &day)) {
+            snprintf(date, max_len, "%04d-%02d-%02d", year, month, day);
+            return;
+        }
+        printf("Error: Invalid date format. Please enter a date in the format YYYY-MM-DD.\n");
+    }
+}
+
+// Function to page through income or expenses with optional filters
+void browseTransactions(sqlite3 *db) {
+    ListFilter filter = {0};
+    ListCursor cursor = {0};
+    ListPage page;
+
+    printf("List (1 = Income, 2 = Expenses): ");
+    ListSource source = getValidIntInput() == 1 ? LIST_INCOME : LIST_EXPENSES;
+
+    printf("Order (1 = By ID, 2 = By Date): ");
+    ListOrder order = getValidIntInput() == 2 ? LIST_BY_DATE : LIST_BY_ID;
+
+    if (source == LIST_EXPENSES) {
+        printf("Filter by category (blank for any): ");
+        getOptionalStringInput(filter.category, sizeof(filter.category));
+    }
+    getOptionalDateInput("From date (YYYY-MM-DD, blank for any): ", filter.date_from, sizeof(filter.date_from));
+    getOptionalDateInput("To date (YYYY-MM-DD, blank for any): ", filter.date_to, sizeof(filter.date_to));
+
+    printf("\n--- %s ---\n", source == LIST_INCOME ? "Income" : "Expenses");
+    int shown = 0;
+    while (fetchListPage(db, source, order, &filter, &cursor, LIST_PAGE_DEFAULT, &page)) {
+        for (int i = 0; i < page.count; i++) {
+            const ListRow *row = &page.rows[i];
+            if (source == LIST_INCOME) {
+                printf("[ID: %lld] %s $%.2f\n", (long long)row->id, row->date, row->amount);
+            } else {
+                printf("[ID: %lld] %s %s - $%.2f\n", (long long)row->id, row->date, row->label, row->amount);
+            }
+        }
+        shown += page.count;
+        cursor = page.next;
+
+        if (cursor.done) {
+            printf(shown ? "End of list (%d shown).\n" : "No matching entries found.\n", shown);
+            break;
+        }
+        printf("Show next page? (y/n): ");
+        char more = getValidCharInput();
+        if (more != 'y' && more != 'Y') {
+            break;
+        }
+    }
+}
@@ -3,6 +3,16 @@
 #include "database.h"
 #include "utils.h"
 #include "recurring.h"
+#include "tools.h"
+#include "category_limits.h"
+#include "journal.h"
+#include "batch.h"
+#include "snapshot.h"
+#include "savings.h"
+#include "consolidate.h"
+#include "backup.h"
+#include "stress.h"
+#include "metrics.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -10,11 +20,69 @@
 #include <cjson/cJSON.h>
 #include <sqlite3.h>
 
+// Function to finish background work and save derived files before the ledger is closed; the
+// menu exit and the SIGINT/SIGTERM handler both run it
+static void shutdownSession(sqlite3 *db) {
+    finishOnlineBackup();
+    flushBatch();
+    closeJournal();
+    // A transaction still open here belongs to an interrupted operation that will never commit
+    if (sqlite3_get_autocommit(db)) {
+        refreshSnapshot(db, SNAPSHOT_FILE);
+    }
+    closeBatchMode();
+}
+
+int main(int argc, char *argv[]) {
+    // Report-only invocation: answer from the memory-mapped snapshot without opening SQLite
+    if (argc > 1 && strcmp(argv[1], "--report") == 0) {
+        return showSnapshotReport(SNAPSHOT_FILE) ? 0 : 1;
+    }
+    // Rebuild a ledger from its backups: --restore backups/finance_lite_000003.flb restored.db
+    if (argc > 1 && strcmp(argv[1], "--restore") == 0) {
+        if (argc != 4) {
+            printf("Usage: %s --restore <backup.flb> <new.db>\n", argv[0]);
+            return 1;
+        }
+        return restoreBackup(argv[2], argv[3]) ? 0 : 1;
+    }
+    // Merge several ledger files: --consolidate out.json a.db b.db ...
+    if (argc > 1 && strcmp(argv[1], "--consolidate") == 0) {
+        if (argc < 4) {
+            printf("Usage: %s --consolidate <out.json> <ledger.db>...\n", argv[0]);
+            return 1;
+        }
+        return consolidateLedgers((const char **)argv + 3, argc - 3, argv[2]) ? 0 : 1;
+    }
 
+    // Randomized stress run on a scratch ledger: --stress [operations] [threads] [seed]
+    if (argc > 1 && strcmp(argv[1], "--stress") == 0) {
+        return runStressTest(argc > 2 ? atoi(argv[2]) : STRESS_DEFAULT_OPERATIONS,
+                             argc > 3 ? atoi(argv[3]) : STRESS_DEFAULT_THREADS,
+                             argc > 4 ? strtoull(argv[4], NULL, 10) : 0) ? 0 : 1;
+    }
 
-int main() {
     sqlite3 *db;
     initializeDatabase(&db, "finance_lite.db");
+    initBatchMode(db);
+    if (argc > 1 && strcmp(argv[1], "--backup") == 0) {
+        int ok = createBackup(db, argc > 2 && strcmp(argv[2], "--full") == 0);
+        closeBatchMode();
+        sqlite3_close(db);
+        return ok ? 0 : 1;
+    }
+    if (argc > 1 && strcmp(argv[1], "--snapshot") == 0) {
+        int ok = writeSnapshot(db, SNAPSHOT_FILE);
+        closeBatchMode();
+        sqlite3_close(db);
+        return ok ? 0 : 1;
+    }
+    setShutdownHandler(shutdownSession);
+    startMetrics("finance_lite.db");
+    if (getenv("FINANCE_LITE_JOURNAL")) {
+        openJournal("finance_lite.db");
+    }
+    loadCategoryLimits(db);
 
     Budget budget = {0, 0, 0, 30};
     autoSetDaysInMonth(&budget);
@@ -35,9 +103,9 @@ int main() {
         printf("8. Manage Recurring Entries and Savings\n");
         printf("9. Export Budget to JSON\n");
         printf("10. Save and Exit\n");
+        printf("11. Reports & Tools\n");
         printf("Enter your choice: ");
         choice = getValidIntInput();
-        getchar(); // Consume newline left in buffer
 
         switch (choice) {
             case 1:
@@ -59,7 +127,7 @@ int main() {
                 target_amount = getValidFloatInput();  // Use the helper function for validation
 
                 printf("Enter due date (YYYY-MM-DD): ");
-                scanf("%10s", due_date);
+                getValidDateInput(due_date, sizeof(due_date));
 
                 insertSavingsGoal(db, name, target_amount, due_date);
                 break;
@@ -69,14 +137,14 @@ int main() {
                 float amount;
                 fetchSavingsGoals(db);
                 printf("Enter the ID of the savings goal to update: ");
-                scanf("%d", &goal_id);
+                goal_id = getValidIntInput();
                 printf("Enter the amount you saved: $");
-                scanf("%f", &amount);
+                amount = getValidFloatInput();
                 updateSavingsGoal(db, goal_id, amount);
                 break;
             }
             case 5:
-                fetchSavingsGoals(db);
+                showSavingsProgress(db);
                 break;
             case 6:
                 calculateDailyBudget(db, &budget);
@@ -93,9 +161,10 @@ int main() {
             case 10: {
                 char confirm_exit;
                 printf("\nAre you sure you want to exit? (Y/N): ");
-                scanf(" %c", &confirm_exit); // Notice the space before %c to catch newline character
+                confirm_exit = getValidCharInput();
 
                 if (confirm_exit == 'Y' || confirm_exit == 'y') {
+                    shutdownSession(db);
                     printf("Budget saved. Goodbye!\n");
                     sqlite3_close(db);
                     exit(0); // Exits only if user confirms
@@ -104,11 +173,15 @@ int main() {
                 printf("Returning to menu...\n");
                 break; // Return to the main menu if not exiting
             }
+            case 11:
+                manageTools(db);
+                break;
             default:
                 printf("Invalid choice. Please try again.\n");
         }
     } while (choice != 10); // Exit loop when choice is 10 (Save and Exit)
 
+    shutdownSession(db);
     sqlite3_close(db);
     return 0;
 }
@@ -0,0 +1,293 @@
+#define _XOPEN_SOURCE 700
+#include "metrics.h"
+#include "batch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sqlite3.h>
+
+// Counters and histograms are plain atomics bumped with relaxed ordering, so the insert and
+// report paths never take a lock. Row counts are kept in the ledger by triggers, so reading
+// them costs one row per table instead of a scan. Everything that needs I/O (row counts, file
+// sizes) is read by the writer thread when it renders the file, in Prometheus text exposition format, to a
+// temporary file that is renamed over the target so a scrape never sees a half-written file.
+
+static const char *kind_names[METRIC_KIND_COUNT] = { "income", "expenses" };
+static const char *report_names[METRIC_REPORT_COUNT] = { "analytics", "daily_budget", "date_range" };
+
+// Upper bounds of the report latency buckets in seconds; the +Inf bucket follows them
+static const double report_buckets[] = { 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5 };
+#define REPORT_BUCKET_COUNT (sizeof(report_buckets) / sizeof(report_buckets[0]) + 1)
+
+static atomic_uint_fast64_t inserts[METRIC_KIND_COUNT];
+static atomic_uint_fast64_t insert_errors[METRIC_KIND_COUNT];
+static atomic_uint_fast64_t recurring_posted[METRIC_KIND_COUNT];
+static atomic_uint_fast64_t recurring_skipped[METRIC_KIND_COUNT];
+static atomic_uint_fast64_t report_counts[METRIC_REPORT_COUNT][REPORT_BUCKET_COUNT];   // Not cumulative
+static atomic_uint_fast64_t report_ns[METRIC_REPORT_COUNT];
+
+// Tables whose row counts are exported
+static const char *row_tables[] = { "income", "expenses", "recurring", "savings_goals", "goal_contributions" };
+#define ROW_TABLE_COUNT (sizeof(row_tables) / sizeof(row_tables[0]))
+
+static pthread_mutex_t metrics_lock = PTHREAD_MUTEX_INITIALIZER;   // Serializes file writes only
+static sqlite3 *metrics_db = NULL;        // Read-only connection for row counts
+static char metrics_path[512];
+static char ledger_path[512];
+static int metrics_interval = METRICS_DEFAULT_INTERVAL;
+static time_t started_at;
+static int64_t row_counts[ROW_TABLE_COUNT];   // Last counts read; kept when the ledger is busy
+
+// Function to create the row count table and the triggers that keep it current. Counts missing
+// from the table, for tables the ledger had before it existed, are taken once here.
+int initializeRowCounts(sqlite3 *db) {
+    char sql[2048];
+    size_t length = snprintf(sql, sizeof(sql),
+        "CREATE TABLE IF NOT EXISTS row_counts ("
+        "table_name TEXT PRIMARY KEY, "
+        "row_count INTEGER NOT NULL);");
+    for (size_t i = 0; i < ROW_TABLE_COUNT; i++) {
+        const char *name = row_tables[i];
+        length += snprintf(sql + length, sizeof(sql) - length,
+            "CREATE TRIGGER IF NOT EXISTS %s_rows_ai AFTER INSERT ON %s BEGIN "
+            "UPDATE row_counts SET row_count = row_count + 1 WHERE table_name = '%s'; END;"
+            "CREATE TRIGGER IF NOT EXISTS %s_rows_ad AFTER DELETE ON %s BEGIN "
+            "UPDATE row_counts SET row_count = row_count - 1 WHERE table_name = '%s'; END;",
+            name, name, name, name, name, name);
+    }
+
+    char *err_msg = NULL;
+    int ok = sqlite3_exec(db, "BEGIN IMMEDIATE;", 0, 0, &err_msg) == SQLITE_OK &&
+             sqlite3_exec(db, sql, 0, 0, &err_msg) == SQLITE_OK;
+    for (size_t i = 0; ok && i < ROW_TABLE_COUNT; i++) {
+        sqlite3_stmt *stmt;
+        int counted = 0;
+        if (sqlite3_prepare_v2(db, "SELECT 1 FROM row_counts WHERE table_name = ?;", -1, &stmt, NULL) == SQLITE_OK) {
+            sqlite3_bind_text(stmt, 1, row_tables[i], -1, SQLITE_STATIC);
+            counted = (sqlite3_step(stmt) == SQLITE_ROW);
+        }
+        sqlite3_finalize(stmt);
+        if (!counted) {
+            snprintf(sql, sizeof(sql), "INSERT INTO row_counts (table_name, row_count) SELECT '%s', COUNT(*) FROM %s;",
+                     row_tables[i], row_tables[i]);
+            ok = sqlite3_exec(db, sql, 0, 0, &err_msg) == SQLITE_OK;
+        }
+    }
+    if (!ok || sqlite3_exec(db, "COMMIT;", 0, 0, &err_msg) != SQLITE_OK) {
+        printf("Error: Failed to create row counts: %s\n", err_msg ? err_msg : sqlite3_errmsg(db));
+        sqlite3_free(err_msg);
+        sqlite3_exec(db, "ROLLBACK;", 0, 0, NULL);
+        return 0;
+    }
+    return 1;
+}
+
+// Function to count an income or expense insert, successful or not
+void metricsCountInsert(MetricKind kind, int ok) {
+    atomic_fetch_add_explicit(ok ? &inserts[kind] : &insert_errors[kind], 1, memory_order_relaxed);
+}
+
+// Function to count a recurring entry that was posted, or skipped as already posted this month
+void metricsCountRecurring(MetricKind kind, int posted) {
+    atomic_fetch_add_explicit(posted ? &recurring_posted[kind] : &recurring_skipped[kind], 1, memory_order_relaxed);
+}
+
+// Function to record how long a report took since start (CLOCK_MONOTONIC)
+void metricsObserveReport(MetricReport report, const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    int64_t ns = (int64_t)(now.tv_sec - start->tv_sec) * 1000000000LL + (now.tv_nsec - start->tv_nsec);
+    double seconds = ns / 1e9;
+
+    size_t bucket = 0;
+    while (bucket < REPORT_BUCKET_COUNT - 1 && seconds > report_buckets[bucket]) {
+        bucket++;
+    }
+    atomic_fetch_add_explicit(&report_counts[report][bucket], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&report_ns[report], (uint_fast64_t)(ns > 0 ? ns : 0), memory_order_relaxed);
+}
+
+static uint64_t load(atomic_uint_fast64_t *value) {
+    return atomic_load_explicit(value, memory_order_relaxed);
+}
+
+static long long fileSize(const char *path) {
+    struct stat st;
+    return stat(path, &st) == 0 ? (long long)st.st_size : 0;
+}
+
+// Refresh row_counts from the trigger-maintained table; caller holds metrics_lock
+static void readRowCounts(void) {
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(metrics_db, "SELECT row_count FROM row_counts WHERE table_name = ?;", -1, &stmt, NULL) != SQLITE_OK) {
+        return;
+    }
+    for (size_t i = 0; i < ROW_TABLE_COUNT; i++) {
+        sqlite3_bind_text(stmt, 1, row_tables[i], -1, SQLITE_STATIC);
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            row_counts[i] = sqlite3_column_int64(stmt, 0);
+        }
+        sqlite3_reset(stmt);
+    }
+    sqlite3_finalize(stmt);
+}
+
+static void writeFileSize(FILE *file, const char *name, const char *suffix) {
+    char path[600];
+    snprintf(path, sizeof(path), "%s%s", ledger_path, suffix);
+    fprintf(file, "finance_lite_file_bytes{file=\"%s\"} %lld\n", name, fileSize(path));
+}
+
+// Function to write the metrics file now; returns 0 when export is off or the write failed
+int writeMetrics(void) {
+    if (metrics_db == NULL) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&metrics_lock);
+    readRowCounts();
+
+    char tmp_path[600];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", metrics_path);
+    FILE *file = fopen(tmp_path, "w");
+    if (file == NULL) {
+        pthread_mutex_unlock(&metrics_lock);
+        return 0;
+    }
+
+    fprintf(file, "# HELP finance_lite_rows Rows currently in each ledger table.\n"
+                  "# TYPE finance_lite_rows gauge\n");
+    for (size_t i = 0; i < ROW_TABLE_COUNT; i++) {
+        fprintf(file, "finance_lite_rows{table=\"%s\"} %lld\n", row_tables[i], (long long)row_counts[i]);
+    }
+
+    fprintf(file, "# HELP finance_lite_inserts_total Income and expense rows added since start, including journaled ones.\n"
+                  "# TYPE finance_lite_inserts_total counter\n");
+    for (int i = 0; i < METRIC_KIND_COUNT; i++) {
+        fprintf(file, "finance_lite_inserts_total{table=\"%s\"} %llu\n", kind_names[i],
+                (unsigned long long)load(&inserts[i]));
+    }
+    fprintf(file, "# HELP finance_lite_insert_errors_total Income and expense inserts that failed.\n"
+                  "# TYPE finance_lite_insert_errors_total counter\n");
+    for (int i = 0; i < METRIC_KIND_COUNT; i++) {
+        fprintf(file, "finance_lite_insert_errors_total{table=\"%s\"} %llu\n", kind_names[i],
+                (unsigned long long)load(&insert_errors[i]));
+    }
+
+    fprintf(file, "# HELP finance_lite_recurring_postings_total Recurring entries posted since start.\n"
+                  "# TYPE finance_lite_recurring_postings_total counter\n");
+    for (int i = 0; i < METRIC_KIND_COUNT; i++) {
+        fprintf(file, "finance_lite_recurring_postings_total{type=\"%s\"} %llu\n", kind_names[i],
+                (unsigned long long)load(&recurring_posted[i]));
+    }
+    fprintf(file, "# HELP finance_lite_recurring_skipped_total Recurring entries skipped as already posted for the month.\n"
+                  "# TYPE finance_lite_recurring_skipped_total counter\n");
+    for (int i = 0; i < METRIC_KIND_COUNT; i++) {
+        fprintf(file, "finance_lite_recurring_skipped_total{type=\"%s\"} %llu\n", kind_names[i],
+                (unsigned long long)load(&recurring_skipped[i]));
+    }
+
+    fprintf(file, "# HELP finance_lite_report_duration_seconds Time taken to compute a report.\n"
+                  "# TYPE finance_lite_report_duration_seconds histogram\n");
+    for (int r = 0; r < METRIC_REPORT_COUNT; r++) {
+        uint64_t cumulative = 0;
+        for (size_t b = 0; b < REPORT_BUCKET_COUNT; b++) {
+            cumulative += load(&report_counts[r][b]);
+            if (b < REPORT_BUCKET_COUNT - 1) {
+                fprintf(file, "finance_lite_report_duration_seconds_bucket{report=\"%s\",le=\"%g\"} %llu\n",
+                        report_names[r], report_buckets[b], (unsigned long long)cumulative);
+            } else {
+                fprintf(file, "finance_lite_report_duration_seconds_bucket{report=\"%s\",le=\"+Inf\"} %llu\n",
+                        report_names[r], (unsigned long long)cumulative);
+            }
+        }
+        fprintf(file, "finance_lite_report_duration_seconds_sum{report=\"%s\"} %.9f\n", report_names[r],
+                load(&report_ns[r]) / 1e9);
+        fprintf(file, "finance_lite_report_duration_seconds_count{report=\"%s\"} %llu\n", report_names[r],
+                (unsigned long long)cumulative);
+    }
+
+    fprintf(file, "# HELP finance_lite_file_bytes Size of the ledger and its journal files.\n"
+                  "# TYPE finance_lite_file_bytes gauge\n");
+    writeFileSize(file, "database", "");
+    writeFileSize(file, "rollback_journal", "-journal");
+    writeFileSize(file, "wal", "-wal");
+    writeFileSize(file, "oplog", ".oplog");
+
+    fprintf(file, "# HELP finance_lite_start_time_seconds Start time of the process since the Unix epoch.\n"
+                  "# TYPE finance_lite_start_time_seconds gauge\n"
+                  "finance_lite_start_time_seconds %lld\n", (long long)started_at);
+
+    int ok = !ferror(file);
+    ok = (fclose(file) == 0) && ok && rename(tmp_path, metrics_path) == 0;
+    if (!ok) {
+        remove(tmp_path);
+    }
+    pthread_mutex_unlock(&metrics_lock);
+    return ok;
+}
+
+// Background thread that rewrites the metrics file every metrics_interval seconds
+static void *metricsWriterThread(void *arg) {
+    (void)arg;
+    while (1) {
+        struct timespec pause = { metrics_interval, 0 };
+        nanosleep(&pause, NULL);
+        writeMetrics();
+    }
+    return NULL;
+}
+
+// Commit batched writes first so the final row counts include them. This runs before the
+// batch exit hook; after closeBatchMode the flush is a no-op and never touches the ledger.
+static void writeFinalMetrics(void) {
+    flushBatch();
+    writeMetrics();
+}
+
+// Function to start the metrics file writer when FINANCE_LITE_METRICS=path[:seconds] is set.
+// Call after initBatchMode so the writer thread inherits its signal mask.
+int startMetrics(const char *db_name) {
+    const char *setting = getenv("FINANCE_LITE_METRICS");
+    if (setting == NULL || setting[0] == '\0') {
+        return 0;
+    }
+
+    snprintf(metrics_path, sizeof(metrics_path), "%s", setting);
+    char *colon = strrchr(metrics_path, ':');
+    if (colon != NULL && colon[1] != '\0' && strspn(colon + 1, "0123456789") == strlen(colon + 1)) {
+        metrics_interval = atoi(colon + 1) > 0 ? atoi(colon + 1) : METRICS_DEFAULT_INTERVAL;
+        *colon = '\0';
+    }
+    snprintf(ledger_path, sizeof(ledger_path), "%s", db_name);
+    started_at = time(NULL);
+
+    if (sqlite3_open_v2(db_name, &metrics_db, SQLITE_OPEN_READONLY, NULL) != SQLITE_OK) {
+        printf("Error: Unable to open database for metrics: %s\n", sqlite3_errmsg(metrics_db));
+        sqlite3_close(metrics_db);
+        metrics_db = NULL;
+        return 0;
+    }
+    sqlite3_busy_timeout(metrics_db, 1000);
+
+    if (!writeMetrics()) {
+        printf("Error: Unable to write metrics file %s\n", metrics_path);
+        sqlite3_close(metrics_db);
+        metrics_db = NULL;
+        return 0;
+    }
+
+    pthread_t writer;
+    if (pthread_create(&writer, NULL, metricsWriterThread, NULL) != 0) {
+        printf("Warning: Unable to start metrics writer thread; metrics are written at exit only.\n");
+    } else {
+        pthread_detach(writer);
+    }
+    atexit(writeFinalMetrics);
+    printf("Writing metrics to %s every %d s.\n", metrics_path, metrics_interval);
+    return 1;
+}
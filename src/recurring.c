@@ -1,7 +1,11 @@
 #define _XOPEN_SOURCE 700
 #include "utils.h"
 #include "recurring.h"
+#include "listing.h"
 #include "database.h"
+#include "batch.h"
+#include "savings.h"
+#include "schema.h"
 #include <stdio.h>
 #include <string.h>
 #include <sqlite3.h>
@@ -19,9 +23,10 @@ void manageRecurringEntries(sqlite3 *db) {
         printf("5. Remove Recurring Entry\n");
         printf("6. View Savings Goals\n");
         printf("7. Remove Savings Goal\n");  // Added option for removing savings goals
-        printf("8. Return to Main Menu\n");
+        printf("8. Post Savings Contributions\n");
+        printf("9. Return to Main Menu\n");
         printf("Enter your choice: ");
-        scanf("%d", &choice);
+        choice = getValidIntInput();
 
         switch (choice) {
             case 1:
@@ -46,11 +51,14 @@ void manageRecurringEntries(sqlite3 *db) {
                 removeSavingsGoal(db);  // Handle remove savings goal
                 break;
             case 8:
+                postContributionBatch(db);
+                break;
+            case 9:
                 return;  // Return to the main menu
             default:
                 printf("Invalid choice. Try again.\n");
         }
-    } while (choice != 8);
+    } while (choice != 9);
 }
 
 // Function to insert recurring entry with start date validation
@@ -93,14 +101,12 @@ void insertRecurringEntry(sqlite3 *db, const char *type) {
             return;
     }
 
-    const char *sql = "INSERT INTO recurring (type, description, amount, date) VALUES (?, ?, ?, ?);";
+    RecurringRow row = { .type = type, .description = description, .amount = amount, .date = date };
     sqlite3_stmt *stmt;
 
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) == SQLITE_OK) {
-        sqlite3_bind_text(stmt, 1, type, -1, SQLITE_STATIC);
-        sqlite3_bind_text(stmt, 2, description, -1, SQLITE_STATIC);
-        sqlite3_bind_double(stmt, 3, amount);
-        sqlite3_bind_text(stmt, 4, date, -1, SQLITE_STATIC);
+    beginBatchedWrite();
+    if (sqlite3_prepare_v2(db, SCHEMA_INSERT_SQL(SCHEMA_RECURRING) ";", -1, &stmt, NULL) == SQLITE_OK) {
+        schemaBind_recurring(stmt, &row);
 
         if (sqlite3_step(stmt) == SQLITE_DONE) {
             printf("Recurring %s added: %s - $%.2f, Start Date: %s\n", type, description, amount, date);
@@ -109,33 +115,27 @@ void insertRecurringEntry(sqlite3 *db, const char *type) {
         }
     }
     sqlite3_finalize(stmt);
+    endBatchedWrite();
 }
 
 // Fetch recurring entries
 void fetchRecurringEntries(sqlite3 *db) {
-    const char *sql = "SELECT id, type, description, amount FROM recurring ORDER BY id ASC;";
-    sqlite3_stmt *stmt;
-
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
-        printf("SQLite Error: %s\n", sqlite3_errmsg(db));  // More detailed error message
-        return;
-    }
+    ListCursor cursor = {0};
+    ListPage page;
 
     printf("\n--- Recurring Income & Expenses ---\n");
     int found = 0;  // Track if there are any recurring entries
 
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        int id = sqlite3_column_int(stmt, 0);
-        const char *type = (const char*)sqlite3_column_text(stmt, 1);  // Cast to const char*
-        const char *description = (const char*)sqlite3_column_text(stmt, 2);  // Cast to const char*
-        float amount = sqlite3_column_double(stmt, 3);
-
-        printf("[%d] %s - %s: $%.2f\n", id, type, description, amount);
-        found = 1;
+    // Fetch a page at a time, resuming after the last id shown
+    while (!cursor.done && fetchListPage(db, LIST_RECURRING, LIST_BY_ID, NULL, &cursor, LIST_PAGE_MAX, &page)) {
+        for (int i = 0; i < page.count; i++) {
+            const ListRow *row = &page.rows[i];
+            printf("[%lld] %s - %s: $%.2f\n", (long long)row->id, row->type, row->label, row->amount);
+            found = 1;
+        }
+        cursor = page.next;
     }
 
-    sqlite3_finalize(stmt);
-
     if (!found) {
         printf("No recurring entries found.\n");
     }
@@ -152,35 +152,40 @@ void editRecurringEntries(sqlite3 *db) {
     fetchRecurringEntries(db);
 
     printf("\nEnter the ID of the recurring entry you want to edit: ");
-    if (scanf("%d", &id) != 1) {
-        printf("Error: Invalid ID.\n");
-        return;
-    }
+    id = getValidIntInput();
 
     printf("Enter new description: ");
-    scanf("%s", new_description);
+    getValidStringInput(new_description, MAX_NAME_LENGTH);
 
     printf("Enter new amount: $");
-    if (scanf("%f", &new_amount) != 1 || new_amount <= 0) {
-        printf("Error: Invalid amount. Must be a positive number.\n");
-        return;
-    }
+    new_amount = getValidFloatInput();  // Ensure valid positive amount
+
+    // Read the whole row, change the two fields and write it back; the row's text stays valid
+    // until the read statement is finalized
+    sqlite3_stmt *read_stmt, *stmt = NULL;
+    RecurringRow row;
+
+    beginBatchedWrite();
+    if (sqlite3_prepare_v2(db, SCHEMA_SELECT_SQL(SCHEMA_RECURRING) " WHERE id = ?;", -1, &read_stmt, NULL) == SQLITE_OK) {
+        sqlite3_bind_int(read_stmt, 1, id);
+        if (sqlite3_step(read_stmt) != SQLITE_ROW) {
+            printf("Error: No recurring entry with ID %d.\n", id);
+        } else if (sqlite3_prepare_v2(db, SCHEMA_UPDATE_SQL(SCHEMA_RECURRING) ";", -1, &stmt, NULL) == SQLITE_OK) {
+            schemaRead_recurring(read_stmt, &row);
+            row.description = new_description;
+            row.amount = new_amount;
+            schemaBindUpdate_recurring(stmt, &row);
 
-    const char *sql = "UPDATE recurring SET description = ?, amount = ? WHERE id = ?;";
-    sqlite3_stmt *stmt;
-
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) == SQLITE_OK) {
-        sqlite3_bind_text(stmt, 1, new_description, -1, SQLITE_STATIC);
-        sqlite3_bind_double(stmt, 2, new_amount);
-        sqlite3_bind_int(stmt, 3, id);
-
-        if (sqlite3_step(stmt) == SQLITE_DONE) {
-            printf("Recurring entry updated successfully!\n");
-        } else {
-            printf("Error: Failed to update recurring entry: %s\n", sqlite3_errmsg(db));
+            if (sqlite3_step(stmt) == SQLITE_DONE) {
+                printf("Recurring entry updated successfully!\n");
+            } else {
+                printf("Error: Failed to update recurring entry: %s\n", sqlite3_errmsg(db));
+            }
         }
     }
     sqlite3_finalize(stmt);
+    sqlite3_finalize(read_stmt);
+    endBatchedWrite();
 }
 
 
@@ -192,14 +197,12 @@ void removeRecurringEntries(sqlite3 *db) {
     fetchRecurringEntries(db);
 
     printf("\nEnter the ID of the recurring entry you want to remove: ");
-    if (scanf("%d", &id) != 1) {
-        printf("Error: Invalid ID.\n");
-        return;
-    }
+    id = getValidIntInput();
 
     const char *sql = "DELETE FROM recurring WHERE id = ?;";
     sqlite3_stmt *stmt;
 
+    beginBatchedWrite();
     if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) == SQLITE_OK) {
         sqlite3_bind_int(stmt, 1, id);
 
@@ -210,6 +213,7 @@ void removeRecurringEntries(sqlite3 *db) {
         }
     }
     sqlite3_finalize(stmt);
+    endBatchedWrite();
 }
 // Function to remove savings goal by ID or Name after displaying the list
 void removeSavingsGoal(sqlite3 *db) {
@@ -222,7 +226,7 @@ void removeSavingsGoal(sqlite3 *db) {
 
     // Ask user to choose removal method
     printf("\nEnter 1 to remove by ID or 2 to remove by Name: ");
-    scanf("%d", &choice);
+    choice = getValidIntInput();
 
     if (choice == 1) {
         // Remove by ID
@@ -232,6 +236,7 @@ void removeSavingsGoal(sqlite3 *db) {
         const char *sql = "DELETE FROM savings_goals WHERE id = ?;";
         sqlite3_stmt *stmt;
 
+        beginBatchedWrite();
         if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) == SQLITE_OK) {
             sqlite3_bind_int(stmt, 1, goal_id);
             if (sqlite3_step(stmt) == SQLITE_DONE) {
@@ -241,16 +246,17 @@ void removeSavingsGoal(sqlite3 *db) {
             }
         }
         sqlite3_finalize(stmt);
+        endBatchedWrite();
 
     } else if (choice == 2) {
         // Remove by Name
         printf("Enter the name of the savings goal you want to remove: ");
-        getchar(); // Consume the newline character left by previous scanf
         getValidStringInput(goal_name, MAX_NAME_LENGTH);
 
         const char *sql = "DELETE FROM savings_goals WHERE name = ?;";
         sqlite3_stmt *stmt;
 
+        beginBatchedWrite();
         if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) == SQLITE_OK) {
             sqlite3_bind_text(stmt, 1, goal_name, -1, SQLITE_STATIC);
             if (sqlite3_step(stmt) == SQLITE_DONE) {
@@ -260,6 +266,7 @@ void removeSavingsGoal(sqlite3 *db) {
             }
         }
         sqlite3_finalize(stmt);
+        endBatchedWrite();
 
     } else {
         printf("Invalid choice.\n");
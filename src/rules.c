@@ -0,0 +1,682 @@
+#define _XOPEN_SOURCE 700
+#include "rules.h"
+#include "schema.h"
+#include "database.h"
+#include "batch.h"
+#include "journal.h"
+#include "dedupe.h"
+#include "category_limits.h"
+#include "utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <regex.h>
+#include <sqlite3.h>
+
+static const char *const rule_kind_names[] = {"exact", "prefix", "substring", "regex"};
+
+typedef struct {
+    int64_t id;
+    RuleKind kind;
+    char category[MAX_NAME_LENGTH];
+    double min_amount;
+    double max_amount;     // 0 = no upper bound
+    int64_t hits;          // Matches since the matcher was loaded
+    int next;              // Next rule with the same exact pattern or automaton state, or -1
+    regex_t regex;         // RULE_REGEX only
+} CompiledRule;
+
+typedef struct {
+    char *pattern;         // Lower-cased; NULL marks an empty slot
+    int first_rule;
+} ExactEntry;
+
+struct CategoryMatcher {
+    CompiledRule *rules;         // In precedence order, so a lower index always wins
+    int rule_count;
+    int first_regex;             // Index of the first regex rule (rule_count if none)
+    ExactEntry *exact;           // Open addressing, power-of-two capacity
+    unsigned int exact_capacity;
+    unsigned char classes[256];  // Byte -> automaton input class; 0 = in no pattern
+    int alphabet;
+    int *next;                   // Complete transition table: next[state * alphabet + class]
+    int *output;                 // First rule whose pattern ends at the state, or -1
+    int *dict;                   // Nearest proper suffix state with an output, or 0
+    int *depth;                  // Pattern length at the state, for prefix rules
+    int state_count;
+};
+
+// Append rule to the chain starting at *head; rules arrive in precedence order
+static void appendRule(CategoryMatcher *matcher, int *head, int rule) {
+    while (*head >= 0) {
+        head = &matcher->rules[*head].next;
+    }
+    *head = rule;
+}
+
+static void addExactPattern(CategoryMatcher *matcher, char *pattern, int rule) {
+    unsigned int mask = matcher->exact_capacity - 1;
+    unsigned int i = hashString(pattern) & mask;
+
+    while (matcher->exact[i].pattern != NULL && strcmp(matcher->exact[i].pattern, pattern) != 0) {
+        i = (i + 1) & mask;
+    }
+    if (matcher->exact[i].pattern == NULL) {
+        matcher->exact[i].pattern = pattern;
+        matcher->exact[i].first_rule = -1;
+    } else {
+        free(pattern);
+    }
+    appendRule(matcher, &matcher->exact[i].first_rule, rule);
+}
+
+// Build the Aho-Corasick automaton over the prefix and substring patterns
+static void buildAutomaton(CategoryMatcher *matcher, char **patterns) {
+    size_t total_length = 0;
+    for (int r = 0; r < matcher->rule_count; r++) {
+        RuleKind kind = matcher->rules[r].kind;
+        if (kind == RULE_PREFIX || kind == RULE_SUBSTRING) {
+            for (const unsigned char *c = (const unsigned char *)patterns[r]; *c; c++) {
+                if (matcher->classes[*c] == 0) {
+                    matcher->classes[*c] = (unsigned char)matcher->alphabet++;
+                }
+            }
+            total_length += strlen(patterns[r]);
+        }
+    }
+
+    int max_states = (int)total_length + 1;
+    int alphabet = matcher->alphabet;
+    matcher->next = calloc((size_t)max_states * alphabet, sizeof(int));
+    matcher->output = malloc(max_states * sizeof(int));
+    matcher->dict = calloc(max_states, sizeof(int));
+    matcher->depth = calloc(max_states, sizeof(int));
+    int *fail = calloc(max_states, sizeof(int));
+    int *queue = malloc(max_states * sizeof(int));
+    matcher->output[0] = -1;
+    matcher->state_count = 1;
+
+    // Trie of every pattern; 0 doubles as "no child" because no edge leads back to the root yet
+    for (int r = 0; r < matcher->rule_count; r++) {
+        RuleKind kind = matcher->rules[r].kind;
+        if (kind != RULE_PREFIX && kind != RULE_SUBSTRING) {
+            continue;
+        }
+        int state = 0;
+        for (const unsigned char *c = (const unsigned char *)patterns[r]; *c; c++) {
+            int *edge = &matcher->next[state * alphabet + matcher->classes[*c]];
+            if (*edge == 0) {
+                *edge = matcher->state_count++;
+                matcher->output[*edge] = -1;
+                matcher->depth[*edge] = matcher->depth[state] + 1;
+            }
+            state = *edge;
+        }
+        appendRule(matcher, &matcher->output[state], r);
+    }
+
+    // Breadth-first: set failure and dictionary links, and fill the missing edges so matching
+    // takes exactly one table lookup per input byte
+    int head = 0, tail = 0;
+    for (int c = 0; c < alphabet; c++) {
+        if (matcher->next[c] != 0) {
+            queue[tail++] = matcher->next[c];
+        }
+    }
+    while (head < tail) {
+        int state = queue[head++];
+        for (int c = 0; c < alphabet; c++) {
+            int *edge = &matcher->next[state * alphabet + c];
+            int fallback = matcher->next[fail[state] * alphabet + c];
+            if (*edge != 0) {
+                fail[*edge] = fallback;
+                matcher->dict[*edge] = matcher->output[fallback] >= 0 ? fallback : matcher->dict[fallback];
+                queue[tail++] = *edge;
+            } else {
+                *edge = fallback;
+            }
+        }
+    }
+    free(fail);
+    free(queue);
+}
+
+// Function to load the rules and compile them into a matcher
+CategoryMatcher *loadCategoryMatcher(sqlite3 *db) {
+    const char *sql = SCHEMA_SELECT_SQL(SCHEMA_CATEGORY_RULES)
+                      " ORDER BY CASE kind WHEN 'exact' THEN 0 WHEN 'prefix' THEN 1 WHEN 'substring' THEN 2 ELSE 3 END, "
+                      "priority DESC, id;";
+    sqlite3_stmt *stmt;
+
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        printf("SQLite Error: %s\n", sqlite3_errmsg(db));
+        return NULL;
+    }
+
+    CategoryMatcher *matcher = calloc(1, sizeof(CategoryMatcher));
+    char **patterns = NULL;
+    int capacity = 0, exact_count = 0;
+    CategoryRuleRow row;
+
+    matcher->alphabet = 1;   // Class 0 is every byte that appears in no pattern
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        schemaRead_category_rules(stmt, &row);
+        if (matcher->rule_count == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            matcher->rules = realloc(matcher->rules, capacity * sizeof(CompiledRule));
+            patterns = realloc(patterns, capacity * sizeof(char *));
+        }
+
+        CompiledRule *rule = &matcher->rules[matcher->rule_count];
+        memset(rule, 0, sizeof(CompiledRule));
+        rule->id = row.id;
+        rule->kind = RULE_REGEX;
+        for (int k = RULE_EXACT; k < RULE_REGEX; k++) {
+            if (strcmp(row.kind, rule_kind_names[k]) == 0) {
+                rule->kind = (RuleKind)k;
+            }
+        }
+        snprintf(rule->category, sizeof(rule->category), "%s", row.category);
+        rule->min_amount = row.min_amount;
+        rule->max_amount = row.max_amount;
+        rule->next = -1;
+
+        char *pattern = strdup(row.pattern);
+        for (char *c = pattern; *c; c++) {
+            *c = (char)tolower((unsigned char)*c);
+        }
+        if (*pattern == '\0' ||
+            (rule->kind == RULE_REGEX && regcomp(&rule->regex, pattern, REG_EXTENDED | REG_ICASE | REG_NOSUB) != 0)) {
+            printf("Warning: Rule %lld has an invalid pattern and is ignored.\n", (long long)row.id);
+            free(pattern);
+            continue;
+        }
+        if (rule->kind == RULE_EXACT) {
+            exact_count++;
+        }
+        if (rule->kind == RULE_REGEX && matcher->first_regex == 0) {
+            matcher->first_regex = matcher->rule_count + 1;   // Stored +1 until loading ends
+        }
+        patterns[matcher->rule_count++] = pattern;
+    }
+    sqlite3_finalize(stmt);
+    matcher->first_regex = matcher->first_regex ? matcher->first_regex - 1 : matcher->rule_count;
+
+    // Exact patterns go in a hash table sized for a load factor of at most one half
+    matcher->exact_capacity = 16;
+    while (matcher->exact_capacity < (unsigned int)exact_count * 2) {
+        matcher->exact_capacity *= 2;
+    }
+    matcher->exact = calloc(matcher->exact_capacity, sizeof(ExactEntry));
+    buildAutomaton(matcher, patterns);
+
+    for (int r = 0; r < matcher->rule_count; r++) {
+        if (matcher->rules[r].kind == RULE_EXACT) {
+            addExactPattern(matcher, patterns[r], r);   // Takes ownership of the pattern
+        } else {
+            free(patterns[r]);
+        }
+    }
+    free(patterns);
+    return matcher;
+}
+
+static int amountMatches(const CompiledRule *rule, double amount) {
+    return amount >= rule->min_amount && (rule->max_amount <= 0 || amount <= rule->max_amount);
+}
+
+// Function to find the category for a description; returns NULL when no rule matches.
+// Exact rules beat prefix rules, which beat substring rules, which beat regexes; within a
+// kind the higher priority, then the older rule, wins.
+const char *matchCategory(CategoryMatcher *matcher, const char *description, double amount, int64_t *rule_id) {
+    char text[INPUT_LINE_MAX];
+    size_t length = 0;
+    int best = matcher->rule_count;
+
+    while (description[length] != '\0' && length < sizeof(text) - 1) {
+        text[length] = (char)tolower((unsigned char)description[length]);
+        length++;
+    }
+    text[length] = '\0';
+
+    unsigned int mask = matcher->exact_capacity - 1;
+    for (unsigned int i = hashString(text) & mask; matcher->exact[i].pattern != NULL; i = (i + 1) & mask) {
+        if (strcmp(matcher->exact[i].pattern, text) == 0) {
+            for (int r = matcher->exact[i].first_rule; r >= 0; r = matcher->rules[r].next) {
+                if (amountMatches(&matcher->rules[r], amount)) {
+                    best = r;
+                    break;
+                }
+            }
+            break;
+        }
+    }
+
+    // Every prefix and substring rule ranks below every exact rule
+    if (best == matcher->rule_count && matcher->state_count > 1) {
+        int state = 0;
+        for (size_t i = 0; i < length; i++) {
+            state = matcher->next[state * matcher->alphabet + matcher->classes[(unsigned char)text[i]]];
+            int hit = matcher->output[state] >= 0 ? state : matcher->dict[state];
+            for (; hit > 0; hit = matcher->dict[hit]) {
+                for (int r = matcher->output[hit]; r >= 0 && r < best; r = matcher->rules[r].next) {
+                    if ((matcher->rules[r].kind == RULE_PREFIX && matcher->depth[hit] != (int)i + 1) ||
+                        !amountMatches(&matcher->rules[r], amount)) {
+                        continue;
+                    }
+                    best = r;
+                    break;
+                }
+            }
+        }
+    }
+
+    for (int r = matcher->first_regex; r < best; r++) {
+        if (amountMatches(&matcher->rules[r], amount) && regexec(&matcher->rules[r].regex, text, 0, NULL, 0) == 0) {
+            best = r;
+            break;
+        }
+    }
+
+    if (best == matcher->rule_count) {
+        if (rule_id != NULL) {
+            *rule_id = 0;
+        }
+        return NULL;
+    }
+    matcher->rules[best].hits++;
+    if (rule_id != NULL) {
+        *rule_id = matcher->rules[best].id;
+    }
+    return matcher->rules[best].category;
+}
+
+// Function to add the matcher's hit counts to the rules table and reset them
+void saveRuleHits(sqlite3 *db, CategoryMatcher *matcher) {
+    const char *sql = "UPDATE category_rules SET hits = hits + ? WHERE id = ?;";
+    sqlite3_stmt *stmt;
+
+    beginBatchedWrite();
+    sqlite3_exec(db, "SAVEPOINT rule_hits;", NULL, NULL, NULL);
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) == SQLITE_OK) {
+        for (int r = 0; r < matcher->rule_count; r++) {
+            if (matcher->rules[r].hits == 0) {
+                continue;
+            }
+            sqlite3_bind_int64(stmt, 1, matcher->rules[r].hits);
+            sqlite3_bind_int64(stmt, 2, matcher->rules[r].id);
+            sqlite3_step(stmt);
+            sqlite3_reset(stmt);
+            matcher->rules[r].hits = 0;
+        }
+    } else {
+        printf("SQLite Error: %s\n", sqlite3_errmsg(db));
+    }
+    sqlite3_finalize(stmt);
+    sqlite3_exec(db, "RELEASE rule_hits;", NULL, NULL, NULL);
+    endBatchedWrite();
+}
+
+void freeCategoryMatcher(CategoryMatcher *matcher) {
+    if (matcher == NULL) {
+        return;
+    }
+    for (int r = matcher->first_regex; r < matcher->rule_count; r++) {
+        regfree(&matcher->rules[r].regex);
+    }
+    for (unsigned int i = 0; i < matcher->exact_capacity; i++) {
+        free(matcher->exact[i].pattern);
+    }
+    free(matcher->exact);
+    free(matcher->rules);
+    free(matcher->next);
+    free(matcher->output);
+    free(matcher->dict);
+    free(matcher->depth);
+    free(matcher);
+}
+
+// Split off the next CSV field. A quoted field may contain commas, and "" stands for a quote.
+static char *nextCSVField(char **cursor) {
+    char *p = *cursor;
+    if (p == NULL) {
+        return NULL;
+    }
+    while (*p == ' ' || *p == '\t') {
+        p++;
+    }
+    if (*p != '"') {
+        *cursor = p;
+        return nextToken(cursor, ',');
+    }
+
+    char *field = ++p;
+    char *out = p;
+    while (*p != '\0') {
+        if (*p == '"') {
+            if (p[1] != '"') {
+                p++;
+                break;
+            }
+            p++;
+        }
+        *out++ = *p++;
+    }
+    while (*p != '\0' && *p != ',') {
+        p++;
+    }
+    *cursor = (*p == ',') ? p + 1 : NULL;
+    *out = '\0';
+    return field;
+}
+
+// Function to import a bank statement CSV of date,description,amount lines. Debits (negative
+// amounts) become expenses categorized by the rules; credits (positive amounts) become income.
+int importBankCSV(sqlite3 *db, const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        printf("Error: Could not open %s.\n", path);
+        return 0;
+    }
+    CategoryMatcher *matcher = loadCategoryMatcher(db);
+    if (matcher == NULL) {
+        close(fd);
+        return 0;
+    }
+
+    LineReader *reader = malloc(sizeof(LineReader));
+    initLineReader(reader, fd);
+
+    long long line_number = 0, imported = 0, categorized = 0, skipped = 0, duplicates = 0, credits = 0;
+    FingerprintSet added = {0};   // Rows from this file; identical rows within one statement are kept
+    double match_ms = 0;
+    struct timespec start, end, match_start, match_end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    // One transaction for the whole file unless batch mode or the journal already groups writes
+    int own_transaction = !batchModeEnabled() && !journalEnabled();
+    if (own_transaction && sqlite3_exec(db, "BEGIN;", NULL, NULL, NULL) != SQLITE_OK) {
+        printf("SQLite Error: %s\n", sqlite3_errmsg(db));
+        close(fd);
+        free(reader);
+        freeCategoryMatcher(matcher);
+        return 0;
+    }
+
+    char *line;
+    while ((line = readLine(reader)) != NULL) {
+        line_number++;
+        char *cursor = line;
+        char *date_text = nextCSVField(&cursor);
+        char *description = nextCSVField(&cursor);
+        char *amount_text = nextCSVField(&cursor);
+        int year, month, day;
+        double amount;
+
+        if (date_text == NULL || *date_text == '\0') {
+            continue;   // Blank line
+        }
+        if (description == NULL || amount_text == NULL || !parseDateToken(date_text, &year, &month, &day) ||
+            !parseDecimalToken(amount_text, &amount) || amount == 0) {
+            if (line_number > 1) {   // The first line may be a header
+                printf("Line %lld skipped: expected date,description,amount.\n", line_number);
+                skipped++;
+            }
+            continue;
+        }
+
+        char date[11];
+        snprintf(date, sizeof(date), "%04d-%02d-%02d", year, month, day);
+
+        // A credit (deposit, refund) is income; it has no category to match
+        if (amount > 0) {
+            uint64_t fingerprint = transactionFingerprint(FINGERPRINT_INCOME, date, (float)amount, NULL, NULL);
+            if (fingerprintSeen(fingerprint) && !fingerprintSetContains(&added, fingerprint)) {
+                duplicates++;
+            } else if (addIncomeRecord(db, (float)amount, date, NULL)) {
+                fingerprintSetAdd(&added, fingerprint);
+                credits++;
+            }
+            continue;
+        }
+        amount = -amount;
+
+        size_t length = strlen(description);
+        while (length > 0 && (description[length - 1] == ' ' || description[length - 1] == '\t')) {
+            description[--length] = '\0';
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &match_start);
+        const char *category = matchCategory(matcher, description, amount, NULL);
+        clock_gettime(CLOCK_MONOTONIC, &match_end);
+        match_ms += (match_end.tv_sec - match_start.tv_sec) * 1000.0 + (match_end.tv_nsec - match_start.tv_nsec) / 1e6;
+
+        int matched = (category != NULL);
+        if (!matched) {
+            category = RULES_FALLBACK_CATEGORY;
+        }
+
+        // A row already in the ledger before this import means the statements overlap
+        uint64_t fingerprint = transactionFingerprint(FINGERPRINT_EXPENSE, date, (float)amount, category, NULL);
+        if (fingerprintSeen(fingerprint) && !fingerprintSetContains(&added, fingerprint)) {
+            duplicates++;
+            continue;
+        }
+        if (addExpenseRecord(db, category, (float)amount, date, NULL)) {
+            fingerprintSetAdd(&added, fingerprint);
+            imported++;
+            categorized += matched;
+        }
+    }
+
+    int ok = 1;
+    if (own_transaction && sqlite3_exec(db, "COMMIT;", NULL, NULL, NULL) != SQLITE_OK) {
+        printf("SQLite Error: %s\n", sqlite3_errmsg(db));
+        sqlite3_exec(db, "ROLLBACK;", NULL, NULL, NULL);
+        // The in-memory fingerprints and category spend already count the rolled-back rows
+        initializeFingerprints(db);
+        loadCategoryLimits(db);
+        ok = 0;
+    }
+    if (ok) {
+        saveRuleHits(db, matcher);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    close(fd);
+    free(reader);
+    freeCategoryMatcher(matcher);
+    fingerprintSetFree(&added);
+
+    if (!ok) {
+        printf("\nImport of %s failed; nothing was added.\n", path);
+        return 0;
+    }
+    printf("\nImported %lld expenses from %s: %lld categorized by rules, %lld as %s.\n",
+           imported, path, categorized, imported - categorized, RULES_FALLBACK_CATEGORY);
+    printf("Imported %lld credits as income.\n", credits);
+    printf("%lld duplicates of existing rows rejected, %lld lines skipped.\n", duplicates, skipped);
+    printf("Matching took %.2f ms (%.0f rows/s); the import took %.2f ms.\n", match_ms,
+           match_ms > 0 ? (imported + duplicates) / (match_ms / 1000.0) : 0.0,
+           (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1e6);
+    return 1;
+}
+
+// Function to add a rule
+static void addCategoryRule(sqlite3 *db) {
+    char pattern[INPUT_LINE_MAX];
+    char category[MAX_NAME_LENGTH];
+    char text[32];
+    CategoryRuleRow row = {0};
+
+    printf("Match kind (1 = Exact, 2 = Prefix, 3 = Substring, 4 = Regex): ");
+    int kind = getValidIntInput();
+    if (kind < 1 || kind > 4) {
+        printf("Error: Invalid match kind.\n");
+        return;
+    }
+    printf("Enter pattern: ");
+    getValidStringInput(pattern, sizeof(pattern));
+    if (kind == 4) {
+        regex_t regex;
+        if (regcomp(&regex, pattern, REG_EXTENDED | REG_ICASE | REG_NOSUB) != 0) {
+            printf("Error: Invalid regular expression.\n");
+            return;
+        }
+        regfree(&regex);
+    }
+    printf("Enter category: ");
+    getValidStringInput(category, sizeof(category));
+
+    printf("Minimum amount (blank for none): $");
+    if (getOptionalStringInput(text, sizeof(text)) > 0 && !parseDecimalToken(text, &row.min_amount)) {
+        printf("Error: Invalid amount.\n");
+        return;
+    }
+    printf("Maximum amount (blank for none): $");
+    if (getOptionalStringInput(text, sizeof(text)) > 0 && !parseDecimalToken(text, &row.max_amount)) {
+        printf("Error: Invalid amount.\n");
+        return;
+    }
+    printf("Priority within its kind (blank for 0, higher wins): ");
+    if (getOptionalStringInput(text, sizeof(text)) > 0 && !parseIntToken(text, &row.priority)) {
+        printf("Error: Invalid priority.\n");
+        return;
+    }
+
+    row.kind = rule_kind_names[kind - 1];
+    row.pattern = pattern;
+    row.category = category;
+
+    sqlite3_stmt *stmt;
+    beginBatchedWrite();
+    if (sqlite3_prepare_v2(db, SCHEMA_INSERT_SQL(SCHEMA_CATEGORY_RULES) ";", -1, &stmt, NULL) == SQLITE_OK) {
+        schemaBind_category_rules(stmt, &row);
+        if (sqlite3_step(stmt) == SQLITE_DONE) {
+            printf("Rule %lld added: %s \"%s\" -> %s\n", (long long)sqlite3_last_insert_rowid(db), row.kind,
+                   pattern, category);
+        } else {
+            printf("Error: Failed to add rule: %s\n", sqlite3_errmsg(db));
+        }
+    }
+    sqlite3_finalize(stmt);
+    endBatchedWrite();
+}
+
+// Function to list the rules in the order they are tried, with their hit counts
+static void showCategoryRules(sqlite3 *db) {
+    const char *sql = SCHEMA_SELECT_SQL(SCHEMA_CATEGORY_RULES)
+                      " ORDER BY CASE kind WHEN 'exact' THEN 0 WHEN 'prefix' THEN 1 WHEN 'substring' THEN 2 ELSE 3 END, "
+                      "priority DESC, id;";
+    sqlite3_stmt *stmt;
+    CategoryRuleRow row;
+    int found = 0;
+
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        printf("SQLite Error: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+    printf("\n--- Category Rules (in match order) ---\n");
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        schemaRead_category_rules(stmt, &row);
+        printf("[ID: %lld] %-9s \"%s\" -> %s", (long long)row.id, row.kind, row.pattern, row.category);
+        if (row.max_amount > 0) {
+            printf(" ($%.2f - $%.2f)", row.min_amount, row.max_amount);
+        } else if (row.min_amount > 0) {
+            printf(" ($%.2f and up)", row.min_amount);
+        }
+        printf(", priority %d, %lld hits\n", row.priority, (long long)row.hits);
+        found = 1;
+    }
+    sqlite3_finalize(stmt);
+    if (!found) {
+        printf("No rules yet.\n");
+    }
+}
+
+// Function to delete a rule by id
+static void removeCategoryRule(sqlite3 *db) {
+    sqlite3_stmt *stmt;
+
+    printf("Enter rule ID to delete: ");
+    int id = getValidIntInput();
+
+    beginBatchedWrite();
+    if (sqlite3_prepare_v2(db, "DELETE FROM category_rules WHERE id = ?;", -1, &stmt, NULL) == SQLITE_OK) {
+        sqlite3_bind_int(stmt, 1, id);
+        if (sqlite3_step(stmt) == SQLITE_DONE && sqlite3_changes(db) > 0) {
+            printf("Rule %d deleted.\n", id);
+        } else {
+            printf("Error: No rule with ID %d.\n", id);
+        }
+    }
+    sqlite3_finalize(stmt);
+    endBatchedWrite();
+}
+
+// Function to show which rule a description and amount would match, without counting a hit
+static void testCategoryRules(sqlite3 *db) {
+    char description[INPUT_LINE_MAX];
+    int64_t rule_id;
+
+    printf("Enter description: ");
+    getValidStringInput(description, sizeof(description));
+    printf("Enter amount: $");
+    float amount = getValidFloatInput();
+
+    CategoryMatcher *matcher = loadCategoryMatcher(db);
+    if (matcher == NULL) {
+        return;
+    }
+    const char *category = matchCategory(matcher, description, amount, &rule_id);
+    if (category != NULL) {
+        printf("Category: %s (rule %lld)\n", category, (long long)rule_id);
+    } else {
+        printf("No rule matches; it would be imported as %s.\n", RULES_FALLBACK_CATEGORY);
+    }
+    freeCategoryMatcher(matcher);
+}
+
+// Function to manage category rules and bank imports
+void manageCategoryRules(sqlite3 *db) {
+    char path[INPUT_LINE_MAX];
+    int choice;
+    do {
+        printf("\n--- Category Rules & Bank Import ---\n");
+        printf("1. Add Rule\n");
+        printf("2. View Rules\n");
+        printf("3. Remove Rule\n");
+        printf("4. Test a Description\n");
+        printf("5. Import Bank CSV\n");
+        printf("6. Return to Reports & Tools\n");
+        printf("Enter your choice: ");
+        choice = getValidIntInput();
+
+        switch (choice) {
+            case 1:
+                addCategoryRule(db);
+                break;
+            case 2:
+                showCategoryRules(db);
+                break;
+            case 3:
+                removeCategoryRule(db);
+                break;
+            case 4:
+                testCategoryRules(db);
+                break;
+            case 5:
+                printf("Enter CSV file (date,description,amount per line): ");
+                getValidStringInput(path, sizeof(path));
+                importBankCSV(db, path);
+                break;
+            case 6:
+                return;
+            default:
+                printf("Invalid choice. Try again.\n");
+        }
+    } while (choice != 6);
+}
@@ -0,0 +1,246 @@
+#define _XOPEN_SOURCE 700
+#include "savings.h"
+#include "batch.h"
+#include "utils.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <sqlite3.h>
+
+// saved_amount on savings_goals is a cached total of goal_contributions, kept current by
+// triggers so every existing reader of saved_amount stays correct
+static const char *savings_schema_sql =
+    "CREATE TABLE IF NOT EXISTS goal_contributions ("
+    "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+    "goal_id INTEGER NOT NULL, "
+    "amount REAL NOT NULL, "
+    "date TEXT NOT NULL);"
+    // Covering index: a goal's whole contribution series is one range scan
+    "CREATE INDEX IF NOT EXISTS idx_goal_contributions_goal_date ON goal_contributions(goal_id, date, amount);";
+
+static const char *savings_triggers_sql =
+    "CREATE TRIGGER IF NOT EXISTS goal_contributions_ai AFTER INSERT ON goal_contributions BEGIN "
+    "UPDATE savings_goals SET saved_amount = IFNULL(saved_amount, 0) + new.amount WHERE id = new.goal_id; "
+    "END;"
+    "CREATE TRIGGER IF NOT EXISTS goal_contributions_ad AFTER DELETE ON goal_contributions BEGIN "
+    "UPDATE savings_goals SET saved_amount = saved_amount - old.amount WHERE id = old.goal_id; "
+    "END;"
+    "CREATE TRIGGER IF NOT EXISTS goal_contributions_au AFTER UPDATE OF goal_id, amount ON goal_contributions BEGIN "
+    "UPDATE savings_goals SET saved_amount = saved_amount - old.amount WHERE id = old.goal_id; "
+    "UPDATE savings_goals SET saved_amount = IFNULL(saved_amount, 0) + new.amount WHERE id = new.goal_id; "
+    "END;"
+    "CREATE TRIGGER IF NOT EXISTS savings_goals_contributions_ad AFTER DELETE ON savings_goals BEGIN "
+    "DELETE FROM goal_contributions WHERE goal_id = old.id; "
+    "END;";
+
+// Existing balances become one opening contribution dated the day the ledger was created
+static const char *savings_backfill_sql =
+    "INSERT INTO goal_contributions (goal_id, amount, date) "
+    "SELECT id, saved_amount, date('now', 'localtime') FROM savings_goals WHERE IFNULL(saved_amount, 0) != 0;";
+
+// Function to create the contribution ledger and the triggers that maintain saved_amount
+int initializeSavingsLedger(sqlite3 *db) {
+    sqlite3_stmt *stmt;
+    int exists = 0;
+
+    const char *exists_sql = "SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'goal_contributions';";
+    if (sqlite3_prepare_v2(db, exists_sql, -1, &stmt, NULL) == SQLITE_OK) {
+        exists = (sqlite3_step(stmt) == SQLITE_ROW);
+    }
+    sqlite3_finalize(stmt);
+
+    // The backfill runs before the triggers exist so it doesn't add to saved_amount twice
+    char *err_msg = NULL;
+    if (sqlite3_exec(db, "BEGIN;", 0, 0, &err_msg) != SQLITE_OK ||
+        sqlite3_exec(db, savings_schema_sql, 0, 0, &err_msg) != SQLITE_OK ||
+        (!exists && sqlite3_exec(db, savings_backfill_sql, 0, 0, &err_msg) != SQLITE_OK) ||
+        sqlite3_exec(db, savings_triggers_sql, 0, 0, &err_msg) != SQLITE_OK ||
+        sqlite3_exec(db, "COMMIT;", 0, 0, &err_msg) != SQLITE_OK) {
+        printf("Error: Failed to create savings ledger: %s\n", err_msg);
+        sqlite3_free(err_msg);
+        sqlite3_exec(db, "ROLLBACK;", 0, 0, NULL);
+        return 0;
+    }
+    return 1;
+}
+
+// Function to post contributions in one atomic step; returns how many were posted.
+// Contributions to unknown goals are skipped and reported.
+int postGoalContributions(sqlite3 *db, const GoalContribution *contributions, int count) {
+    const char *sql = "INSERT INTO goal_contributions (goal_id, amount, date) "
+                      "SELECT ?1, ?2, ?3 WHERE EXISTS (SELECT 1 FROM savings_goals WHERE id = ?1);";
+    sqlite3_stmt *stmt;
+    int posted = 0;
+
+    beginBatchedWrite();
+    // A savepoint nests inside an open batch transaction and starts one otherwise
+    if (sqlite3_exec(db, "SAVEPOINT post_contributions;", 0, 0, NULL) != SQLITE_OK ||
+        sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        printf("SQLite Error: %s\n", sqlite3_errmsg(db));
+        sqlite3_exec(db, "RELEASE post_contributions;", 0, 0, NULL);
+        endBatchedWrite();
+        return 0;
+    }
+
+    for (int i = 0; i < count; i++) {
+        sqlite3_bind_int(stmt, 1, contributions[i].goal_id);
+        sqlite3_bind_double(stmt, 2, contributions[i].amount);
+        sqlite3_bind_text(stmt, 3, contributions[i].date, -1, SQLITE_STATIC);
+
+        if (sqlite3_step(stmt) != SQLITE_DONE) {
+            printf("Error: Failed to post contribution: %s\n", sqlite3_errmsg(db));
+            sqlite3_finalize(stmt);
+            sqlite3_exec(db, "ROLLBACK TO post_contributions; RELEASE post_contributions;", 0, 0, NULL);
+            endBatchedWrite();
+            return 0;
+        }
+        if (sqlite3_changes(db) == 0) {
+            printf("Error: Goal ID %d not found.\n", contributions[i].goal_id);
+        } else {
+            posted++;
+        }
+        sqlite3_reset(stmt);
+    }
+    sqlite3_finalize(stmt);
+    sqlite3_exec(db, "RELEASE post_contributions;", 0, 0, NULL);
+    endBatchedWrite();
+    return posted;
+}
+
+// Function to post several contributions, one "goal_id amount [YYYY-MM-DD]" per line
+void postContributionBatch(sqlite3 *db) {
+    GoalContribution batch[64];
+    int count = 0, total = 0;
+    char line[INPUT_LINE_MAX];
+
+    time_t t = time(NULL);
+    char today[11];
+    strftime(today, sizeof(today), "%Y-%m-%d", localtime(&t));
+
+    printf("Enter contributions as \"goal_id amount [YYYY-MM-DD]\", one per line. Blank line to finish.\n");
+    while (1) {
+        printf("> ");
+        if (getOptionalStringInput(line, sizeof(line)) == 0) {
+            break;
+        }
+
+        char *cursor = line;
+        char *id_text = nextToken(&cursor, 0);
+        char *amount_text = nextToken(&cursor, 0);
+        char *date_text = nextToken(&cursor, 0);
+        GoalContribution *entry = &batch[count];
+        int year, month, day;
+
+        if (amount_text == NULL || !parseIntToken(id_text, &entry->goal_id) ||
+            !parseDecimalToken(amount_text, &entry->amount) || entry->amount == 0) {
+            printf("Error: Expected a goal ID and a non-zero amount.\n");
+            continue;
+        }
+        if (date_text == NULL) {
+            snprintf(entry->date, sizeof(entry->date), "%s", today);
+        } else if (parseDateToken(date_text, &year, &month, &day)) {
+            snprintf(entry->date, sizeof(entry->date), "%04d-%02d-%02d", year, month, day);
+        } else {
+            printf("Error: Invalid date format. Please enter a date in the format YYYY-MM-DD.\n");
+            continue;
+        }
+
+        if (++count == (int)(sizeof(batch) / sizeof(batch[0]))) {
+            total += postGoalContributions(db, batch, count);
+            count = 0;
+        }
+    }
+    total += postGoalContributions(db, batch, count);
+    printf("%d contribution(s) posted.\n", total);
+}
+
+// Function to report each goal's progress, savings velocity and projected completion
+void showSavingsProgress(sqlite3 *db) {
+    const char *goals_sql = "SELECT id, name, target_amount, saved_amount, due_date FROM savings_goals ORDER BY id;";
+    // One range scan of the covering index per goal
+    const char *series_sql =
+        "SELECT COUNT(*), IFNULL(SUM(amount), 0), MIN(date), "
+        "IFNULL(SUM(CASE WHEN date > date('now', 'localtime', ?2) THEN amount END), 0), "
+        "julianday('now', 'localtime', 'start of day') - julianday(MIN(date)) "
+        "FROM goal_contributions WHERE goal_id = ?1;";
+    sqlite3_stmt *goals, *series;
+
+    if (sqlite3_prepare_v2(db, goals_sql, -1, &goals, NULL) != SQLITE_OK ||
+        sqlite3_prepare_v2(db, series_sql, -1, &series, NULL) != SQLITE_OK) {
+        printf("SQLite Error: %s\n", sqlite3_errmsg(db));
+        sqlite3_finalize(goals);
+        return;
+    }
+
+    char recent_window[16];
+    snprintf(recent_window, sizeof(recent_window), "-%d days", SAVINGS_RECENT_DAYS);
+    time_t now = time(NULL);
+
+    printf("\n--- Savings Progress ---\n");
+    int found = 0;
+    while (sqlite3_step(goals) == SQLITE_ROW) {
+        int goal_id = sqlite3_column_int(goals, 0);
+        const char *name = (const char *)sqlite3_column_text(goals, 1);
+        double target = sqlite3_column_double(goals, 2);
+        double saved = sqlite3_column_double(goals, 3);
+        const char *due_date = (const char *)sqlite3_column_text(goals, 4);
+        found = 1;
+
+        printf("\n[ID: %d] %s: $%.2f / $%.2f (%.2f%% complete), Due: %s\n", goal_id, name, saved, target,
+               target > 0 ? saved / target * 100 : 0, due_date ? due_date : "none");
+
+        sqlite3_bind_int(series, 1, goal_id);
+        sqlite3_bind_text(series, 2, recent_window, -1, SQLITE_STATIC);
+        if (sqlite3_step(series) != SQLITE_ROW || sqlite3_column_int(series, 0) == 0) {
+            printf("  No contributions yet.\n");
+            sqlite3_reset(series);
+            continue;
+        }
+        int contributions = sqlite3_column_int(series, 0);
+        double contributed = sqlite3_column_double(series, 1);
+        const char *first_date = (const char *)sqlite3_column_text(series, 2);
+        double recent = sqlite3_column_double(series, 3);
+        double span_days = sqlite3_column_double(series, 4) + 1;   // Count the first day itself
+        if (span_days < 1) {
+            span_days = 1;
+        }
+
+        double per_day = contributed / span_days;
+        printf("  %d contribution(s) since %s, $%.2f per month (last %d days: $%.2f)\n",
+               contributions, first_date, per_day * 30.44, SAVINGS_RECENT_DAYS, recent);
+
+        double remaining = target - saved;
+        if (remaining <= 0) {
+            printf("  Goal reached.\n");
+        } else if (per_day <= 0) {
+            printf("  No progress at the current rate.\n");
+        } else {
+            time_t eta = now + (time_t)(remaining / per_day * 86400);
+            char eta_date[11];
+            strftime(eta_date, sizeof(eta_date), "%Y-%m-%d", localtime(&eta));
+
+            struct tm due_tm = {0};
+            if (due_date != NULL && strptime(due_date, "%Y-%m-%d", &due_tm) != NULL) {
+                due_tm.tm_isdst = -1;
+                double days_left = difftime(mktime(&due_tm), now) / 86400;
+                if (eta <= mktime(&due_tm)) {
+                    printf("  On track: projected to finish %s.\n", eta_date);
+                } else if (days_left > 0) {
+                    printf("  Behind: projected to finish %s. Save $%.2f per month to finish on time.\n",
+                           eta_date, remaining / days_left * 30.44);
+                } else {
+                    printf("  Past due: projected to finish %s.\n", eta_date);
+                }
+            } else {
+                printf("  Projected to finish %s.\n", eta_date);
+            }
+        }
+        sqlite3_reset(series);
+    }
+    sqlite3_finalize(series);
+    sqlite3_finalize(goals);
+
+    if (!found) {
+        printf("No savings goals found.\n");
+    }
+}
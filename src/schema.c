@@ -0,0 +1,72 @@
+#define _XOPEN_SOURCE 700
+#include "schema.h"
+#include "utils.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <sqlite3.h>
+
+// Export one table to <dir>/<table>.csv; expands to a block that adds the row count to total
+#define EXPORT_TABLE_CSV(...) EXPORT_TABLE_CSV_(__VA_ARGS__)
+#define EXPORT_TABLE_CSV_(table, Row, KEY, COLUMNS) { \
+        char path[1100]; \
+        snprintf(path, sizeof(path), "%s/%s.csv", dir, #table); \
+        FILE *out = fopen(path, "w"); \
+        sqlite3_stmt *stmt; \
+        long long rows = 0; \
+        if (out == NULL) { \
+            printf("Error: Could not create %s.\n", path); \
+            ok = 0; \
+        } else if (sqlite3_prepare_v2(db, SCHEMA_SELECT_SQL(table, Row, KEY, COLUMNS) " ORDER BY 1;", -1, &stmt, NULL) != SQLITE_OK) { \
+            printf("SQLite Error: %s\n", sqlite3_errmsg(db)); \
+            fclose(out); \
+            ok = 0; \
+        } else { \
+            Row row; \
+            fputs(SCHEMA_CSV_HEADER(table, Row, KEY, COLUMNS), out); \
+            while (sqlite3_step(stmt) == SQLITE_ROW) { \
+                schemaRead_##table(stmt, &row); \
+                schemaWriteCSV_##table(out, stmt, &row); \
+                rows++; \
+            } \
+            sqlite3_finalize(stmt); \
+            if (fclose(out) != 0) { \
+                printf("Error: Could not write %s.\n", path); \
+                ok = 0; \
+            } \
+            printf("%-22s %10lld rows\n", #table, rows); \
+            total += rows; \
+        } \
+    }
+
+// Function to write every core table to its own CSV file in dir
+int exportTablesToCSV(sqlite3 *db, const char *dir) {
+    struct timespec start, end;
+    long long total = 0;
+    int ok = 1;
+
+    mkdir(dir, 0755);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    // One read transaction so all files describe the same moment
+    sqlite3_exec(db, "SAVEPOINT export_tables;", NULL, NULL, NULL);
+    SCHEMA_TABLES(EXPORT_TABLE_CSV)
+    sqlite3_exec(db, "RELEASE export_tables;", NULL, NULL, NULL);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("Exported %lld rows to %s/ in %.2f ms.\n", total, dir,
+           (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1e6);
+    return ok;
+}
+
+// Function to prompt for a directory and export the tables to it
+void exportTablesPrompt(sqlite3 *db) {
+    char dir[INPUT_LINE_MAX];
+
+    printf("Export directory (blank for %s): ", EXPORT_DIR);
+    if (getOptionalStringInput(dir, sizeof(dir)) == 0) {
+        snprintf(dir, sizeof(dir), "%s", EXPORT_DIR);
+    }
+    exportTablesToCSV(db, dir);
+}
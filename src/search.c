@@ -0,0 +1,235 @@
+#define _XOPEN_SOURCE 700
+#include "search.h"
+#include "currency.h"
+#include "utils.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <sqlite3.h>
+
+// The FTS rowid encodes the source so triggers can update or delete an entry by key:
+// rowid = ref_id * 4 + kind, with kind 1 = category, 2 = recurring entry, 3 = savings goal.
+static const char *search_schema_sql =
+    "CREATE VIRTUAL TABLE IF NOT EXISTS search_index USING fts5("
+    "text, kind UNINDEXED, ref_id UNINDEXED, prefix = '2 3');"
+
+    // Running totals per expense category, maintained by triggers on expenses. The triggers
+    // are plain SQL, so any connection can write expenses: total sums the base-currency rows
+    // only, and the foreign_count rows in other currencies are converted when read. The id is
+    // the search key; an INTEGER PRIMARY KEY keeps it stable across VACUUM.
+    "CREATE TABLE IF NOT EXISTS category_totals ("
+    "id INTEGER PRIMARY KEY, "
+    "category TEXT NOT NULL UNIQUE, "
+    "total REAL NOT NULL DEFAULT 0, "
+    "count INTEGER NOT NULL DEFAULT 0, "
+    "foreign_count INTEGER NOT NULL DEFAULT 0);"
+
+    "CREATE TRIGGER IF NOT EXISTS category_totals_ai AFTER INSERT ON category_totals BEGIN "
+    "INSERT INTO search_index (rowid, text, kind, ref_id) VALUES (new.id * 4 + 1, new.category, 'category', new.id); "
+    "END;"
+    "CREATE TRIGGER IF NOT EXISTS category_totals_ad AFTER DELETE ON category_totals BEGIN "
+    "DELETE FROM search_index WHERE rowid = old.id * 4 + 1; "
+    "END;";
+
+// Ledgers with an older category_totals drop it, its index entries and the expense triggers
+// that fed it; the schema and category backfill then recreate them
+static const char *category_rebuild_sql =
+    "DROP TRIGGER IF EXISTS expenses_search_ai;"
+    "DROP TRIGGER IF EXISTS expenses_search_ad;"
+    "DROP TRIGGER IF EXISTS expenses_search_au;"
+    "DROP TRIGGER IF EXISTS category_totals_ai;"
+    "DROP TRIGGER IF EXISTS category_totals_ad;"
+    "DELETE FROM search_index WHERE kind = 'category';"
+    "DROP TABLE category_totals;";
+
+#define BASE_ROW(row) "IFNULL(" row ".currency, '') = ''"
+
+static const char *expense_triggers_sql =
+    "CREATE TRIGGER IF NOT EXISTS expenses_search_ai AFTER INSERT ON expenses BEGIN "
+    "INSERT INTO category_totals (category, total, count, foreign_count) "
+    "SELECT new.category, CASE WHEN " BASE_ROW("new") " THEN new.amount ELSE 0 END, 1, NOT " BASE_ROW("new") " "
+    "WHERE new.category IS NOT NULL "
+    "ON CONFLICT(category) DO UPDATE SET total = total + excluded.total, count = count + 1, "
+    "foreign_count = foreign_count + excluded.foreign_count; "
+    "END;"
+    "CREATE TRIGGER IF NOT EXISTS expenses_search_ad AFTER DELETE ON expenses BEGIN "
+    "UPDATE category_totals SET total = total - CASE WHEN " BASE_ROW("old") " THEN old.amount ELSE 0 END, "
+    "count = count - 1, foreign_count = foreign_count - NOT " BASE_ROW("old") " WHERE category = old.category; "
+    "DELETE FROM category_totals WHERE category = old.category AND count <= 0; "
+    "END;"
+    "CREATE TRIGGER IF NOT EXISTS expenses_search_au AFTER UPDATE OF category, amount, currency ON expenses BEGIN "
+    "UPDATE category_totals SET total = total - CASE WHEN " BASE_ROW("old") " THEN old.amount ELSE 0 END, "
+    "count = count - 1, foreign_count = foreign_count - NOT " BASE_ROW("old") " WHERE category = old.category; "
+    "DELETE FROM category_totals WHERE category = old.category AND count <= 0; "
+    "INSERT INTO category_totals (category, total, count, foreign_count) "
+    "SELECT new.category, CASE WHEN " BASE_ROW("new") " THEN new.amount ELSE 0 END, 1, NOT " BASE_ROW("new") " "
+    "WHERE new.category IS NOT NULL "
+    "ON CONFLICT(category) DO UPDATE SET total = total + excluded.total, count = count + 1, "
+    "foreign_count = foreign_count + excluded.foreign_count; "
+    "END;";
+
+static const char *search_triggers_sql =
+    "CREATE TRIGGER IF NOT EXISTS recurring_search_ai AFTER INSERT ON recurring BEGIN "
+    "INSERT INTO search_index (rowid, text, kind, ref_id) VALUES (new.id * 4 + 2, new.description, 'recurring', new.id); "
+    "END;"
+    "CREATE TRIGGER IF NOT EXISTS recurring_search_ad AFTER DELETE ON recurring BEGIN "
+    "DELETE FROM search_index WHERE rowid = old.id * 4 + 2; "
+    "END;"
+    "CREATE TRIGGER IF NOT EXISTS recurring_search_au AFTER UPDATE OF description ON recurring BEGIN "
+    "UPDATE search_index SET text = new.description WHERE rowid = old.id * 4 + 2; "
+    "END;"
+
+    "CREATE TRIGGER IF NOT EXISTS savings_goals_search_ai AFTER INSERT ON savings_goals BEGIN "
+    "INSERT INTO search_index (rowid, text, kind, ref_id) VALUES (new.id * 4 + 3, new.name, 'goal', new.id); "
+    "END;"
+    "CREATE TRIGGER IF NOT EXISTS savings_goals_search_ad AFTER DELETE ON savings_goals BEGIN "
+    "DELETE FROM search_index WHERE rowid = old.id * 4 + 3; "
+    "END;"
+    "CREATE TRIGGER IF NOT EXISTS savings_goals_search_au AFTER UPDATE OF name ON savings_goals BEGIN "
+    "UPDATE search_index SET text = new.name WHERE rowid = old.id * 4 + 3; "
+    "END;";
+
+// Fill the index from rows that existed before search was introduced
+static const char *category_backfill_sql =
+    "INSERT INTO category_totals (category, total, count, foreign_count) "
+    "SELECT category, SUM(CASE WHEN " BASE_ROW("expenses") " THEN amount ELSE 0 END), COUNT(*), "
+    "SUM(NOT " BASE_ROW("expenses") ") FROM expenses WHERE category IS NOT NULL GROUP BY category;";
+static const char *search_backfill_sql =
+    "INSERT INTO search_index (rowid, text, kind, ref_id) "
+    "SELECT id * 4 + 2, description, 'recurring', id FROM recurring;"
+    "INSERT INTO search_index (rowid, text, kind, ref_id) "
+    "SELECT id * 4 + 3, name, 'goal', id FROM savings_goals;";
+
+// Function to create the search index and the triggers that keep it in sync
+int initializeSearchIndex(sqlite3 *db) {
+    sqlite3_stmt *stmt;
+    int exists = 0;
+
+    const char *exists_sql = "SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'search_index';";
+    if (sqlite3_prepare_v2(db, exists_sql, -1, &stmt, NULL) == SQLITE_OK) {
+        exists = (sqlite3_step(stmt) == SQLITE_ROW);
+    }
+    sqlite3_finalize(stmt);
+
+    // Older tables were keyed on the implicit rowid, or summed every currency together
+    int current = 0;
+    const char *current_sql = "SELECT 1 FROM pragma_table_info('category_totals') WHERE name = 'foreign_count';";
+    if (sqlite3_prepare_v2(db, current_sql, -1, &stmt, NULL) == SQLITE_OK) {
+        current = (sqlite3_step(stmt) == SQLITE_ROW);
+    }
+    sqlite3_finalize(stmt);
+    int rebuild = exists && !current;
+
+    char *err_msg = NULL;
+    if (sqlite3_exec(db, "BEGIN;", 0, 0, &err_msg) != SQLITE_OK ||
+        (rebuild && sqlite3_exec(db, category_rebuild_sql, 0, 0, &err_msg) != SQLITE_OK) ||
+        sqlite3_exec(db, search_schema_sql, 0, 0, &err_msg) != SQLITE_OK ||
+        ((!exists || rebuild) && sqlite3_exec(db, category_backfill_sql, 0, 0, &err_msg) != SQLITE_OK) ||
+        (!exists && sqlite3_exec(db, search_backfill_sql, 0, 0, &err_msg) != SQLITE_OK) ||
+        sqlite3_exec(db, expense_triggers_sql, 0, 0, &err_msg) != SQLITE_OK ||
+        sqlite3_exec(db, search_triggers_sql, 0, 0, &err_msg) != SQLITE_OK ||
+        sqlite3_exec(db, "COMMIT;", 0, 0, &err_msg) != SQLITE_OK) {
+        printf("Error: Failed to create search index: %s\n", err_msg);
+        sqlite3_free(err_msg);
+        sqlite3_exec(db, "ROLLBACK;", 0, 0, NULL);
+        return 0;
+    }
+    return 1;
+}
+
+// Turn free text into an FTS5 query where every word is a quoted prefix term
+static void buildMatchQuery(const char *text, char *query, size_t size) {
+    char words[INPUT_LINE_MAX];
+    snprintf(words, sizeof(words), "%s", text);
+
+    size_t length = 0;
+    char *cursor = words;
+    char *word;
+    query[0] = '\0';
+    while ((word = nextToken(&cursor, 0)) != NULL && length + 8 < size) {
+        query[length++] = '"';
+        for (; *word && length + 5 < size; word++) {
+            if (*word == '"') {
+                query[length++] = '"';   // Escape embedded quotes
+            }
+            query[length++] = *word;
+        }
+        query[length++] = '"';
+        query[length++] = '*';
+        query[length++] = ' ';
+        query[length] = '\0';
+    }
+}
+
+// Function to search categories, recurring descriptions and goal names
+void searchLedger(sqlite3 *db, const char *text) {
+    char query[2 * INPUT_LINE_MAX];
+    buildMatchQuery(text, query, sizeof(query));
+    if (query[0] == '\0') {
+        printf("Error: Search text cannot be empty.\n");
+        return;
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    const char *sql =
+        "SELECT s.kind, s.text, " CATEGORY_TOTAL_SQL ", c.count, r.type, r.amount, g.target_amount, g.saved_amount "
+        "FROM search_index s "
+        "LEFT JOIN category_totals c ON s.kind = 'category' AND c.id = s.ref_id "
+        "LEFT JOIN recurring r ON s.kind = 'recurring' AND r.id = s.ref_id "
+        "LEFT JOIN savings_goals g ON s.kind = 'goal' AND g.id = s.ref_id "
+        "WHERE search_index MATCH ? ORDER BY rank LIMIT ?;";
+    sqlite3_stmt *stmt;
+
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        printf("SQLite Error: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+    sqlite3_bind_text(stmt, 1, query, -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 2, SEARCH_MAX_RESULTS);
+
+    printf("\n--- Search Results for \"%s\" ---\n", text);
+    int found = 0;
+    double expense_total = 0, recurring_total = 0, saved_total = 0;
+
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        const char *kind = (const char *)sqlite3_column_text(stmt, 0);
+        const char *name = (const char *)sqlite3_column_text(stmt, 1);
+
+        if (strcmp(kind, "category") == 0) {
+            double total = sqlite3_column_double(stmt, 2);
+            printf("[Category] %s: $%.2f across %d expense(s)\n", name, total, sqlite3_column_int(stmt, 3));
+            expense_total += total;
+        } else if (strcmp(kind, "recurring") == 0) {
+            double amount = sqlite3_column_double(stmt, 5);
+            printf("[Recurring %s] %s: $%.2f\n", sqlite3_column_text(stmt, 4), name, amount);
+            recurring_total += amount;
+        } else {
+            double saved = sqlite3_column_double(stmt, 7);
+            printf("[Goal] %s: $%.2f / $%.2f\n", name, saved, sqlite3_column_double(stmt, 6));
+            saved_total += saved;
+        }
+        found++;
+    }
+    sqlite3_finalize(stmt);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    reportMissingRates();
+    if (!found) {
+        printf("No matches found.\n");
+    } else {
+        printf("\nMatched Expenses: $%.2f, Recurring: $%.2f, Saved: $%.2f\n", expense_total, recurring_total, saved_total);
+    }
+    printf("%d match(es) in %.2f ms.\n", found,
+           (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1e6);
+}
+
+// Function to prompt for search text and show the matches
+void searchTransactions(sqlite3 *db) {
+    char text[INPUT_LINE_MAX];
+
+    printf("Enter search text (words or prefixes): ");
+    getValidStringInput(text, sizeof(text));
+    searchLedger(db, text);
+}
@@ -0,0 +1,544 @@
+#define _XOPEN_SOURCE 700
+#include "snapshot.h"
+#include "currency.h"
+#include "utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sqlite3.h>
+
+#define ALIGN8(n) (((n) + 7) & ~(int64_t)7)
+
+// Pack a YYYY-MM-DD date into YYYYMMDD without going through libc parsing
+static int32_t packDate(const char *date) {
+    if (date == NULL || strlen(date) < 10 || date[4] != '-' || date[7] != '-') {
+        return 0;
+    }
+    int32_t packed = 0;
+    for (int i = 0; i < 10; i++) {
+        if (i == 4 || i == 7) {
+            continue;
+        }
+        if (date[i] < '0' || date[i] > '9') {
+            return 0;
+        }
+        packed = packed * 10 + (date[i] - '0');
+    }
+    return packed;
+}
+
+// Edits and deletes of income and expense rows bump a counter, so a snapshot is only extended
+// while every row it already holds is unchanged
+static const char *tracking_sql =
+    "CREATE TABLE IF NOT EXISTS snapshot_state ("
+    "id INTEGER PRIMARY KEY, "
+    "changes INTEGER NOT NULL);"
+    "INSERT OR IGNORE INTO snapshot_state (id, changes) VALUES (1, 0);"
+    "CREATE TRIGGER IF NOT EXISTS income_snapshot_au AFTER UPDATE OF amount, date, currency ON income BEGIN "
+    "UPDATE snapshot_state SET changes = changes + 1 WHERE id = 1; END;"
+    "CREATE TRIGGER IF NOT EXISTS income_snapshot_ad AFTER DELETE ON income BEGIN "
+    "UPDATE snapshot_state SET changes = changes + 1 WHERE id = 1; END;"
+    "CREATE TRIGGER IF NOT EXISTS expenses_snapshot_au AFTER UPDATE OF category, amount, date, currency ON expenses BEGIN "
+    "UPDATE snapshot_state SET changes = changes + 1 WHERE id = 1; END;"
+    "CREATE TRIGGER IF NOT EXISTS expenses_snapshot_ad AFTER DELETE ON expenses BEGIN "
+    "UPDATE snapshot_state SET changes = changes + 1 WHERE id = 1; END;";
+
+// Function to create the change counter and the triggers that maintain it
+int initializeSnapshotTracking(sqlite3 *db) {
+    char *err_msg = NULL;
+    if (sqlite3_exec(db, tracking_sql, 0, 0, &err_msg) != SQLITE_OK) {
+        printf("Error: Failed to create snapshot tracking: %s\n", err_msg);
+        sqlite3_free(err_msg);
+        return 0;
+    }
+    return 1;
+}
+
+// The change counter, or -1 on a ledger without one, which never matches a snapshot
+static int64_t snapshotChanges(sqlite3 *db) {
+    sqlite3_stmt *stmt;
+    int64_t changes = -1;
+
+    if (sqlite3_prepare_v2(db, "SELECT changes FROM snapshot_state WHERE id = 1;", -1, &stmt, NULL) == SQLITE_OK &&
+        sqlite3_step(stmt) == SQLITE_ROW) {
+        changes = sqlite3_column_int64(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    return changes;
+}
+
+// Function to map a snapshot read-only and validate its header
+int openSnapshot(const char *path, Snapshot *snapshot) {
+    memset(snapshot, 0, sizeof(*snapshot));
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(SnapshotHeader)) {
+        close(fd);
+        return 0;
+    }
+    void *map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return 0;
+    }
+
+    const SnapshotHeader *header = map;
+    if (memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != SNAPSHOT_VERSION ||
+        header->header_checksum != computeChecksum(header, offsetof(SnapshotHeader, header_checksum), 0) ||
+        header->file_size != st.st_size) {
+        printf("Warning: Snapshot %s is invalid or from another version.\n", path);
+        munmap(map, st.st_size);
+        return 0;
+    }
+
+    const char *base = map;
+    snapshot->map = map;
+    snapshot->size = st.st_size;
+    snapshot->header = header;
+    snapshot->income_amounts = (const double *)(base + header->income_amount_offset);
+    snapshot->income_dates = (const int32_t *)(base + header->income_date_offset);
+    snapshot->expense_amounts = (const double *)(base + header->expense_amount_offset);
+    snapshot->expense_dates = (const int32_t *)(base + header->expense_date_offset);
+    snapshot->expense_categories = (const uint32_t *)(base + header->expense_category_offset);
+    snapshot->categories = (const char (*)[MAX_NAME_LENGTH])(base + header->category_offset);
+    snapshot->archive_totals = (const double *)(base + header->archive_total_offset);
+    snapshot->goals = (const SnapshotGoal *)(base + header->goal_offset);
+    return 1;
+}
+
+// Function to unmap a snapshot
+void closeSnapshot(Snapshot *snapshot) {
+    if (snapshot->map != NULL) {
+        munmap(snapshot->map, snapshot->size);
+    }
+    memset(snapshot, 0, sizeof(*snapshot));
+}
+
+// Category name -> dictionary index, open addressing over the name array
+typedef struct {
+    char (*names)[MAX_NAME_LENGTH];
+    int count;
+    int capacity;
+    int *slots;    // -1 when empty
+    int slot_mask;
+} CategoryDictionary;
+
+static int dictionaryLookup(CategoryDictionary *dict, const char *name) {
+    if ((dict->count + 1) * 2 > dict->slot_mask + 1) {
+        int slot_count = (dict->slot_mask + 1) * 2;
+        free(dict->slots);
+        dict->slots = malloc(slot_count * sizeof(int));
+        memset(dict->slots, -1, slot_count * sizeof(int));
+        dict->slot_mask = slot_count - 1;
+        for (int i = 0; i < dict->count; i++) {
+            unsigned int s = hashString(dict->names[i]) & dict->slot_mask;
+            while (dict->slots[s] >= 0) {
+                s = (s + 1) & dict->slot_mask;
+            }
+            dict->slots[s] = i;
+        }
+    }
+
+    unsigned int s = hashString(name) & dict->slot_mask;
+    while (dict->slots[s] >= 0) {
+        if (strncmp(dict->names[dict->slots[s]], name, MAX_NAME_LENGTH - 1) == 0) {
+            return dict->slots[s];
+        }
+        s = (s + 1) & dict->slot_mask;
+    }
+
+    if (dict->count == dict->capacity) {
+        dict->capacity = dict->capacity ? dict->capacity * 2 : 64;
+        dict->names = realloc(dict->names, dict->capacity * MAX_NAME_LENGTH);
+    }
+    memset(dict->names[dict->count], 0, MAX_NAME_LENGTH);
+    snprintf(dict->names[dict->count], MAX_NAME_LENGTH, "%s", name);
+    dict->slots[s] = dict->count;
+    return dict->count++;
+}
+
+// Rows captured since the previous snapshot
+typedef struct {
+    int64_t count;
+    int64_t capacity;
+    int64_t last_id;
+    double *amounts;
+    int32_t *dates;
+    uint32_t *categories;
+} ColumnDelta;
+
+static void appendDeltaRow(ColumnDelta *delta, double amount, int32_t date, uint32_t category) {
+    if (delta->count == delta->capacity) {
+        delta->capacity = delta->capacity ? delta->capacity * 2 : 1024;
+        delta->amounts = realloc(delta->amounts, delta->capacity * sizeof(double));
+        delta->dates = realloc(delta->dates, delta->capacity * sizeof(int32_t));
+        delta->categories = realloc(delta->categories, delta->capacity * sizeof(uint32_t));
+    }
+    delta->amounts[delta->count] = amount;
+    delta->dates[delta->count] = date;
+    delta->categories[delta->count] = category;
+    delta->count++;
+}
+
+static void freeDelta(ColumnDelta *delta) {
+    free(delta->amounts);
+    free(delta->dates);
+    free(delta->categories);
+}
+
+// Count rows at or below the previous snapshot's high-water mark; a mismatch means rows were removed
+static int64_t countRowsUpTo(sqlite3 *db, const char *sql, int64_t last_id) {
+    sqlite3_stmt *stmt;
+    int64_t count = -1;
+
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) == SQLITE_OK) {
+        sqlite3_bind_int64(stmt, 1, last_id);
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            count = sqlite3_column_int64(stmt, 0);
+        }
+    }
+    sqlite3_finalize(stmt);
+    return count;
+}
+
+// CRC-32 of the base currency and every exchange rate; when it changes the converted amounts
+// already in the snapshot are stale
+static uint32_t ratesChecksum(sqlite3 *db) {
+    sqlite3_stmt *stmt;
+    unsigned int checksum = 0;
+    const char *sql = "SELECT base, NULL FROM ledger_currency "
+                      "UNION ALL SELECT currency || date, rate FROM exchange_rates ORDER BY 1;";
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) == SQLITE_OK) {
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            double rate = sqlite3_column_double(stmt, 1);
+            checksum = computeChecksum(sqlite3_column_text(stmt, 0), sqlite3_column_bytes(stmt, 0), checksum);
+            checksum = computeChecksum(&rate, sizeof(rate), checksum);
+        }
+    }
+    sqlite3_finalize(stmt);
+    return checksum;
+}
+
+// Write one section (old rows from the previous snapshot followed by new rows), padded to 8 bytes
+static void writeSection(FILE *file, const void *old_data, size_t old_size, const void *new_data,
+                         size_t new_size, unsigned int *checksum) {
+    static const char padding[8] = {0};
+    size_t pad = ALIGN8(old_size + new_size) - (old_size + new_size);
+
+    if (old_size > 0) {
+        fwrite(old_data, 1, old_size, file);
+        *checksum = computeChecksum(old_data, old_size, *checksum);
+    }
+    if (new_size > 0) {
+        fwrite(new_data, 1, new_size, file);
+        *checksum = computeChecksum(new_data, new_size, *checksum);
+    }
+    fwrite(padding, 1, pad, file);
+    *checksum = computeChecksum(padding, pad, *checksum);
+}
+
+// Function to (re)generate the snapshot, appending only rows added since the previous one
+int writeSnapshot(sqlite3 *db, const char *path) {
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    Snapshot old;
+    uint32_t rates_checksum = ratesChecksum(db);
+    int64_t changes = snapshotChanges(db);
+    int incremental = openSnapshot(path, &old);
+    if (incremental) {
+        const SnapshotHeader *h = old.header;
+        const char *data = (const char *)old.map + h->income_amount_offset;
+        incremental =
+            computeChecksum(data, h->file_size - h->income_amount_offset, 0) == h->data_checksum &&
+            h->rates_checksum == rates_checksum &&
+            changes >= 0 && h->change_count == changes &&
+            countRowsUpTo(db, "SELECT COUNT(*) FROM income WHERE id <= ?;", h->last_income_id) == h->income_count &&
+            countRowsUpTo(db, "SELECT COUNT(*) FROM expenses WHERE id <= ?;", h->last_expense_id) == h->expense_count;
+        if (!incremental) {
+            closeSnapshot(&old);
+        }
+    }
+
+    CategoryDictionary dict = {0};
+    dict.slot_mask = 63;
+    dict.slots = malloc(64 * sizeof(int));
+    memset(dict.slots, -1, 64 * sizeof(int));
+    ColumnDelta income = {0}, expenses = {0};
+
+    if (incremental) {
+        for (uint32_t i = 0; i < old.header->category_count; i++) {
+            dictionaryLookup(&dict, old.categories[i]);
+        }
+        income.last_id = old.header->last_income_id;
+        expenses.last_id = old.header->last_expense_id;
+    }
+
+    // Amounts are stored converted; a row with no rate is stored as 0 and counted
+    sqlite3_stmt *stmt;
+    int64_t unconverted = incremental ? old.header->unconverted_count : 0;
+    const char *income_sql = "SELECT id, to_base(amount, currency, date), date FROM income WHERE id > ? ORDER BY id;";
+    if (sqlite3_prepare_v2(db, income_sql, -1, &stmt, NULL) == SQLITE_OK) {
+        sqlite3_bind_int64(stmt, 1, income.last_id);
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            income.last_id = sqlite3_column_int64(stmt, 0);
+            unconverted += (sqlite3_column_type(stmt, 1) == SQLITE_NULL);
+            appendDeltaRow(&income, sqlite3_column_double(stmt, 1), packDate((const char *)sqlite3_column_text(stmt, 2)), 0);
+        }
+    }
+    sqlite3_finalize(stmt);
+
+    const char *expense_sql =
+        "SELECT id, category, to_base(amount, currency, date), date FROM expenses WHERE id > ? ORDER BY id;";
+    if (sqlite3_prepare_v2(db, expense_sql, -1, &stmt, NULL) == SQLITE_OK) {
+        sqlite3_bind_int64(stmt, 1, expenses.last_id);
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            const char *category = (const char *)sqlite3_column_text(stmt, 1);
+            expenses.last_id = sqlite3_column_int64(stmt, 0);
+            unconverted += (sqlite3_column_type(stmt, 2) == SQLITE_NULL);
+            appendDeltaRow(&expenses, sqlite3_column_double(stmt, 2), packDate((const char *)sqlite3_column_text(stmt, 3)),
+                           dictionaryLookup(&dict, category ? category : ""));
+        }
+    }
+    sqlite3_finalize(stmt);
+    reportMissingRates();
+
+    // Small tables are always captured in full
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    const char *recurring_sql = "SELECT IFNULL(SUM(amount), 0) FROM recurring WHERE type = 'expense';";
+    if (sqlite3_prepare_v2(db, recurring_sql, -1, &stmt, NULL) == SQLITE_OK && sqlite3_step(stmt) == SQLITE_ROW) {
+        header.recurring_expense_total = sqlite3_column_double(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+
+    // Archived years are summaries, also captured in full; their categories join the dictionary
+    const char *archived_income_sql = "SELECT IFNULL(SUM(income_total), 0) FROM archives;";
+    if (sqlite3_prepare_v2(db, archived_income_sql, -1, &stmt, NULL) == SQLITE_OK && sqlite3_step(stmt) == SQLITE_ROW) {
+        header.archived_income_total = sqlite3_column_double(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+
+    double *archive_totals = NULL;
+    int archive_capacity = 0;
+    const char *archived_categories_sql = "SELECT category, total FROM archive_category_totals;";
+    if (sqlite3_prepare_v2(db, archived_categories_sql, -1, &stmt, NULL) == SQLITE_OK) {
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            const char *category = (const char *)sqlite3_column_text(stmt, 0);
+            int index = dictionaryLookup(&dict, category ? category : "");
+            if (index >= archive_capacity) {
+                int capacity = dict.capacity;
+                archive_totals = realloc(archive_totals, capacity * sizeof(double));
+                memset(archive_totals + archive_capacity, 0, (capacity - archive_capacity) * sizeof(double));
+                archive_capacity = capacity;
+            }
+            archive_totals[index] += sqlite3_column_double(stmt, 1);
+        }
+    }
+    sqlite3_finalize(stmt);
+    if (archive_capacity < dict.count) {
+        archive_totals = realloc(archive_totals, dict.count * sizeof(double));
+        memset(archive_totals + archive_capacity, 0, (dict.count - archive_capacity) * sizeof(double));
+    }
+
+    SnapshotGoal *goals = NULL;
+    int goal_count = 0, goal_capacity = 0;
+    const char *goals_sql = "SELECT name, target_amount, saved_amount FROM savings_goals ORDER BY id;";
+    if (sqlite3_prepare_v2(db, goals_sql, -1, &stmt, NULL) == SQLITE_OK) {
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            if (goal_count == goal_capacity) {
+                goal_capacity = goal_capacity ? goal_capacity * 2 : 16;
+                goals = realloc(goals, goal_capacity * sizeof(SnapshotGoal));
+            }
+            SnapshotGoal *goal = &goals[goal_count++];
+            memset(goal, 0, sizeof(*goal));
+            snprintf(goal->name, sizeof(goal->name), "%s", (const char *)sqlite3_column_text(stmt, 0));
+            goal->target_amount = sqlite3_column_double(stmt, 1);
+            goal->saved_amount = sqlite3_column_double(stmt, 2);
+        }
+    }
+    sqlite3_finalize(stmt);
+
+    // Lay out the file
+    int64_t old_income = incremental ? old.header->income_count : 0;
+    int64_t old_expenses = incremental ? old.header->expense_count : 0;
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.category_count = dict.count;
+    header.income_count = old_income + income.count;
+    header.expense_count = old_expenses + expenses.count;
+    header.goal_count = goal_count;
+    header.last_income_id = income.last_id;
+    header.last_expense_id = expenses.last_id;
+    header.unconverted_count = unconverted;
+    header.rates_checksum = rates_checksum;
+    header.change_count = changes;
+    header.income_amount_offset = ALIGN8((int64_t)sizeof(SnapshotHeader));
+    header.income_date_offset = header.income_amount_offset + ALIGN8(header.income_count * (int64_t)sizeof(double));
+    header.expense_amount_offset = header.income_date_offset + ALIGN8(header.income_count * (int64_t)sizeof(int32_t));
+    header.expense_date_offset = header.expense_amount_offset + ALIGN8(header.expense_count * (int64_t)sizeof(double));
+    header.expense_category_offset = header.expense_date_offset + ALIGN8(header.expense_count * (int64_t)sizeof(int32_t));
+    header.category_offset = header.expense_category_offset + ALIGN8(header.expense_count * (int64_t)sizeof(uint32_t));
+    header.archive_total_offset = header.category_offset + ALIGN8((int64_t)dict.count * MAX_NAME_LENGTH);
+    header.goal_offset = header.archive_total_offset + ALIGN8((int64_t)dict.count * (int64_t)sizeof(double));
+    header.file_size = header.goal_offset + ALIGN8((int64_t)goal_count * (int64_t)sizeof(SnapshotGoal));
+
+    char tmp_path[512];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+    FILE *file = fopen(tmp_path, "wb");
+    int ok = (file != NULL);
+    if (ok) {
+        unsigned int checksum = 0;
+        fwrite(&header, 1, sizeof(header), file);
+        fseek(file, header.income_amount_offset, SEEK_SET);
+
+        writeSection(file, incremental ? old.income_amounts : NULL, old_income * sizeof(double),
+                     income.amounts, income.count * sizeof(double), &checksum);
+        writeSection(file, incremental ? old.income_dates : NULL, old_income * sizeof(int32_t),
+                     income.dates, income.count * sizeof(int32_t), &checksum);
+        writeSection(file, incremental ? old.expense_amounts : NULL, old_expenses * sizeof(double),
+                     expenses.amounts, expenses.count * sizeof(double), &checksum);
+        writeSection(file, incremental ? old.expense_dates : NULL, old_expenses * sizeof(int32_t),
+                     expenses.dates, expenses.count * sizeof(int32_t), &checksum);
+        writeSection(file, incremental ? old.expense_categories : NULL, old_expenses * sizeof(uint32_t),
+                     expenses.categories, expenses.count * sizeof(uint32_t), &checksum);
+        writeSection(file, NULL, 0, dict.names, (size_t)dict.count * MAX_NAME_LENGTH, &checksum);
+        writeSection(file, NULL, 0, archive_totals, (size_t)dict.count * sizeof(double), &checksum);
+        writeSection(file, NULL, 0, goals, (size_t)goal_count * sizeof(SnapshotGoal), &checksum);
+
+        header.data_checksum = checksum;
+        header.header_checksum = computeChecksum(&header, offsetof(SnapshotHeader, header_checksum), 0);
+        fseek(file, 0, SEEK_SET);
+        fwrite(&header, 1, sizeof(header), file);
+        ok = (fflush(file) == 0 && fsync(fileno(file)) == 0);
+        ok = (fclose(file) == 0) && ok;
+    }
+
+    if (incremental) {
+        closeSnapshot(&old);
+    }
+    if (ok && rename(tmp_path, path) != 0) {
+        ok = 0;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if (ok) {
+        printf("Snapshot %s written (%s, %lld new rows, %.2f ms).\n", path, incremental ? "incremental" : "full",
+               (long long)(income.count + expenses.count),
+               (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1e6);
+    } else {
+        printf("Error: Could not write snapshot %s.\n", path);
+        unlink(tmp_path);
+    }
+
+    freeDelta(&income);
+    freeDelta(&expenses);
+    free(dict.names);
+    free(dict.slots);
+    free(archive_totals);
+    free(goals);
+    return ok;
+}
+
+// Function to bring an existing snapshot up to date; does nothing if no snapshot was ever exported
+void refreshSnapshot(sqlite3 *db, const char *path) {
+    if (access(path, F_OK) == 0) {
+        writeSnapshot(db, path);
+    }
+}
+
+static const double *sort_totals;
+
+static int compareCategoryTotals(const void *a, const void *b) {
+    double ta = sort_totals[*(const uint32_t *)a], tb = sort_totals[*(const uint32_t *)b];
+    return (ta < tb) - (ta > tb);
+}
+
+// Function to show analytics straight from the mapped columns
+void showSnapshotAnalytics(const Snapshot *snapshot) {
+    const SnapshotHeader *header = snapshot->header;
+    printf("\n=== Budget Analytics (Snapshot) ===\n");
+
+    // Archived years come from their summaries, as in showAnalytics()
+    double total_income = header->archived_income_total;
+    for (int64_t i = 0; i < header->income_count; i++) {
+        total_income += snapshot->income_amounts[i];
+    }
+    printf("Total Monthly Income: $%.2f\n", total_income);
+
+    double total_expenses = 0;
+    double *category_totals = calloc(header->category_count + 1, sizeof(double));
+    for (uint32_t i = 0; i < header->category_count; i++) {
+        category_totals[i] = snapshot->archive_totals[i];
+        total_expenses += snapshot->archive_totals[i];
+    }
+    for (int64_t i = 0; i < header->expense_count; i++) {
+        total_expenses += snapshot->expense_amounts[i];
+        category_totals[snapshot->expense_categories[i]] += snapshot->expense_amounts[i];
+    }
+    printf("Total Expenses: $%.2f\n", total_expenses);
+
+    printf("\nExpense Breakdown by Category:\n");
+    uint32_t *order = malloc((header->category_count + 1) * sizeof(uint32_t));
+    for (uint32_t i = 0; i < header->category_count; i++) {
+        order[i] = i;
+    }
+    sort_totals = category_totals;
+    qsort(order, header->category_count, sizeof(uint32_t), compareCategoryTotals);
+    for (uint32_t i = 0; i < header->category_count; i++) {
+        printf(" - %s: $%.2f\n", snapshot->categories[order[i]], category_totals[order[i]]);
+    }
+    free(order);
+    free(category_totals);
+
+    printf("\nTotal Recurring Expenses: $%.2f\n", header->recurring_expense_total);
+
+    printf("\nSavings Goals Progress:\n");
+    for (int64_t i = 0; i < header->goal_count; i++) {
+        const SnapshotGoal *goal = &snapshot->goals[i];
+        printf(" - %s: $%.2f / $%.2f (%.2f%% complete)\n", goal->name, goal->saved_amount,
+               goal->target_amount, goal->saved_amount / goal->target_amount * 100);
+    }
+
+    double remaining_budget = total_income - (total_expenses + header->recurring_expense_total);
+    printf("\nRemaining Budget After Expenses: $%.2f\n", remaining_budget);
+    if (remaining_budget > 0) {
+        printf("\n✔ You have a positive balance. Consider saving or investing.\n");
+    } else {
+        printf("\n⚠ Warning: Your expenses exceed your income. Consider adjusting spending.\n");
+    }
+
+    if (header->unconverted_count > 0) {
+        printf("\nWarning: %lld rows had no exchange rate and were left out.\n", (long long)header->unconverted_count);
+    }
+    printf("\n=== End of Analytics ===\n");
+}
+
+// Function to answer a report-only invocation from the snapshot without opening the database
+int showSnapshotReport(const char *path) {
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    Snapshot snapshot;
+    if (!openSnapshot(path, &snapshot)) {
+        printf("Error: No usable snapshot at %s. Run with --snapshot first.\n", path);
+        return 0;
+    }
+    showSnapshotAnalytics(&snapshot);
+    closeSnapshot(&snapshot);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("Report answered from %s in %.2f ms.\n", path,
+           (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1e6);
+    return 1;
+}
@@ -0,0 +1,1101 @@
+#define _XOPEN_SOURCE 700
+#include "stress.h"
+#include "database.h"
+#include "budget.h"
+#include "category_limits.h"
+#include "currency.h"
+#include "dedupe.h"
+#include "journal.h"
+#include "schema.h"
+#include "search.h"
+#include "snapshot.h"
+#include "utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <time.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <stdatomic.h>
+#include <sqlite3.h>
+
+// The stress run drives the real storage functions with a seeded random stream of inserts,
+// edits, deletes and recurring postings across simulated months, and keeps its own model of
+// what the ledger must hold. Every STRESS_CHECK_EVERY operations the reports are run and
+// compared with totals summed from the model. A threaded phase then measures write
+// throughput and lock contention with one connection per thread, and a crash phase kills a
+// journaling writer and checks what the next start recovers.
+
+#define STRESS_CATEGORY_COUNT 6
+static const char *stress_categories[STRESS_CATEGORY_COUNT] = {
+    "Groceries", "Rent", "Travel", "Dining", "Utilities", "Health"
+};
+#define STRESS_CURRENCY_COUNT 3
+static const char *stress_currencies[STRESS_CURRENCY_COUNT] = {NULL, "EUR", "GBP"};
+
+// Written to STRESS_RATES_FILE; modelRate() applies the same schedule independently
+static const char *stress_rates =
+    "currency,date,rate\n"
+    "EUR,2019-12-01,1.25\n"
+    "EUR,2020-06-15,1.5\n"
+    "GBP,2019-12-01,2\n";
+
+typedef enum {
+    OP_INCOME,
+    OP_EXPENSE,
+    OP_EDIT,
+    OP_DELETE,
+    OP_RECURRING,
+    OP_REPLAY,     // Apply a month again, as if the process died before marking it processed
+    OP_MONTH,
+    OP_CHECK,
+    OP_COUNT
+} StressOp;
+
+static const char *op_names[OP_COUNT] = {
+    "income", "expenses", "edits", "deletes", "recurring entries", "month replays", "months", "checks"
+};
+
+// A row as the model expects to find it in the ledger
+typedef struct {
+    double amount;      // The float the insert functions take, widened as SQLite stores it
+    int category;       // Index from categoryName(); -1 for income
+    int currency;       // Index into stress_currencies; 0 is the base currency
+    int year, month, day;
+    int live;
+    int posted;         // Written by a recurring posting; random operations leave it alone
+    int edited;         // Changed after insert, so its fingerprint no longer matches
+} ModelRow;
+
+typedef struct {
+    ModelRow *rows;     // Indexed by row id
+    int64_t capacity;
+    int64_t max_id;
+} ModelTable;
+
+typedef struct {
+    sqlite3 *db;
+    uint64_t rng;
+    unsigned long long seed;
+    int quiet_fd;       // /dev/null, for the functions that print as they work
+    ModelTable income, expenses;
+    char recurring_names[2][STRESS_MAX_RECURRING][MAX_NAME_LENGTH];   // [0] income, [1] expenses
+    double recurring_amounts[2][STRESS_MAX_RECURRING];
+    int recurring_posted[2][STRESS_MAX_RECURRING];   // year * 12 + month of the last posting
+    int recurring_count[2];
+    int year, month;    // Simulated current month
+    long done;          // Random operations run so far
+    long counts[OP_COUNT];
+    int failed;
+} StressState;
+
+// One thread of the threaded phase
+typedef struct {
+    int writer;         // 0 for the reader, which runs reports until the writers finish
+    long target;        // Writes to make
+    uint64_t rng;
+    int year, month;
+    long operations;
+    long busy_retries;
+    double wait_ms;
+    double max_latency_ms;
+    int failed;
+} StressWorker;
+
+static atomic_int writers_running;
+
+// xorshift64*: fast, and the same seed always gives the same stream
+static uint64_t nextRandom(uint64_t *state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 2685821657736338717ULL;
+}
+
+static int randomBelow(uint64_t *state, int limit) {
+    return (int)(nextRandom(state) % (uint64_t)limit);
+}
+
+static double elapsedMs(const struct timespec *since) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - since->tv_sec) * 1000.0 + (now.tv_nsec - since->tv_nsec) / 1e6;
+}
+
+static double modelRate(int currency, int year, int month, int day) {
+    if (currency == 1) {
+        int from_june_15 = year > 2020 || (year == 2020 && (month > 6 || (month == 6 && day >= 15)));
+        return from_june_15 ? 1.5 : 1.25;
+    }
+    return currency == 2 ? 2.0 : 1.0;
+}
+
+static double tolerance(double expected) {
+    double magnitude = expected < 0 ? -expected : expected;
+    return 0.01 + magnitude * 1e-6;   // Reports total in float
+}
+
+static int closeEnough(double actual, double expected) {
+    double difference = actual - expected;
+    return difference <= tolerance(expected) && -difference <= tolerance(expected);
+}
+
+// Categories 0..5 are the random ones; recurring expense k posts under category 6 + k
+static const char *categoryName(const StressState *s, int category) {
+    return category < STRESS_CATEGORY_COUNT ? stress_categories[category]
+                                            : s->recurring_names[1][category - STRESS_CATEGORY_COUNT];
+}
+
+static ModelRow *modelRow(ModelTable *table, int64_t id) {
+    if (id >= table->capacity) {
+        int64_t capacity = table->capacity ? table->capacity : 1024;
+        while (id >= capacity) {
+            capacity *= 2;
+        }
+        table->rows = realloc(table->rows, capacity * sizeof(ModelRow));
+        memset(table->rows + table->capacity, 0, (capacity - table->capacity) * sizeof(ModelRow));
+        table->capacity = capacity;
+    }
+    if (id > table->max_id) {
+        table->max_id = id;
+    }
+    return &table->rows[id];
+}
+
+static void stressFail(StressState *s, const char *format, ...) {
+    va_list args;
+    printf("FAIL after %ld operations (seed %llu): ", s->done, s->seed);
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+    printf("\n");
+    s->failed = 1;
+}
+
+// Point stdout at fd until restoreStdout
+static int redirectStdout(int fd) {
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    dup2(fd, STDOUT_FILENO);
+    return saved;
+}
+
+static void restoreStdout(int saved) {
+    fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+}
+
+// Insert a random income or expense through the same functions the menus use
+static void stressInsert(StressState *s, int expense) {
+    float amount = (1 + randomBelow(&s->rng, 500000)) / 100.0f;
+    int currency = randomBelow(&s->rng, 10) < 8 ? 0 : 1 + randomBelow(&s->rng, STRESS_CURRENCY_COUNT - 1);
+    int category = randomBelow(&s->rng, STRESS_CATEGORY_COUNT);
+
+    // Mostly this month, sometimes back-dated; never the 1st, which belongs to recurring postings
+    int month = randomBelow(&s->rng, 10) == 0 ? 1 + randomBelow(&s->rng, s->month) : s->month;
+    int day = 2 + randomBelow(&s->rng, 27);
+    char date[20];
+    snprintf(date, sizeof(date), "%04d-%02d-%02d", s->year, month, day);
+
+    int ok = expense ? addExpenseRecord(s->db, stress_categories[category], amount, date, stress_currencies[currency])
+                     : addIncomeRecord(s->db, amount, date, stress_currencies[currency]);
+    if (!ok) {
+        stressFail(s, "insert failed: %s", sqlite3_errmsg(s->db));
+        return;
+    }
+    ModelRow *row = modelRow(expense ? &s->expenses : &s->income, sqlite3_last_insert_rowid(s->db));
+    *row = (ModelRow){ .amount = amount, .category = expense ? category : -1, .currency = currency,
+                       .year = s->year, .month = month, .day = day, .live = 1 };
+}
+
+// Pick a live row the random operations may change, or 0 if a few tries find none
+static int64_t pickRow(StressState *s, ModelTable *table) {
+    for (int i = 0; i < 8 && table->max_id > 0; i++) {
+        int64_t id = 1 + (int64_t)(nextRandom(&s->rng) % (uint64_t)table->max_id);
+        if (table->rows[id].live && !table->rows[id].posted) {
+            return id;
+        }
+    }
+    return 0;
+}
+
+static void stressEdit(StressState *s) {
+    int expense = randomBelow(&s->rng, 2);
+    ModelTable *table = expense ? &s->expenses : &s->income;
+    int64_t id = pickRow(s, table);
+    if (id == 0) {
+        return;
+    }
+
+    float amount = (1 + randomBelow(&s->rng, 500000)) / 100.0f;
+    int category = randomBelow(&s->rng, STRESS_CATEGORY_COUNT);
+    const char *sql = expense ? "UPDATE expenses SET amount = ?, category = ? WHERE id = ?;"
+                              : "UPDATE income SET amount = ? WHERE id = ?;";
+    sqlite3_stmt *stmt;
+    int ok = 0;
+    if (sqlite3_prepare_v2(s->db, sql, -1, &stmt, NULL) == SQLITE_OK) {
+        sqlite3_bind_double(stmt, 1, amount);
+        if (expense) {
+            sqlite3_bind_text(stmt, 2, stress_categories[category], -1, SQLITE_STATIC);
+        }
+        sqlite3_bind_int64(stmt, expense ? 3 : 2, id);
+        ok = sqlite3_step(stmt) == SQLITE_DONE && sqlite3_changes(s->db) == 1;
+    }
+    sqlite3_finalize(stmt);
+    if (!ok) {
+        stressFail(s, "edit of %s %lld failed: %s", expense ? "expense" : "income", (long long)id, sqlite3_errmsg(s->db));
+        return;
+    }
+    table->rows[id].amount = amount;
+    table->rows[id].category = expense ? category : -1;
+    table->rows[id].edited = 1;
+}
+
+static void stressDelete(StressState *s) {
+    int expense = randomBelow(&s->rng, 2);
+    ModelTable *table = expense ? &s->expenses : &s->income;
+    int64_t id = pickRow(s, table);
+    if (id == 0) {
+        return;
+    }
+
+    sqlite3_stmt *stmt;
+    int ok = 0;
+    if (sqlite3_prepare_v2(s->db, expense ? "DELETE FROM expenses WHERE id = ?;" : "DELETE FROM income WHERE id = ?;",
+                           -1, &stmt, NULL) == SQLITE_OK) {
+        sqlite3_bind_int64(stmt, 1, id);
+        ok = sqlite3_step(stmt) == SQLITE_DONE && sqlite3_changes(s->db) == 1;
+    }
+    sqlite3_finalize(stmt);
+    if (!ok) {
+        stressFail(s, "delete of %s %lld failed: %s", expense ? "expense" : "income", (long long)id, sqlite3_errmsg(s->db));
+        return;
+    }
+    table->rows[id].live = 0;
+}
+
+static void stressAddRecurring(StressState *s) {
+    int expense = randomBelow(&s->rng, 2);
+    int index = s->recurring_count[expense];
+    if (index == STRESS_MAX_RECURRING) {
+        return;
+    }
+
+    // Distinct amounts, so the postings of different income entries can be told apart
+    char *name = s->recurring_names[expense][index];
+    snprintf(name, MAX_NAME_LENGTH, "%s %d", expense ? "Subscription" : "Salary", index + 1);
+    char date[20];
+    snprintf(date, sizeof(date), "%04d-%02d-01", s->year, s->month);
+    RecurringRow row = { .type = expense ? "expense" : "income", .description = name,
+                         .amount = 100.37 + index * 10, .date = date };
+
+    sqlite3_stmt *stmt;
+    int ok = 0;
+    if (sqlite3_prepare_v2(s->db, SCHEMA_INSERT_SQL(SCHEMA_RECURRING) ";", -1, &stmt, NULL) == SQLITE_OK) {
+        schemaBind_recurring(stmt, &row);
+        ok = sqlite3_step(stmt) == SQLITE_DONE;
+    }
+    sqlite3_finalize(stmt);
+    if (!ok) {
+        stressFail(s, "adding a recurring entry failed: %s", sqlite3_errmsg(s->db));
+        return;
+    }
+    s->recurring_amounts[expense][index] = row.amount;
+    s->recurring_count[expense]++;
+}
+
+// Add the rows a recurring run posted to the model; returns how many there were and their sum
+static int syncPostings(StressState *s, int expense, double *total) {
+    ModelTable *table = expense ? &s->expenses : &s->income;
+    const char *sql = expense ? "SELECT id, amount, date, category FROM expenses WHERE id > ? ORDER BY id;"
+                              : "SELECT id, amount, date, NULL FROM income WHERE id > ? ORDER BY id;";
+    char expected_date[20];
+    snprintf(expected_date, sizeof(expected_date), "%04d-%02d-01", s->year, s->month);
+
+    sqlite3_stmt *stmt;
+    int count = 0;
+    *total = 0;
+    if (sqlite3_prepare_v2(s->db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        stressFail(s, "reading postings failed: %s", sqlite3_errmsg(s->db));
+        return 0;
+    }
+    sqlite3_bind_int64(stmt, 1, table->max_id);
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        int64_t id = sqlite3_column_int64(stmt, 0);
+        const char *date = (const char *)sqlite3_column_text(stmt, 2);
+        const char *category = (const char *)sqlite3_column_text(stmt, 3);
+
+        ModelRow *row = modelRow(table, id);
+        *row = (ModelRow){ .amount = sqlite3_column_double(stmt, 1), .category = -1, .year = s->year,
+                           .month = s->month, .day = 1, .live = 1, .posted = 1 };
+        if (expense) {
+            for (int k = 0; k < s->recurring_count[1] && category != NULL; k++) {
+                if (strcmp(category, s->recurring_names[1][k]) == 0) {
+                    row->category = STRESS_CATEGORY_COUNT + k;
+                }
+            }
+        }
+        if (date == NULL || strcmp(date, expected_date) != 0 || (expense && row->category < 0)) {
+            stressFail(s, "unexpected posting %lld: %s on %s", (long long)id, category ? category : "income",
+                       date ? date : "(null)");
+        }
+        *total += row->amount;
+        count++;
+    }
+    sqlite3_finalize(stmt);
+    return count;
+}
+
+// Apply recurring entries on the 1st of the simulated month. Every entry must be posted once a
+// month: a replay posts only the entries added since the month was first applied.
+static void stressApplyMonth(StressState *s, int replay) {
+    struct tm when = { .tm_year = s->year - 1900, .tm_mon = s->month - 1, .tm_mday = 1, .tm_hour = 12, .tm_isdst = -1 };
+    if (replay) {
+        updateLastProcessedMonth(s->db, s->month == 1 ? s->year - 1 : s->year, s->month == 1 ? 12 : s->month - 1);
+    }
+
+    int quiet = redirectStdout(s->quiet_fd);
+    applyRecurringTransactionsAt(s->db, mktime(&when));
+    restoreStdout(quiet);
+
+    int month = s->year * 12 + s->month;
+    for (int expense = 0; expense < 2 && !s->failed; expense++) {
+        double total, expected_total = 0;
+        int expected = 0;
+        for (int k = 0; k < s->recurring_count[expense]; k++) {
+            if (s->recurring_posted[expense][k] != month) {
+                expected_total += (float)s->recurring_amounts[expense][k];   // Posted through the float insert functions
+                expected++;
+                s->recurring_posted[expense][k] = month;
+            }
+        }
+        int posted = syncPostings(s, expense, &total);
+        if (!s->failed && (posted != expected || !closeEnough(total, expected_total))) {
+            stressFail(s, "%04d-%02d%s posted %d recurring %s totalling %.2f; expected %d totalling %.2f",
+                       s->year, s->month, replay ? " (replayed)" : "", posted, expense ? "expenses" : "income",
+                       total, expected, expected_total);
+        }
+    }
+}
+
+typedef struct {
+    double income;
+    double expenses;
+    int found;          // Bit 0: income line, bit 1: expenses line
+    char warning[256];
+} ReportTotals;
+
+static void dailyBudgetReport(sqlite3 *db) {
+    Budget budget = {0, 0, 0, 30};
+    calculateDailyBudget(db, &budget);
+}
+
+// Run a report with its output captured and pick the totals out of it
+static ReportTotals captureReport(StressState *s, void (*report)(sqlite3 *), const char *income_label,
+                                  const char *expense_label) {
+    ReportTotals totals = {0};
+    FILE *capture = tmpfile();
+    if (capture == NULL) {
+        return totals;
+    }
+    int saved = redirectStdout(fileno(capture));
+    report(s->db);
+    restoreStdout(saved);
+
+    char line[512];
+    size_t income_length = strlen(income_label), expense_length = strlen(expense_label);
+    rewind(capture);
+    while (fgets(line, sizeof(line), capture) != NULL) {
+        if (strncmp(line, income_label, income_length) == 0) {
+            totals.income = atof(line + income_length);
+            totals.found |= 1;
+        } else if (strncmp(line, expense_label, expense_length) == 0) {
+            totals.expenses = atof(line + expense_length);
+            totals.found |= 2;
+        } else if (strncmp(line, "Warning:", 8) == 0 && totals.warning[0] == '\0') {
+            line[strcspn(line, "\n")] = '\0';
+            snprintf(totals.warning, sizeof(totals.warning), "%.255s", line);
+        }
+    }
+    fclose(capture);
+    return totals;
+}
+
+static void checkReport(StressState *s, const char *name, ReportTotals totals, double income, double expenses) {
+    if (totals.found != 3) {
+        stressFail(s, "%s printed no totals", name);
+    } else if (totals.warning[0] != '\0') {
+        stressFail(s, "%s warned: %s", name, totals.warning);
+    } else if (!closeEnough(totals.income, income) || !closeEnough(totals.expenses, expenses)) {
+        stressFail(s, "%s shows income %.2f and expenses %.2f; the rows add up to %.2f and %.2f",
+                   name, totals.income, totals.expenses, income, expenses);
+    }
+}
+
+static int64_t queryCount(sqlite3 *db, const char *sql) {
+    sqlite3_stmt *stmt;
+    int64_t count = -1;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) == SQLITE_OK && sqlite3_step(stmt) == SQLITE_ROW) {
+        count = sqlite3_column_int64(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    return count;
+}
+
+// Compare the ledger and its reports against totals summed from the model
+// Total a table the way the snapshot stores it: converted, with a missing rate counted as 0
+static double convertedTotal(sqlite3 *db, const char *table) {
+    char sql[128];
+    snprintf(sql, sizeof(sql), "SELECT IFNULL(SUM(to_base(amount, currency, date)), 0) FROM %s;", table);
+    sqlite3_stmt *stmt;
+    double total = 0;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) == SQLITE_OK && sqlite3_step(stmt) == SQLITE_ROW) {
+        total = sqlite3_column_double(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    return total;
+}
+
+// Bring the scratch snapshot up to date, incrementally when nothing it holds was edited or
+// deleted, and check its rows and totals against the ledger
+static void checkSnapshot(StressState *s, const char *when) {
+    int quiet = redirectStdout(s->quiet_fd);
+    int written = writeSnapshot(s->db, STRESS_SNAPSHOT_FILE);
+    double income = convertedTotal(s->db, "income"), expenses = convertedTotal(s->db, "expenses");
+    restoreStdout(quiet);
+    int64_t income_rows = queryCount(s->db, "SELECT COUNT(*) FROM income;");
+    int64_t expense_rows = queryCount(s->db, "SELECT COUNT(*) FROM expenses;");
+
+    Snapshot snapshot;
+    if (!written || !openSnapshot(STRESS_SNAPSHOT_FILE, &snapshot)) {
+        stressFail(s, "the snapshot could not be written or opened %s", when);
+        return;
+    }
+    double income_total = 0, expense_total = 0;
+    for (int64_t i = 0; i < snapshot.header->income_count; i++) {
+        income_total += snapshot.income_amounts[i];
+    }
+    for (int64_t i = 0; i < snapshot.header->expense_count; i++) {
+        expense_total += snapshot.expense_amounts[i];
+    }
+    if (snapshot.header->income_count != income_rows || snapshot.header->expense_count != expense_rows ||
+        !closeEnough(income_total, income) || !closeEnough(expense_total, expenses)) {
+        stressFail(s, "%s the snapshot has %lld income rows totalling %.2f and %lld expense rows totalling %.2f; "
+                   "expected %lld totalling %.2f and %lld totalling %.2f", when,
+                   (long long)snapshot.header->income_count, income_total, (long long)snapshot.header->expense_count,
+                   expense_total, (long long)income_rows, income, (long long)expense_rows, expenses);
+    }
+    closeSnapshot(&snapshot);
+}
+
+static void stressCheck(StressState *s) {
+    enum { CATEGORY_SLOTS = STRESS_CATEGORY_COUNT + STRESS_MAX_RECURRING };
+    double income = 0, expenses = 0, category_totals[CATEGORY_SLOTS] = {0};
+    long category_counts[CATEGORY_SLOTS] = {0};
+    int64_t income_rows = 0, expense_rows = 0;
+    char date[20];
+
+    for (int expense = 0; expense < 2; expense++) {
+        ModelTable *table = expense ? &s->expenses : &s->income;
+        for (int64_t id = 1; id <= table->max_id; id++) {
+            ModelRow *row = &table->rows[id];
+            if (!row->live) {
+                continue;
+            }
+            double converted = row->amount * modelRate(row->currency, row->year, row->month, row->day);
+            if (expense) {
+                expenses += converted;
+                expense_rows++;
+                category_totals[row->category] += converted;
+                category_counts[row->category]++;
+            } else {
+                income += converted;
+                income_rows++;
+            }
+
+            // Fingerprints are taken at insert; an edited row keeps its old one
+            snprintf(date, sizeof(date), "%04d-%02d-%02d", row->year, row->month, row->day);
+            uint64_t fingerprint = transactionFingerprint(expense ? FINGERPRINT_EXPENSE : FINGERPRINT_INCOME, date,
+                                                          row->amount, expense ? categoryName(s, row->category) : NULL,
+                                                          stress_currencies[row->currency]);
+            if (!row->edited && !fingerprintSeen(fingerprint)) {
+                stressFail(s, "%s %lld is missing from the fingerprint set", expense ? "expense" : "income", (long long)id);
+                return;
+            }
+        }
+    }
+
+    // Every row the model holds is in the ledger, and nothing else
+    if (queryCount(s->db, "SELECT COUNT(*) FROM income;") != income_rows ||
+        queryCount(s->db, "SELECT COUNT(*) FROM expenses;") != expense_rows) {
+        stressFail(s, "the ledger has %lld income and %lld expense rows; expected %lld and %lld",
+                   (long long)queryCount(s->db, "SELECT COUNT(*) FROM income;"),
+                   (long long)queryCount(s->db, "SELECT COUNT(*) FROM expenses;"), (long long)income_rows,
+                   (long long)expense_rows);
+        return;
+    }
+
+    // The trigger-maintained row counts the metrics file exports
+    if (queryCount(s->db, "SELECT row_count FROM row_counts WHERE table_name = 'income';") != income_rows ||
+        queryCount(s->db, "SELECT row_count FROM row_counts WHERE table_name = 'expenses';") != expense_rows) {
+        stressFail(s, "row_counts has %lld income and %lld expense rows; expected %lld and %lld",
+                   (long long)queryCount(s->db, "SELECT row_count FROM row_counts WHERE table_name = 'income';"),
+                   (long long)queryCount(s->db, "SELECT row_count FROM row_counts WHERE table_name = 'expenses';"),
+                   (long long)income_rows, (long long)expense_rows);
+        return;
+    }
+
+    // No recurring entry posted twice in one month. Only postings land on the 1st, and each
+    // income entry has its own amount.
+    if (queryCount(s->db, "SELECT COUNT(*) FROM (SELECT 1 FROM expenses WHERE substr(date, 9, 2) = '01' "
+                          "GROUP BY category, substr(date, 1, 7) HAVING COUNT(*) > 1);") != 0 ||
+        queryCount(s->db, "SELECT COUNT(*) FROM (SELECT 1 FROM income WHERE substr(date, 9, 2) = '01' "
+                          "GROUP BY amount, substr(date, 1, 7) HAVING COUNT(*) > 1);") != 0) {
+        stressFail(s, "a recurring entry was posted twice in one month");
+        return;
+    }
+
+    // The trigger-maintained category_totals against the model
+    sqlite3_stmt *stmt;
+    int categories_seen = 0, categories_expected = 0;
+    for (int i = 0; i < STRESS_CATEGORY_COUNT + s->recurring_count[1]; i++) {
+        categories_expected += category_counts[i] > 0;
+    }
+    if (sqlite3_prepare_v2(s->db, "SELECT c.category, " CATEGORY_TOTAL_SQL ", c.count FROM category_totals c;", -1,
+                           &stmt, NULL) == SQLITE_OK) {
+        while (sqlite3_step(stmt) == SQLITE_ROW && !s->failed) {
+            const char *category = (const char *)sqlite3_column_text(stmt, 0);
+            int index = -1;
+            for (int i = 0; i < STRESS_CATEGORY_COUNT + s->recurring_count[1]; i++) {
+                if (category != NULL && strcmp(category, categoryName(s, i)) == 0) {
+                    index = i;
+                }
+            }
+            if (index < 0 || sqlite3_column_int64(stmt, 2) != category_counts[index] ||
+                !closeEnough(sqlite3_column_double(stmt, 1), category_totals[index])) {
+                stressFail(s, "category_totals has %s at %.2f over %lld rows; expected %.2f over %ld",
+                           category ? category : "(null)", sqlite3_column_double(stmt, 1),
+                           (long long)sqlite3_column_int64(stmt, 2), index < 0 ? 0 : category_totals[index],
+                           index < 0 ? 0 : category_counts[index]);
+            }
+            categories_seen++;
+        }
+    }
+    sqlite3_finalize(stmt);
+    if (!s->failed && categories_seen != categories_expected) {
+        stressFail(s, "category_totals has %d categories; expected %d", categories_seen, categories_expected);
+    }
+    if (s->failed) {
+        return;
+    }
+
+    // The reports themselves, against the model's brute-force sums
+    double recurring_income = 0, recurring_expenses = 0;
+    for (int k = 0; k < s->recurring_count[0]; k++) {
+        recurring_income += s->recurring_amounts[0][k];
+    }
+    for (int k = 0; k < s->recurring_count[1]; k++) {
+        recurring_expenses += s->recurring_amounts[1][k];
+    }
+    checkReport(s, "Show Analytics", captureReport(s, showAnalytics, "Total Monthly Income: $", "Total Expenses: $"),
+                income, expenses);
+    if (!s->failed) {
+        checkReport(s, "Calculate Daily Budget", captureReport(s, dailyBudgetReport, "Total Income: $", "Total Expenses: $"),
+                    income + recurring_income, expenses + recurring_expenses);
+    }
+    // The snapshot, then again after an in-place edit with nothing added or removed, which a
+    // snapshot extended from its high-water ids alone would miss
+    if (!s->failed) {
+        checkSnapshot(s, "at the check");
+    }
+    if (!s->failed) {
+        stressEdit(s);
+        checkSnapshot(s, "after an edit");
+    }
+    s->counts[OP_CHECK]++;
+}
+
+// Wait after SQLITE_BUSY, counting the conflict and the time lost to it
+static void backOff(StressWorker *worker) {
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    sqlite3_sleep(STRESS_RETRY_SLEEP_MS);
+    worker->busy_retries++;
+    worker->wait_ms += elapsedMs(&start);
+}
+
+// Reading the schema to prepare a statement needs a shared lock too
+static int prepareWithRetry(sqlite3 *db, const char *sql, sqlite3_stmt **stmt, StressWorker *worker) {
+    int rc;
+    while ((rc = sqlite3_prepare_v2(db, sql, -1, stmt, NULL)) == SQLITE_BUSY) {
+        backOff(worker);
+    }
+    return rc == SQLITE_OK;
+}
+
+static int stepWithRetry(sqlite3_stmt *stmt, StressWorker *worker) {
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_BUSY) {
+        sqlite3_reset(stmt);
+        backOff(worker);
+    }
+    return rc;
+}
+
+static int execWithRetry(sqlite3 *db, const char *sql, StressWorker *worker) {
+    int rc;
+    while ((rc = sqlite3_exec(db, sql, 0, 0, NULL)) == SQLITE_BUSY) {
+        backOff(worker);
+    }
+    return rc == SQLITE_OK;
+}
+
+// Each thread has its own connection. No busy timeout, so every lock conflict is counted.
+static sqlite3 *openWorkerConnection(void) {
+    sqlite3 *db;
+    if (sqlite3_open(STRESS_LEDGER, &db) != SQLITE_OK || !registerCurrencyFunctions(db)) {
+        sqlite3_close(db);
+        return NULL;
+    }
+    sqlite3_exec(db, "PRAGMA synchronous = OFF;", 0, 0, NULL);
+    return db;
+}
+
+static void *stressWriter(void *arg) {
+    StressWorker *worker = arg;
+    sqlite3 *db = openWorkerConnection();
+    sqlite3_stmt *insert = NULL;
+
+    if (db == NULL || !prepareWithRetry(db, SCHEMA_INSERT_SQL(SCHEMA_EXPENSES) ";", &insert, worker)) {
+        worker->failed = 1;
+    }
+    for (long i = 0; i < worker->target && !worker->failed; i++) {
+        char date[20];
+        snprintf(date, sizeof(date), "%04d-%02d-%02d", worker->year, worker->month, 2 + randomBelow(&worker->rng, 27));
+        ExpenseRow row = { .category = stress_categories[randomBelow(&worker->rng, STRESS_CATEGORY_COUNT)],
+                           .amount = (1 + randomBelow(&worker->rng, 500000)) / 100.0,
+                           .date = date,
+                           .currency = stress_currencies[randomBelow(&worker->rng, STRESS_CURRENCY_COUNT)] };
+
+        struct timespec start;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        if (!execWithRetry(db, "BEGIN IMMEDIATE;", worker)) {
+            worker->failed = 1;
+            break;
+        }
+        schemaBind_expenses(insert, &row);
+        int rc = stepWithRetry(insert, worker);
+        sqlite3_reset(insert);
+        if (rc != SQLITE_DONE || !execWithRetry(db, "COMMIT;", worker)) {
+            sqlite3_exec(db, "ROLLBACK;", 0, 0, NULL);
+            worker->failed = 1;
+            break;
+        }
+
+        double latency = elapsedMs(&start);
+        if (latency > worker->max_latency_ms) {
+            worker->max_latency_ms = latency;
+        }
+        worker->operations++;
+    }
+    sqlite3_finalize(insert);
+    sqlite3_close(db);
+    atomic_fetch_sub(&writers_running, 1);
+    return NULL;
+}
+
+static void *stressReader(void *arg) {
+    StressWorker *worker = arg;
+    sqlite3 *db = openWorkerConnection();
+    sqlite3_stmt *stmt = NULL;
+
+    if (db == NULL || !prepareWithRetry(db, "SELECT IFNULL(SUM(to_base(amount, currency, date)), 0), COUNT(*) "
+                                            "FROM expenses;", &stmt, worker)) {
+        worker->failed = 1;
+    }
+    while (!worker->failed && atomic_load(&writers_running) > 0) {
+        struct timespec start;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        if (stepWithRetry(stmt, worker) != SQLITE_ROW) {
+            worker->failed = 1;
+        }
+        sqlite3_reset(stmt);
+
+        double latency = elapsedMs(&start);
+        if (latency > worker->max_latency_ms) {
+            worker->max_latency_ms = latency;
+        }
+        worker->operations++;
+    }
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+    return NULL;
+}
+
+static void printWorker(const char *name, const StressWorker *worker, double elapsed_ms) {
+    printf("  %-9s %8ld %s (%.0f/s), %ld busy retries, %.1f ms waiting for locks, max latency %.2f ms%s\n",
+           name, worker->operations, worker->writer ? "writes " : "reports", worker->operations * 1000.0 / elapsed_ms,
+           worker->busy_retries, worker->wait_ms, worker->max_latency_ms, worker->failed ? " FAILED" : "");
+}
+
+// Writers insert one expense per transaction while a reader runs the report aggregate
+static void stressThreads(StressState *s, int threads, long writes) {
+    StressWorker *workers = calloc(threads + 1, sizeof(StressWorker));
+    pthread_t *ids = calloc(threads + 1, sizeof(pthread_t));
+    int64_t rows_before = queryCount(s->db, "SELECT COUNT(*) FROM expenses;");
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    atomic_store(&writers_running, threads);
+    for (int i = 0; i <= threads; i++) {
+        workers[i].writer = i < threads;
+        workers[i].target = writes / threads + (i < writes % threads);
+        workers[i].rng = s->seed + 0x9E3779B97F4A7C15ULL * (i + 1);
+        workers[i].year = s->year;
+        workers[i].month = s->month;
+        pthread_create(&ids[i], NULL, workers[i].writer ? stressWriter : stressReader, &workers[i]);
+    }
+    for (int i = 0; i <= threads; i++) {
+        pthread_join(ids[i], NULL);
+    }
+    double elapsed = elapsedMs(&start);
+
+    StressWorker total = { .writer = 1 };
+    StressWorker reads = { .writer = 0 };
+    printf("\nThreaded phase: %d writers and 1 reader, one connection each, %.2f s\n", threads, elapsed / 1000);
+    for (int i = 0; i <= threads; i++) {
+        char name[32];
+        snprintf(name, sizeof(name), i < threads ? "writer %d" : "reader", i + 1);
+        printWorker(name, &workers[i], elapsed);
+        StressWorker *sum = workers[i].writer ? &total : &reads;
+        sum->operations += workers[i].operations;
+        sum->busy_retries += workers[i].busy_retries;
+        sum->wait_ms += workers[i].wait_ms;
+        sum->max_latency_ms = workers[i].max_latency_ms > sum->max_latency_ms ? workers[i].max_latency_ms : sum->max_latency_ms;
+        if (workers[i].failed) {
+            stressFail(s, "%s stopped on an error", name);
+        }
+    }
+    printWorker("all", &total, elapsed);
+    printf("  Lock waits took %.1f%% of thread time.\n",
+           (total.wait_ms + reads.wait_ms) * 100.0 / (elapsed * (threads + 1)));
+
+    // Every committed write is there, and the triggers kept category_totals and row_counts in step
+    // under contention
+    int64_t rows = queryCount(s->db, "SELECT COUNT(*) FROM expenses;");
+    if (rows != rows_before + total.operations) {
+        stressFail(s, "the ledger has %lld expenses after the threaded phase; expected %lld", (long long)rows,
+                   (long long)(rows_before + total.operations));
+    } else if (queryCount(s->db, "SELECT IFNULL(SUM(count), 0) FROM category_totals;") != rows ||
+               queryCount(s->db, "SELECT IFNULL(SUM(foreign_count), 0) FROM category_totals;") !=
+                   queryCount(s->db, "SELECT COUNT(*) FROM expenses WHERE IFNULL(currency, '') <> '';") ||
+               queryCount(s->db, "SELECT ABS((SELECT IFNULL(SUM(amount), 0) FROM expenses WHERE IFNULL(currency, '') = '') - "
+                                 "(SELECT IFNULL(SUM(total), 0) FROM category_totals)) < 0.01;") != 1) {
+        stressFail(s, "category_totals no longer matches the expenses after the threaded phase");
+    } else if (queryCount(s->db, "SELECT row_count FROM row_counts WHERE table_name = 'expenses';") != rows) {
+        stressFail(s, "row_counts no longer matches the expenses after the threaded phase");
+    }
+    free(workers);
+    free(ids);
+}
+
+static void removeCrashFiles(void) {
+    remove(STRESS_CRASH_LEDGER);
+    remove(STRESS_CRASH_LEDGER "-journal");
+    remove(STRESS_CRASH_LEDGER ".oplog");
+}
+
+// Child of the crash phase: journal income rows with amounts 1, 2, 3, ... and report each
+// append on ack_fd once it has returned, until the parent kills the process
+static void crashWriter(int quiet_fd, int ack_fd) {
+    sqlite3 *db;
+    dup2(quiet_fd, STDOUT_FILENO);
+    initializeDatabase(&db, STRESS_CRASH_LEDGER);
+    if (!openJournal(STRESS_CRASH_LEDGER)) {
+        _exit(1);
+    }
+    for (int32_t i = 1; i <= STRESS_CRASH_MAX_RECORDS; i++) {
+        if (!journalAppendIncome((float)i, "2020-01-02") || write(ack_fd, &i, sizeof(i)) != (ssize_t)sizeof(i)) {
+            _exit(1);
+        }
+    }
+    _exit(0);
+}
+
+// Open the crash ledger, replaying its journal, and check the replayed rows: every
+// acknowledged append exactly once, plus at most the one the kill interrupted
+static void checkCrashLedger(StressState *s, int round, int32_t acked, const char *when) {
+    sqlite3 *db;
+    int quiet = redirectStdout(s->quiet_fd);
+    initializeDatabase(&db, STRESS_CRASH_LEDGER);
+    restoreStdout(quiet);
+
+    int64_t rows = queryCount(db, "SELECT COUNT(*) FROM income;");
+    int64_t distinct = queryCount(db, "SELECT COUNT(DISTINCT amount) FROM income;");
+    int64_t highest = queryCount(db, "SELECT IFNULL(MAX(amount), 0) FROM income;");
+    struct stat st;
+    if (rows != distinct) {
+        stressFail(s, "crash round %d %s: %lld of %lld journal records were applied twice", round, when,
+                   (long long)(rows - distinct), (long long)rows);
+    } else if (rows < acked || rows > (int64_t)acked + 1 || highest != rows) {
+        stressFail(s, "crash round %d %s: %lld rows up to %lld after %d acknowledged appends", round, when,
+                   (long long)rows, (long long)highest, acked);
+    } else if (stat(STRESS_CRASH_LEDGER ".oplog", &st) == 0 && st.st_size != 0) {
+        stressFail(s, "crash round %d %s: %lld journal bytes left after replay", round, when, (long long)st.st_size);
+    }
+    sqlite3_close(db);
+}
+
+// Kill a journaling writer at a random point, append a torn record to its journal, then
+// check that opening the ledger replays each acknowledged record once and drops the torn
+// tail, and that opening it again changes nothing
+static void stressCrashRecovery(StressState *s) {
+    int32_t fewest = INT32_MAX, most = 0;
+
+    for (int round = 1; round <= STRESS_CRASH_ROUNDS && !s->failed; round++) {
+        int delay_ms = 10 + randomBelow(&s->rng, STRESS_CRASH_MAX_DELAY_MS);
+        int ack[2];
+        removeCrashFiles();
+        if (pipe(ack) != 0) {
+            stressFail(s, "crash round %d: no pipe", round);
+            return;
+        }
+        fflush(stdout);
+        pid_t child = fork();
+        if (child < 0) {
+            stressFail(s, "crash round %d: fork failed", round);
+            close(ack[0]);
+            close(ack[1]);
+            return;
+        }
+        if (child == 0) {
+            close(ack[0]);
+            crashWriter(s->quiet_fd, ack[1]);
+        }
+        close(ack[1]);
+
+        // Let the writer run across a few compaction passes, kill it mid-stream, then collect
+        // the acknowledgements it sent before it died
+        struct timespec start;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        int32_t acked = 0, value;
+        int stopped = 0;
+        while (elapsedMs(&start) < delay_ms && !stopped) {
+            stopped = (read(ack[0], &value, sizeof(value)) != (ssize_t)sizeof(value));
+            acked = stopped ? acked : value;
+        }
+        kill(child, SIGKILL);
+        waitpid(child, NULL, 0);
+        while (read(ack[0], &value, sizeof(value)) == (ssize_t)sizeof(value)) {
+            acked = value;
+        }
+        close(ack[0]);
+        if (stopped) {
+            stressFail(s, "crash round %d: the writer stopped on its own after %d appends", round, acked);
+            return;
+        }
+
+        // A record cut short by a crash: shorter than any whole record, so replay must drop it
+        int fd = open(STRESS_CRASH_LEDGER ".oplog", O_WRONLY | O_APPEND | O_CREAT, 0644);
+        if (fd < 0 || write(fd, "FLJR-torn", 9) != 9) {
+            stressFail(s, "crash round %d: could not append the torn record", round);
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
+
+        if (!s->failed) {
+            checkCrashLedger(s, round, acked, "after the crash");
+        }
+        if (!s->failed) {
+            checkCrashLedger(s, round, acked, "on the second open");
+        }
+        fewest = acked < fewest ? acked : fewest;
+        most = acked > most ? acked : most;
+    }
+    if (!s->failed) {
+        printf("\nCrash phase: %d journal writers killed after %d to %d acknowledged appends; every record "
+               "was replayed once and each torn tail discarded.\n", STRESS_CRASH_ROUNDS, fewest, most);
+        removeCrashFiles();
+    }
+}
+
+static void removeTwinFiles(void) {
+    remove(STRESS_TWIN_LEDGER);
+    remove(STRESS_TWIN_LEDGER "-journal");
+}
+
+// Post two recurring entries of each type that share a description and amount, over two months,
+// replaying each month on a reopened ledger: every entry must be posted exactly once a month
+static void stressTwinRecurring(StressState *s) {
+    const int months = 2, twins = 2;
+    sqlite3 *db = NULL;
+    int quiet = redirectStdout(s->quiet_fd);
+    removeTwinFiles();
+    initializeDatabase(&db, STRESS_TWIN_LEDGER);
+
+    sqlite3_stmt *stmt;
+    int ok = sqlite3_prepare_v2(db, SCHEMA_INSERT_SQL(SCHEMA_RECURRING) ";", -1, &stmt, NULL) == SQLITE_OK;
+    for (int i = 0; ok && i < 2 * twins; i++) {
+        RecurringRow row = { .type = i < twins ? "income" : "expense", .description = "Twin", .amount = 42.5,
+                             .date = "2021-03-01" };
+        schemaBind_recurring(stmt, &row);
+        ok = sqlite3_step(stmt) == SQLITE_DONE;
+        sqlite3_reset(stmt);
+    }
+    sqlite3_finalize(stmt);
+
+    for (int m = 0; ok && m < months; m++) {
+        struct tm when = { .tm_year = 2021 - 1900, .tm_mon = 2 + m, .tm_mday = 1, .tm_hour = 12, .tm_isdst = -1 };
+        applyRecurringTransactionsAt(db, mktime(&when));
+
+        // Reopen so the postings come back from the table, then replay the month
+        sqlite3_close(db);
+        initializeDatabase(&db, STRESS_TWIN_LEDGER);
+        updateLastProcessedMonth(db, 2021, 2 + m);
+        applyRecurringTransactionsAt(db, mktime(&when));
+    }
+    restoreStdout(quiet);
+
+    int64_t income = queryCount(db, "SELECT COUNT(*) FROM income WHERE amount = 42.5;");
+    int64_t expenses = queryCount(db, "SELECT COUNT(*) FROM expenses WHERE category = 'Twin' AND amount = 42.5;");
+    int64_t months_posted = queryCount(db, "SELECT COUNT(DISTINCT substr(date, 1, 7)) FROM income;");
+    if (!ok) {
+        stressFail(s, "adding the twin recurring entries failed: %s", sqlite3_errmsg(db));
+    } else if (income != twins * months || expenses != twins * months || months_posted != months) {
+        stressFail(s, "%d identical recurring entries of each type over %d months posted %lld income and %lld "
+                   "expense rows; expected %d of each", twins, months, (long long)income, (long long)expenses,
+                   twins * months);
+    }
+    sqlite3_close(db);
+    if (!s->failed) {
+        printf("\nTwin check: %d identical recurring entries of each type each posted once a month over %d "
+               "months and %d replays.\n", twins, months, months);
+        removeTwinFiles();
+    }
+}
+
+static void removeScratchFiles(void) {
+    remove(STRESS_LEDGER);
+    remove(STRESS_LEDGER "-journal");
+    remove(STRESS_RATES_FILE);
+    remove(STRESS_SNAPSHOT_FILE);
+}
+
+// Function to run the stress harness on a scratch ledger; returns 1 if every check passed.
+// Seed 0 picks one from the clock; the seed is printed so a failing run can be repeated.
+int runStressTest(int operations, int threads, unsigned long long seed) {
+    if (operations <= 0 || threads < 0) {
+        printf("Error: Operations must be positive and threads zero or more.\n");
+        return 0;
+    }
+    if (seed == 0) {
+        seed = (unsigned long long)time(NULL) ^ ((unsigned long long)getpid() << 32);
+    }
+    printf("Stress run: %d operations, %d threads, seed %llu, scratch ledger %s\n", operations, threads, seed,
+           STRESS_LEDGER);
+
+    removeScratchFiles();
+    FILE *rates = fopen(STRESS_RATES_FILE, "w");
+    if (rates == NULL) {
+        printf("Error: Could not create %s.\n", STRESS_RATES_FILE);
+        return 0;
+    }
+    fputs(stress_rates, rates);
+    fclose(rates);
+
+    StressState s = { .seed = seed, .rng = seed, .year = 2020, .month = 1 };
+    s.quiet_fd = open("/dev/null", O_WRONLY);
+    int quiet = redirectStdout(s.quiet_fd);
+    initializeDatabase(&s.db, STRESS_LEDGER);
+    // Durability isn't under test, and without fsync the numbers measure locking rather than the disk
+    sqlite3_exec(s.db, "PRAGMA synchronous = OFF;", 0, 0, NULL);
+    int loaded = loadExchangeRates(s.db, STRESS_RATES_FILE);
+    loadCategoryLimits(s.db);
+    restoreStdout(quiet);
+    if (!loaded) {
+        printf("Error: Could not load %s.\n", STRESS_RATES_FILE);
+        sqlite3_close(s.db);
+        return 0;
+    }
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    stressApplyMonth(&s, 0);
+    for (s.done = 0; s.done < operations && !s.failed; s.done++) {
+        if (s.done > 0 && s.done % STRESS_MONTH_EVERY == 0) {
+            s.year += s.month / 12;
+            s.month = s.month % 12 + 1;
+            stressApplyMonth(&s, 0);
+            s.counts[OP_MONTH]++;
+        }
+        if (s.done > 0 && s.done % STRESS_CHECK_EVERY == 0 && !s.failed) {
+            stressCheck(&s);
+        }
+        if (s.failed) {
+            break;
+        }
+
+        int roll = randomBelow(&s.rng, 100);
+        StressOp op = roll < 30 ? OP_INCOME : roll < 65 ? OP_EXPENSE : roll < 80 ? OP_EDIT : roll < 92 ? OP_DELETE
+                    : roll < 97 ? OP_RECURRING : OP_REPLAY;
+        switch (op) {
+            case OP_INCOME:
+            case OP_EXPENSE:
+                stressInsert(&s, op == OP_EXPENSE);
+                break;
+            case OP_EDIT:
+                stressEdit(&s);
+                break;
+            case OP_DELETE:
+                stressDelete(&s);
+                break;
+            case OP_RECURRING:
+                stressAddRecurring(&s);
+                break;
+            default:
+                stressApplyMonth(&s, 1);
+                break;
+        }
+        s.counts[op]++;
+    }
+    if (!s.failed) {
+        stressCheck(&s);
+    }
+    double elapsed = elapsedMs(&start);
+
+    printf("Random operations: %ld in %.2f s (%.0f/s)\n", s.done, elapsed / 1000, s.done * 1000.0 / elapsed);
+    for (int i = 0; i < OP_COUNT; i++) {
+        printf("  %-18s %ld\n", op_names[i], s.counts[i]);
+    }
+    printf("  simulated months   %04d-01 to %04d-%02d\n", 2020, s.year, s.month);
+
+    if (!s.failed && threads > 0) {
+        stressThreads(&s, threads, operations);
+    }
+    if (!s.failed) {
+        stressCrashRecovery(&s);
+    }
+    if (!s.failed) {
+        stressTwinRecurring(&s);
+    }
+
+    sqlite3_close(s.db);
+    close(s.quiet_fd);
+    free(s.income.rows);
+    free(s.expenses.rows);
+    if (s.failed) {
+        printf("Stress run failed; the scratch ledger is kept in %s.\n", STRESS_LEDGER);
+        return 0;
+    }
+    removeScratchFiles();
+    printf("All invariants held.\n");
+    return 1;
+}
@@ -0,0 +1,123 @@
+#define _XOPEN_SOURCE 700
+#include "tools.h"
+#include "forecast.h"
+#include "category_limits.h"
+#include "batch.h"
+#include "snapshot.h"
+#include "search.h"
+#include "listing.h"
+#include "history.h"
+#include "consolidate.h"
+#include "archive.h"
+#include "backup.h"
+#include "schema.h"
+#include "rules.h"
+#include "currency.h"
+#include "utils.h"
+#include <stdio.h>
+#include <sqlite3.h>
+
+// Function to manage reports and tools
+void manageTools(sqlite3 *db) {
+    int choice;
+    do {
+        printf("\n--- Reports & Tools ---\n");
+        printf("1. Forecast Balance\n");
+        printf("2. What-If Forecast\n");
+        printf("3. Set Category Limit\n");
+        printf("4. Category Limit Report\n");
+        printf("5. Batch Mode (Group Commit)\n");
+        printf("6. Export Binary Snapshot\n");
+        printf("7. Snapshot Analytics\n");
+        printf("8. Search Transactions\n");
+        printf("9. Browse Income & Expenses\n");
+        printf("10. Point-in-Time Report\n");
+        printf("11. Change History\n");
+        printf("12. Consolidate Ledgers\n");
+        printf("13. Archive Closed Years\n");
+        printf("14. Date Range Report\n");
+        printf("15. Create Backup\n");
+        printf("16. Restore Backup\n");
+        printf("17. Online Backup (background)\n");
+        printf("18. Online Backup Status\n");
+        printf("19. Export Tables to CSV\n");
+        printf("20. Category Rules & Bank Import\n");
+        printf("21. Load Exchange Rates\n");
+        printf("22. Return to Main Menu\n");
+        printf("Enter your choice: ");
+        choice = getValidIntInput();
+
+        switch (choice) {
+            case 1:
+                showForecast(db);
+                break;
+            case 2:
+                showWhatIfForecast(db);
+                break;
+            case 3:
+                setCategoryLimit(db);
+                break;
+            case 4:
+                showCategoryLimitReport();
+                break;
+            case 5: {
+                printf("Enter writes per commit (0 to turn batch mode off): ");
+                int max_writes = getValidIntInput();
+                setBatchMode(max_writes, BATCH_DEFAULT_MAX_MS);
+                break;
+            }
+            case 6:
+                writeSnapshot(db, SNAPSHOT_FILE);
+                break;
+            case 7:
+                showSnapshotReport(SNAPSHOT_FILE);
+                break;
+            case 8:
+                searchTransactions(db);
+                break;
+            case 9:
+                browseTransactions(db);
+                break;
+            case 10:
+                showPointInTimeReport(db);
+                break;
+            case 11:
+                showChangeHistory(db);
+                break;
+            case 12:
+                consolidateLedgersPrompt();
+                break;
+            case 13:
+                archiveClosedYearsPrompt(db);
+                break;
+            case 14:
+                showRangeReportPrompt(db);
+                break;
+            case 15:
+                createBackup(db, 0);
+                break;
+            case 16:
+                restoreBackupPrompt();
+                break;
+            case 17:
+                startOnlineBackupPrompt(db);
+                break;
+            case 18:
+                showOnlineBackupStatus();
+                break;
+            case 19:
+                exportTablesPrompt(db);
+                break;
+            case 20:
+                manageCategoryRules(db);
+                break;
+            case 21:
+                loadExchangeRatesPrompt(db);
+                break;
+            case 22:
+                return;  // Return to the main menu
+            default:
+                printf("Invalid choice. Try again.\n");
+        }
+    } while (choice != 22);
+}
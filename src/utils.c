@@ -1,53 +1,332 @@
 #define _XOPEN_SOURCE 700
 #include "utils.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
-#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+#include <zlib.h>
+
+static LineReader stdin_reader = { .fd = STDIN_FILENO };
+
+// Helper function to attach a line reader to a file descriptor
+void initLineReader(LineReader *reader, int fd) {
+    reader->fd = fd;
+    reader->start = 0;
+    reader->end = 0;
+    reader->eof = 0;
+}
+
+// Helper function to read the next line; returns NULL at end of input
+char *readLine(LineReader *reader) {
+    size_t length = 0;
+    int have_data = 0;
+
+    while (1) {
+        if (reader->start == reader->end) {
+            if (reader->eof) {
+                break;
+            }
+            ssize_t got = read(reader->fd, reader->buffer, sizeof(reader->buffer));
+            if (got < 0 && errno == EINTR) {
+                continue;
+            }
+            if (got <= 0) {
+                reader->eof = 1;
+                break;
+            }
+            reader->start = 0;
+            reader->end = (size_t)got;
+        }
+
+        have_data = 1;
+        char *chunk = reader->buffer + reader->start;
+        size_t available = reader->end - reader->start;
+        char *newline = memchr(chunk, '\n', available);
+        size_t take = newline ? (size_t)(newline - chunk) : available;
+
+        if (length < INPUT_LINE_MAX - 1) {
+            size_t room = INPUT_LINE_MAX - 1 - length;
+            memcpy(reader->line + length, chunk, take < room ? take : room);
+            length += take < room ? take : room;
+        }
+        reader->start += take;
+        if (newline) {
+            reader->start++;   // Skip the newline itself
+            break;
+        }
+    }
+
+    if (!have_data) {
+        return NULL;
+    }
+    if (length > 0 && reader->line[length - 1] == '\r') {
+        length--;   // Tolerate CRLF line endings
+    }
+    reader->line[length] = '\0';
+    return reader->line;
+}
+
+// Helper function to read the next line from stdin, flushing any pending prompt first
+char *readInputLine(void) {
+    fflush(stdout);
+    return readLine(&stdin_reader);
+}
+
+// Read a line for an interactive prompt; leaving at end of input runs the atexit handlers,
+// which commit any batched writes
+static char *readPromptLine() {
+    char *line = readInputLine();
+    if (line == NULL) {
+        printf("\nEnd of input. Goodbye!\n");
+        exit(0);
+    }
+    return line;
+}
+
+static int isBlank(char c) {
+    return c == ' ' || c == '\t';
+}
+
+// Helper function to split a line in place. With delimiter 0 tokens are separated by runs of
+// spaces/tabs; otherwise by the delimiter (empty fields allowed). Tokens are trimmed of blanks.
+// Returns NULL once the line is used up.
+char *nextToken(char **cursor, char delimiter) {
+    char *p = *cursor;
+    if (p == NULL) {
+        return NULL;
+    }
+    while (isBlank(*p)) {
+        p++;
+    }
+    if (delimiter == 0 && *p == '\0') {
+        *cursor = NULL;
+        return NULL;
+    }
+
+    char *token = p;
+    while (*p != '\0' && (delimiter ? *p != delimiter : !isBlank(*p))) {
+        p++;
+    }
+    if (*p != '\0') {
+        *p = '\0';
+        *cursor = p + 1;
+    } else {
+        *cursor = (delimiter == 0) ? p : NULL;
+    }
+    while (p > token && isBlank(p[-1])) {
+        *--p = '\0';
+    }
+    return token;
+}
+
+// Skip leading and trailing blanks; returns the start and stores the end
+static const char *trimToken(const char *text, const char **end) {
+    while (isBlank(*text)) {
+        text++;
+    }
+    const char *e = text + strlen(text);
+    while (e > text && isBlank(e[-1])) {
+        e--;
+    }
+    *end = e;
+    return text;
+}
+
+// Helper function to parse a whole token as a base-10 int
+int parseIntToken(const char *text, int *value) {
+    const char *end;
+    const char *p = trimToken(text, &end);
+    int negative = 0;
+    long long result = 0;
+
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = (*p == '-');
+        p++;
+    }
+    if (p == end) {
+        return 0;
+    }
+    for (; p < end; p++) {
+        if (*p < '0' || *p > '9') {
+            return 0;
+        }
+        result = result * 10 + (*p - '0');
+        if (result > 2147483648LL) {
+            return 0;
+        }
+    }
+    if (negative) {
+        result = -result;
+    }
+    if (result > 2147483647LL) {
+        return 0;
+    }
+    *value = (int)result;
+    return 1;
+}
+
+// Helper function to parse a whole token as a plain decimal (digits with an optional '.' part)
+int parseDecimalToken(const char *text, double *value) {
+    static const double powers[] = {1, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9,
+                                    1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18};
+    const char *end;
+    const char *p = trimToken(text, &end);
+    int negative = 0, digits = 0, significant = 0, decimals = 0, seen_point = 0;
+    unsigned long long mantissa = 0;
+
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = (*p == '-');
+        p++;
+    }
+    for (; p < end; p++) {
+        if (*p == '.' && !seen_point) {
+            seen_point = 1;
+            continue;
+        }
+        if (*p < '0' || *p > '9') {
+            return 0;
+        }
+        digits++;
+        if (mantissa == 0 && *p == '0' && !seen_point) {
+            continue;   // Leading zeros
+        }
+        if (significant == 18) {
+            return 0;   // More digits than a double can carry
+        }
+        mantissa = mantissa * 10 + (*p - '0');
+        significant++;
+        decimals += seen_point;
+    }
+    if (digits == 0) {
+        return 0;
+    }
+
+    double result = (double)mantissa / powers[decimals];
+    *value = negative ? -result : result;
+    return 1;
+}
+
+static int daysInMonth(int year, int month) {
+    static const int days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if (month == 2 && year % 4 == 0 && (year % 100 != 0 || year % 400 == 0)) {
+        return 29;
+    }
+    return days[month - 1];
+}
+
+// Helper function to parse and validate a YYYY-MM-DD token
+int parseDateToken(const char *text, int *year, int *month, int *day) {
+    const char *end;
+    const char *p = trimToken(text, &end);
+    int parts[3] = {0, 0, 0};
+    static const int widths[3] = {4, 2, 2};
+
+    if (end - p != 10) {
+        return 0;
+    }
+    for (int part = 0; part < 3; part++) {
+        for (int i = 0; i < widths[part]; i++, p++) {
+            if (*p < '0' || *p > '9') {
+                return 0;
+            }
+            parts[part] = parts[part] * 10 + (*p - '0');
+        }
+        if (part < 2 && *p++ != '-') {
+            return 0;
+        }
+    }
+    if (parts[1] < 1 || parts[1] > 12 || parts[2] < 1 || parts[2] > daysInMonth(parts[0], parts[1])) {
+        return 0;
+    }
+    *year = parts[0];
+    *month = parts[1];
+    *day = parts[2];
+    return 1;
+}
 
 // Helper function to get a valid integer input from the user
 int getValidIntInput() {
     int value;
-    while (scanf("%d", &value) != 1) {
+    while (!parseIntToken(readPromptLine(), &value)) {
         printf("Error: Invalid input. Please enter a valid integer.\n");
-        while (getchar() != '\n');  // Clear buffer
     }
     return value;
 }
 
 // Helper function to get a valid float input from the user
 float getValidFloatInput() {
-    float value;
-    while (scanf("%f", &value) != 1 || value <= 0) {
+    double value;
+    while (!parseDecimalToken(readPromptLine(), &value) || value <= 0) {
         printf("Error: Invalid input. Please enter a valid positive number.\n");
-        while (getchar() != '\n');  // Clear buffer
     }
-    return value;
+    return (float)value;
 }
 
 // Helper function to get a valid non-empty string input
 void getValidStringInput(char *input, int max_len) {
     while (1) {
-        fgets(input, max_len, stdin);
-        input[strcspn(input, "\n")] = 0;  // Remove trailing newline
-        if (strlen(input) == 0) {
+        const char *end;
+        const char *text = trimToken(readPromptLine(), &end);
+        if (text == end) {
             printf("Error: Input cannot be empty. Please enter a valid string.\n");
         } else {
+            int length = (int)(end - text) < max_len - 1 ? (int)(end - text) : max_len - 1;
+            memcpy(input, text, length);
+            input[length] = '\0';
             break;
         }
     }
 }
 
+// Helper function to read a string that may be left blank; returns its length
+int getOptionalStringInput(char *input, int max_len) {
+    const char *end;
+    const char *text = trimToken(readPromptLine(), &end);
+    int length = (int)(end - text) < max_len - 1 ? (int)(end - text) : max_len - 1;
+    memcpy(input, text, length);
+    input[length] = '\0';
+    return length;
+}
+
 // Helper function to validate date input (YYYY-MM-DD)
 int getValidDateInput(char *date, int max_len) {
+    int year, month, day;
     while (1) {
-        fgets(date, max_len, stdin);
-        date[strcspn(date, "\n")] = 0;  // Remove trailing newline
-        
-        struct tm tm;
-        if (strptime(date, "%Y-%m-%d", &tm) == NULL) {
-            printf("Error: Invalid date format. Please enter a date in the format YYYY-MM-DD.\n");
-        } else {
+        if (parseDateToken(readPromptLine(), &year, &month, &day)) {
+            snprintf(date, max_len, "%04d-%02d-%02d", year, month, day);
             return 1; // Valid date
         }
+        printf("Error: Invalid date format. Please enter a date in the format YYYY-MM-DD.\n");
+    }
+}
+
+// Helper function to get the first non-blank character of a non-empty line
+char getValidCharInput() {
+    while (1) {
+        const char *end;
+        const char *text = trimToken(readPromptLine(), &end);
+        if (text != end) {
+            return *text;
+        }
+        printf("Error: Input cannot be empty.\n");
+    }
+}
+
+// Helper function to hash a string for in-memory lookup tables (FNV-1a)
+unsigned int hashString(const char *text) {
+    unsigned int hash = 2166136261u;
+    while (*text) {
+        hash ^= (unsigned char)*text++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Helper function to compute a CRC-32 checksum with zlib, chainable through seed (start with 0)
+unsigned int computeChecksum(const void *data, size_t length, unsigned int seed) {
+    if (length == 0) {
+        return seed;   // zlib resets the checksum when given a NULL buffer
     }
+    return (unsigned int)crc32_z(seed, data, length);
 }